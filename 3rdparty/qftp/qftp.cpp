@@ -1892,6 +1892,37 @@ int QFtp::put(QIODevice *dev, const QString &file, TransferType type)
     return d->addCommand(new QFtpCommand(Put, cmds, dev));
 }
 
+/*!
+    Resumes an interrupted upload of the IO device \a dev to the file
+    called \a file on the server. The server is asked to continue the
+    file at \a offset (REST) and the device is positioned at \a offset,
+    so only the remaining data is transferred. The device must be an
+    open random access device.
+
+    The bytes reported by dataTransferProgress() count from \a offset,
+    the total is the size of the whole device.
+
+    If the server does not support restarting transfers the command
+    fails and the file on the server is left unchanged.
+
+    \sa put()
+*/
+int QFtp::putAt(QIODevice *dev, const QString &file, qint64 offset, TransferType type)
+{
+    QStringList cmds;
+    if (type == Binary)
+        cmds << QLatin1String("TYPE I\r\n");
+    else
+        cmds << QLatin1String("TYPE A\r\n");
+    cmds << QLatin1String(d->transferMode == Passive ? "PASV\r\n" : "PORT\r\n");
+    if (offset > 0) {
+        dev->seek(offset);
+        cmds << QLatin1String("REST ") + QString::number(offset) + QLatin1String("\r\n");
+    }
+    cmds << QLatin1String("STOR ") + file + QLatin1String("\r\n");
+    return d->addCommand(new QFtpCommand(Put, cmds, dev));
+}
+
 /*!
     Deletes the file called \a file from the server.
 
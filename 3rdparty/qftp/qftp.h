@@ -109,6 +109,7 @@ public:
     int get(const QString &file, QIODevice *dev=0, TransferType type = Binary);
     int put(const QByteArray &data, const QString &file, TransferType type = Binary);
     int put(QIODevice *dev, const QString &file, TransferType type = Binary);
+    int putAt(QIODevice *dev, const QString &file, qint64 offset, TransferType type = Binary);
     int remove(const QString &file);
     int mkdir(const QString &dir);
     int rmdir(const QString &dir);
@@ -32,6 +32,7 @@ TEMPLATE = subdirs
 
 CONFIG += ordered
 SUBDIRS += 3rdparty src # applications examples
+!android:!ios:contains(CONFIG, tests): SUBDIRS += tests   # opt in with qmake CONFIG+=tests
 
 include(qtquickvcp_version.pri)
 include(paths.pri)
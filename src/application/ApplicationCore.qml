@@ -32,7 +32,7 @@ Item {
     property ApplicationSettings settings: uiSettings
     property MdiHistory mdiHistory: mdiHistory
     property HomeAllAxesHelper homeAllAxesHelper: homeAllAxesHelper
-    property Item notifications: null
+    property Item notifications: null  // not used anymore, ApplicationNotifications shows error.notifications itself
     property string applicationName: "machinekit"
 
     id: applicationCore
@@ -41,7 +41,6 @@ Item {
         status.onTaskChanged.connect(statusTaskChanged)
         status.onConfigChanged.connect(statusConfigChanged)
         file.onUploadFinished.connect(fileUploadFinished)
-        error.onMessageReceived.connect(errorMessageReceived)
         file.onErrorChanged.connect(fileError)
         status.onErrorChanged.connect(statusError)
         command.onErrorChanged.connect(commandError)
@@ -82,12 +81,6 @@ Item {
         command.openProgram('execute', newPath)
     }
 
-    function errorMessageReceived(type, text) {
-        if (notifications != null) {
-            notifications.addNotification(type, text)
-        }
-    }
-
     function fileError() {
         if (file.error != ApplicationFile.NoError) {
             console.log("file error: " + file.errorString)
@@ -24,7 +24,12 @@ SOURCES += \
     qapplicationlauncher.cpp \
     qlocalsettings.cpp \
     qapplicationfilemodel.cpp \
-    qapplicationfileitem.cpp
+    qapplicationfileitem.cpp \
+    applicationfileextractor.cpp \
+    applicationfileuploadpreparer.cpp \
+    localsettingswriter.cpp \
+    qapplicationlauncheroutputmodel.cpp \
+    qapplicationnotificationmodel.cpp
 
 HEADERS += \
     plugin.h \
@@ -40,7 +45,12 @@ HEADERS += \
     qapplicationlauncher.h \
     qlocalsettings.h \
     qapplicationfilemodel.h \
-    qapplicationfileitem.h
+    qapplicationfileitem.h \
+    applicationfileextractor.h \
+    applicationfileuploadpreparer.h \
+    localsettingswriter.h \
+    qapplicationlauncheroutputmodel.h \
+    qapplicationnotificationmodel.h
 
 RESOURCES += \
     application.qrc
@@ -0,0 +1,118 @@
+/****************************************************************************
+**
+** Copyright (C) 2015 Alexander Rössler
+** License: LGPL version 2.1
+**
+** This file is part of QtQuickVcp.
+**
+** All rights reserved. This program and the accompanying materials
+** are made available under the terms of the GNU Lesser General Public License
+** (LGPL) version 2.1 which accompanies this distribution, and is available at
+** http://www.gnu.org/licenses/lgpl-2.1.html
+**
+** This library is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+** Lesser General Public License for more details.
+**
+** Contributors:
+** Alexander Rössler @ The Cool Tool GmbH <mail DOT aroessler AT gmail DOT com>
+**
+****************************************************************************/
+
+#include "applicationfileextractor.h"
+#include <QCryptographicHash>
+#include <QDir>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QtEndian>
+
+ApplicationFileExtractor::ApplicationFileExtractor(QObject *receiver, const QAtomicInt *currentGeneration, const QString &fileName, const QString &filePath) :
+    m_receiver(receiver),
+    m_currentGeneration(currentGeneration),
+    m_generation(currentGeneration->load()),
+    m_fileName(fileName),
+    m_filePath(filePath),
+    m_compressed(false)
+{
+}
+
+void ApplicationFileExtractor::setData(const QByteArray &data, bool compressed)
+{
+    m_data = data;
+    m_compressed = compressed;
+}
+
+void ApplicationFileExtractor::run()
+{
+    QByteArray hash;
+    bool success;
+
+    success = extract(hash);
+
+    if (!m_receiver.isNull())
+    {
+        QMetaObject::invokeMethod(m_receiver.data(), "fileExtracted", Qt::QueuedConnection,
+                                  Q_ARG(int, m_generation),
+                                  Q_ARG(QString, m_fileName),
+                                  Q_ARG(QString, m_filePath),
+                                  Q_ARG(QString, QString::fromLatin1(hash.toHex())),
+                                  Q_ARG(bool, success));
+    }
+}
+
+bool ApplicationFileExtractor::isCancelled() const
+{
+    return m_currentGeneration->loadAcquire() != m_generation;
+}
+
+bool ApplicationFileExtractor::extract(QByteArray &hash)
+{
+    QByteArray data;
+
+    if (m_compressed)
+    {
+        data = qUncompress(m_data);
+        if (data.isEmpty()      // corrupt unless the size header says empty
+            && ((m_data.size() < 4) || (qFromBigEndian<quint32>((const uchar*)m_data.constData()) != 0)))
+        {
+            return false;
+        }
+    }
+    else
+    {
+        data = m_data;
+    }
+    m_data.clear();
+    hash = QCryptographicHash::hash(data, QCryptographicHash::Sha1);
+
+    if (isCancelled())  // the directory may already be removed, do not create it again
+    {
+        return false;
+    }
+
+    QFileInfo fileInfo(m_filePath);
+    if (!QDir().mkpath(fileInfo.absolutePath()))
+    {
+        return false;
+    }
+
+    QSaveFile localFile(m_filePath);
+    if (!localFile.open(QIODevice::WriteOnly))
+    {
+        return false;
+    }
+
+    if (localFile.write(data) != data.size())
+    {
+        localFile.cancelWriting();
+        return false;
+    }
+
+    if (isCancelled())
+    {
+        localFile.cancelWriting();
+    }
+
+    return localFile.commit();  // false on any write error, a partial file never replaces the target
+}
@@ -0,0 +1,63 @@
+/****************************************************************************
+**
+** Copyright (C) 2015 Alexander Rössler
+** License: LGPL version 2.1
+**
+** This file is part of QtQuickVcp.
+**
+** All rights reserved. This program and the accompanying materials
+** are made available under the terms of the GNU Lesser General Public License
+** (LGPL) version 2.1 which accompanies this distribution, and is available at
+** http://www.gnu.org/licenses/lgpl-2.1.html
+**
+** This library is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+** Lesser General Public License for more details.
+**
+** Contributors:
+** Alexander Rössler @ The Cool Tool GmbH <mail DOT aroessler AT gmail DOT com>
+**
+****************************************************************************/
+
+#ifndef APPLICATIONFILEEXTRACTOR_H
+#define APPLICATIONFILEEXTRACTOR_H
+
+#include <QObject>
+#include <QAtomicInt>
+#include <QPointer>
+#include <QRunnable>
+#include <QByteArray>
+#include <QString>
+
+/** Decompresses and writes a single application file on a worker thread
+ *
+ *  When finished the fileExtracted slot of the receiver is invoked
+ *  through a queued connection with the generation, the file name, the
+ *  written path, the hex encoded SHA-1 of the content and the success.
+ *  Nothing is written once the current generation of the receiver
+ *  differs from the generation of the extractor.
+ */
+class ApplicationFileExtractor : public QRunnable
+{
+public:
+    ApplicationFileExtractor(QObject *receiver, const QAtomicInt *currentGeneration, const QString &fileName, const QString &filePath);
+
+    void setData(const QByteArray &data, bool compressed);
+
+    void run();
+
+private:
+    QPointer<QObject> m_receiver;
+    const QAtomicInt *m_currentGeneration;
+    int         m_generation;
+    QString     m_fileName;
+    QString     m_filePath;
+    QByteArray  m_data;
+    bool        m_compressed;
+
+    bool isCancelled() const;
+    bool extract(QByteArray &hash);
+};
+
+#endif // APPLICATIONFILEEXTRACTOR_H
@@ -0,0 +1,91 @@
+/****************************************************************************
+**
+** Copyright (C) 2015 Alexander Rössler
+** License: LGPL version 2.1
+**
+** This file is part of QtQuickVcp.
+**
+** All rights reserved. This program and the accompanying materials
+** are made available under the terms of the GNU Lesser General Public License
+** (LGPL) version 2.1 which accompanies this distribution, and is available at
+** http://www.gnu.org/licenses/lgpl-2.1.html
+**
+** This library is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+** Lesser General Public License for more details.
+**
+** Contributors:
+** Alexander Rössler @ The Cool Tool GmbH <mail DOT aroessler AT gmail DOT com>
+**
+****************************************************************************/
+
+#include "applicationfileuploadpreparer.h"
+#include <QCryptographicHash>
+#include <QFile>
+
+ApplicationFileUploadPreparer::ApplicationFileUploadPreparer(QObject *receiver, int generation, const QString &filePath) :
+    m_receiver(receiver),
+    m_generation(generation),
+    m_filePath(filePath),
+    m_compress(false)
+{
+}
+
+void ApplicationFileUploadPreparer::setCompress(bool compress)
+{
+    m_compress = compress;
+}
+
+void ApplicationFileUploadPreparer::run()
+{
+    QByteArray hash;
+    QByteArray data;
+    bool success;
+
+    success = prepare(hash, data);
+
+    if (!m_receiver.isNull())
+    {
+        QMetaObject::invokeMethod(m_receiver.data(), "uploadPrepared", Qt::QueuedConnection,
+                                  Q_ARG(int, m_generation),
+                                  Q_ARG(QString, QString::fromLatin1(hash.toHex())),
+                                  Q_ARG(QByteArray, data),
+                                  Q_ARG(bool, success));
+    }
+}
+
+bool ApplicationFileUploadPreparer::prepare(QByteArray &hash, QByteArray &data)
+{
+    QFile file(m_filePath);
+    QCryptographicHash cryptographicHash(QCryptographicHash::Sha1);
+
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        return false;
+    }
+
+    if (m_compress)
+    {
+        data = file.readAll();
+        cryptographicHash.addData(data);
+        data = qCompress(data, 6);
+        data.remove(0, 4);  // qCompress prepends the uncompressed size, MODE Z expects a plain zlib stream
+    }
+    else
+    {
+        while (!file.atEnd())   // do not keep huge programs in memory
+        {
+            QByteArray chunk = file.read(1024 * 1024);
+            if (chunk.isEmpty())
+            {
+                return false;
+            }
+            cryptographicHash.addData(chunk);
+        }
+    }
+
+    hash = cryptographicHash.result();
+
+    return true;
+}
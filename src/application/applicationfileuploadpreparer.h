@@ -0,0 +1,60 @@
+/****************************************************************************
+**
+** Copyright (C) 2015 Alexander Rössler
+** License: LGPL version 2.1
+**
+** This file is part of QtQuickVcp.
+**
+** All rights reserved. This program and the accompanying materials
+** are made available under the terms of the GNU Lesser General Public License
+** (LGPL) version 2.1 which accompanies this distribution, and is available at
+** http://www.gnu.org/licenses/lgpl-2.1.html
+**
+** This library is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+** Lesser General Public License for more details.
+**
+** Contributors:
+** Alexander Rössler @ The Cool Tool GmbH <mail DOT aroessler AT gmail DOT com>
+**
+****************************************************************************/
+
+#ifndef APPLICATIONFILEUPLOADPREPARER_H
+#define APPLICATIONFILEUPLOADPREPARER_H
+
+#include <QObject>
+#include <QPointer>
+#include <QRunnable>
+#include <QByteArray>
+#include <QString>
+
+/** Prepares a local file for upload on a worker thread
+ *
+ *  Computes the SHA-1 of the file used to verify the upload and, if
+ *  requested, the deflate stream sent in compressed transfer mode. The
+ *  compressed file is built in memory, so the caller only requests it
+ *  for files of limited size.
+ *  When finished the uploadPrepared slot of the receiver is invoked
+ *  through a queued connection with the generation, the hex encoded
+ *  SHA-1, the compressed data and the success.
+ */
+class ApplicationFileUploadPreparer : public QRunnable
+{
+public:
+    ApplicationFileUploadPreparer(QObject *receiver, int generation, const QString &filePath);
+
+    void setCompress(bool compress);
+
+    void run();
+
+private:
+    QPointer<QObject> m_receiver;
+    int         m_generation;
+    QString     m_filePath;
+    bool        m_compress;
+
+    bool prepare(QByteArray &hash, QByteArray &data);
+};
+
+#endif // APPLICATIONFILEUPLOADPREPARER_H
@@ -0,0 +1,69 @@
+/****************************************************************************
+**
+** Copyright (C) 2015 Alexander Rössler
+** License: LGPL version 2.1
+**
+** This file is part of QtQuickVcp.
+**
+** All rights reserved. This program and the accompanying materials
+** are made available under the terms of the GNU Lesser General Public License
+** (LGPL) version 2.1 which accompanies this distribution, and is available at
+** http://www.gnu.org/licenses/lgpl-2.1.html
+**
+** This library is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+** Lesser General Public License for more details.
+**
+** Contributors:
+** Alexander Rössler @ The Cool Tool GmbH <mail DOT aroessler AT gmail DOT com>
+**
+****************************************************************************/
+
+#include "localsettingswriter.h"
+#include <QDir>
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <QSaveFile>
+
+LocalSettingsWriter::LocalSettingsWriter(QObject *receiver, const QString &filePath, const QJsonObject &values) :
+    m_receiver(receiver),
+    m_filePath(filePath),
+    m_values(values)
+{
+}
+
+void LocalSettingsWriter::run()
+{
+    bool success;
+
+    success = write(m_filePath, m_values);
+
+    if (!m_receiver.isNull())
+    {
+        QMetaObject::invokeMethod(m_receiver.data(), "settingsWritten", Qt::QueuedConnection,
+                                  Q_ARG(QString, m_filePath),
+                                  Q_ARG(bool, success));
+    }
+}
+
+/** Writes the values, also used directly when the settings are destroyed */
+bool LocalSettingsWriter::write(const QString &filePath, const QJsonObject &values)
+{
+    QFileInfo fileInfo(filePath);
+
+    if (!QDir().mkpath(fileInfo.absolutePath()))
+    {
+        return false;
+    }
+
+    QSaveFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly))
+    {
+        return false;
+    }
+
+    file.write(QJsonDocument(values).toJson());
+
+    return file.commit();
+}
@@ -0,0 +1,54 @@
+/****************************************************************************
+**
+** Copyright (C) 2015 Alexander Rössler
+** License: LGPL version 2.1
+**
+** This file is part of QtQuickVcp.
+**
+** All rights reserved. This program and the accompanying materials
+** are made available under the terms of the GNU Lesser General Public License
+** (LGPL) version 2.1 which accompanies this distribution, and is available at
+** http://www.gnu.org/licenses/lgpl-2.1.html
+**
+** This library is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+** Lesser General Public License for more details.
+**
+** Contributors:
+** Alexander Rössler @ The Cool Tool GmbH <mail DOT aroessler AT gmail DOT com>
+**
+****************************************************************************/
+
+#ifndef LOCALSETTINGSWRITER_H
+#define LOCALSETTINGSWRITER_H
+
+#include <QObject>
+#include <QPointer>
+#include <QRunnable>
+#include <QJsonObject>
+#include <QString>
+
+/** Serializes and writes a settings snapshot on a worker thread
+ *
+ *  The file is written through QSaveFile, so it is replaced atomically
+ *  and an interrupted write leaves the previous settings intact. When
+ *  finished the settingsWritten slot of the receiver is invoked through
+ *  a queued connection with the file path and the success.
+ */
+class LocalSettingsWriter : public QRunnable
+{
+public:
+    LocalSettingsWriter(QObject *receiver, const QString &filePath, const QJsonObject &values);
+
+    void run();
+
+    static bool write(const QString &filePath, const QJsonObject &values);
+
+private:
+    QPointer<QObject> m_receiver;
+    QString     m_filePath;
+    QJsonObject m_values;
+};
+
+#endif // LOCALSETTINGSWRITER_H
@@ -30,6 +30,8 @@
 #include "qapplicationfile.h"
 #include "qapplicationfilemodel.h"
 #include "qapplicationlauncher.h"
+#include "qapplicationlauncheroutputmodel.h"
+#include "qapplicationnotificationmodel.h"
 #include "qlocalsettings.h"
 
 static void initResources()
@@ -70,6 +72,9 @@ void MachinekitApplicationPlugin::registerTypes(const char *uri)
     qmlRegisterType<QApplicationFile>(uri, 1, 0, "ApplicationFile");
     qmlRegisterType<QApplicationFileModel>(uri, 1, 0, "ApplicationFileModel");
     qmlRegisterType<QApplicationLauncher>(uri, 1, 0, "ApplicationLauncher");
+    qmlRegisterUncreatableType<QApplicationLauncherOutputModel>(uri, 1, 0, "ApplicationLauncherOutputModel",
+                                                                QLatin1String("ApplicationLauncherOutputModel is returned by ApplicationLauncher.output"));
+    qmlRegisterType<QApplicationNotificationModel>(uri, 1, 0, "ApplicationNotificationModel");
     qmlRegisterType<QLocalSettings>(uri, 1, 0, "LocalSettings");
 
     const QString filesLocation = fileLocation();
@@ -22,6 +22,10 @@
 
 #include "qapplicationcommand.h"
 #include "debughelper.h"
+#include <climits>
+
+static const int acknowledgeTimeout = 3000;     // ms until a sent command has to be acknowledged
+static const int ticketTimeoutInterval = 250;   // ms between checks of the ticket deadlines
 
 QApplicationCommand::QApplicationCommand(QObject *parent) :
     AbstractServiceImplementation(parent),
@@ -32,157 +36,195 @@ QApplicationCommand::QApplicationCommand(QObject *parent) :
     m_connectionState(Disconnected),
     m_error(NoError),
     m_errorString(""),
+    m_maxPendingCommands(0),
+    m_coalescingInterval(50),
+    m_completionTimeout(60000),
     m_context(NULL),
     m_commandSocket(NULL),
     m_commandHeartbeatTimer(new QTimer(this)),
     m_commandPingErrorCount(0),
-    m_commandPingErrorThreshold(2)
+    m_commandPingErrorThreshold(2),
+    m_nextTicket(1),
+    m_ticketsSupported(false),
+    m_trackingTickets(false),
+    m_firstTrackedTicket(0),
+    m_ticketTimeoutTimer(new QTimer(this)),
+    m_coalescingTimer(new QTimer(this))
 {
     m_uuid = QUuid::createUuid();
 
     connect(m_commandHeartbeatTimer, SIGNAL(timeout()),
             this, SLOT(commandHeartbeatTimerTick()));
+
+    m_coalescingTimer->setSingleShot(true);
+    connect(m_coalescingTimer, SIGNAL(timeout()),
+            this, SLOT(coalescingTimerTick()));
+
+    m_ticketClock.start();
+    m_ticketTimeoutTimer->setInterval(ticketTimeoutInterval);
+    connect(m_ticketTimeoutTimer, SIGNAL(timeout()),
+            this, SLOT(ticketTimeoutTimerTick()));
 }
 
-void QApplicationCommand::abort(const QString &interpreter)
+/** Limits the number of commands waiting for completion, 0 means unlimited
+ *  Commands exceeding the window are queued and sent when a slot is free.
+ */
+void QApplicationCommand::setMaxPendingCommands(int arg)
 {
-    if (m_connectionState != Connected) {
+    if (m_maxPendingCommands == arg)
         return;
+
+    m_maxPendingCommands = arg;
+    emit maxPendingCommandsChanged(arg);
+
+    sendQueuedCommands();
+}
+
+int QApplicationCommand::abort(const QString &interpreter)
+{
+    if (m_connectionState != Connected) {
+        return 0;
     }
 
     m_tx.set_interp_name(interpreter.toStdString());
 
-    sendCommandMessage(pb::MT_EMC_TASK_ABORT);
+    QList<int> droppedTickets = takePendingCommands();
+    int ticket = sendUrgentCommandMessage(pb::MT_EMC_TASK_ABORT);
+    failDroppedCommands(droppedTickets, "command aborted");
+
+    return ticket;
 }
 
-void QApplicationCommand::runProgram(const QString &interpreter, int lineNumber = 0)
+int QApplicationCommand::runProgram(const QString &interpreter, int lineNumber = 0)
 {
     if (m_connectionState != Connected) {
-        return;
+        return 0;
     }
 
     pb::EmcCommandParameters *commandParams = m_tx.mutable_emc_command_params();
     commandParams->set_line_number(lineNumber);
     m_tx.set_interp_name(interpreter.toStdString());
 
-    sendCommandMessage(pb::MT_EMC_TASK_PLAN_RUN);
+    return sendCommandMessage(pb::MT_EMC_TASK_PLAN_RUN);
 }
 
-void QApplicationCommand::pauseProgram(const QString &interpreter)
+int QApplicationCommand::pauseProgram(const QString &interpreter)
 {
     if (m_connectionState != Connected) {
-        return;
+        return 0;
     }
 
     m_tx.set_interp_name(interpreter.toStdString());
 
-    sendCommandMessage(pb::MT_EMC_TASK_PLAN_PAUSE);
+    return sendCommandMessage(pb::MT_EMC_TASK_PLAN_PAUSE);
 }
 
-void QApplicationCommand::stepProgram(const QString &interpreter)
+int QApplicationCommand::stepProgram(const QString &interpreter)
 {
     if (m_connectionState != Connected) {
-        return;
+        return 0;
     }
 
     m_tx.set_interp_name(interpreter.toStdString());
 
-    sendCommandMessage(pb::MT_EMC_TASK_PLAN_STEP);
+    return sendCommandMessage(pb::MT_EMC_TASK_PLAN_STEP);
 }
 
-void QApplicationCommand::resumeProgram(const QString &interpreter)
+int QApplicationCommand::resumeProgram(const QString &interpreter)
 {
     if (m_connectionState != Connected) {
-        return;
+        return 0;
     }
 
     m_tx.set_interp_name(interpreter.toStdString());
 
-    sendCommandMessage(pb::MT_EMC_TASK_PLAN_RESUME);
+    return sendCommandMessage(pb::MT_EMC_TASK_PLAN_RESUME);
 }
 
-void QApplicationCommand::setSpindleBrake(QApplicationCommand::SpindleBrake brake)
+int QApplicationCommand::setSpindleBrake(QApplicationCommand::SpindleBrake brake)
 {
     if (m_connectionState != Connected) {
-        return;
+        return 0;
     }
 
     if (brake == EngageBrake)
     {
-        sendCommandMessage(pb::MT_EMC_SPINDLE_BRAKE_ENGAGE);
+        return sendCommandMessage(pb::MT_EMC_SPINDLE_BRAKE_ENGAGE);
     }
     else if (brake == ReleaseBrake)
     {
-        sendCommandMessage(pb::MT_EMC_SPINDLE_BRAKE_RELEASE);
+        return sendCommandMessage(pb::MT_EMC_SPINDLE_BRAKE_RELEASE);
     }
+
+    return 0;
 }
 
-void QApplicationCommand::setDebugLevel(int debugLevel)
+int QApplicationCommand::setDebugLevel(int debugLevel)
 {
     if (m_connectionState != Connected) {
-        return;
+        return 0;
     }
 
     pb::EmcCommandParameters *commandParams = m_tx.mutable_emc_command_params();
     commandParams->set_debug_level(debugLevel);
 
-    sendCommandMessage(pb::MT_EMC_SET_DEBUG);
+    return sendCommandMessage(pb::MT_EMC_SET_DEBUG);
 }
 
-void QApplicationCommand::setFeedOverride(double scale)
+int QApplicationCommand::setFeedOverride(double scale)
 {
     if (m_connectionState != Connected) {
-        return;
+        return 0;
     }
 
     pb::EmcCommandParameters *commandParams = m_tx.mutable_emc_command_params();
     commandParams->set_scale(scale);
 
-    sendCommandMessage(pb::MT_EMC_TRAJ_SET_SCALE);
+    return sendCoalescedCommandMessage(pb::MT_EMC_TRAJ_SET_SCALE, 0);
 }
 
-void QApplicationCommand::setFloodEnabled(bool enable)
+int QApplicationCommand::setFloodEnabled(bool enable)
 {
     if (m_connectionState != Connected) {
-        return;
+        return 0;
     }
 
     if (enable)
     {
-        sendCommandMessage(pb::MT_EMC_COOLANT_FLOOD_ON);
+        return sendCommandMessage(pb::MT_EMC_COOLANT_FLOOD_ON);
     }
     else
     {
-        sendCommandMessage(pb::MT_EMC_COOLANT_FLOOD_OFF);
+        return sendCommandMessage(pb::MT_EMC_COOLANT_FLOOD_OFF);
     }
 }
 
-void QApplicationCommand::homeAxis(int index)
+int QApplicationCommand::homeAxis(int index)
 {
     if (m_connectionState != Connected) {
-        return;
+        return 0;
     }
 
     pb::EmcCommandParameters *commandParams = m_tx.mutable_emc_command_params();
     commandParams->set_index(index);
 
-    sendCommandMessage(pb::MT_EMC_AXIS_HOME);
+    return sendCommandMessage(pb::MT_EMC_AXIS_HOME);
 }
 
-void QApplicationCommand::jog(QApplicationCommand::JogType type, int axisIndex)
+int QApplicationCommand::jog(QApplicationCommand::JogType type, int axisIndex)
 {
-    jog(type, axisIndex, 0.0, 0.0);
+    return jog(type, axisIndex, 0.0, 0.0);
 }
 
-void QApplicationCommand::jog(QApplicationCommand::JogType type, int axisIndex, double velocity)
+int QApplicationCommand::jog(QApplicationCommand::JogType type, int axisIndex, double velocity)
 {
-    jog(type, axisIndex, velocity, 0.0);
+    return jog(type, axisIndex, velocity, 0.0);
 }
 
-void QApplicationCommand::jog(QApplicationCommand::JogType type, int axisIndex, double velocity, double distance)
+int QApplicationCommand::jog(QApplicationCommand::JogType type, int axisIndex, double velocity, double distance)
 {
     if (m_connectionState != Connected) {
-        return;
+        return 0;
     }
 
     pb::ContainerType containerType;
@@ -206,241 +248,254 @@ void QApplicationCommand::jog(QApplicationCommand::JogType type, int axisIndex,
     else
     {
         m_tx.Clear();
-        return;
+        return 0;
     }
 
-    sendCommandMessage(containerType);
+    if (containerType == pb::MT_EMC_AXIS_ABORT)
+    {
+        QList<int> droppedTickets = takePendingCommands(pb::MT_EMC_AXIS_JOG, axisIndex)
+                                    + takePendingCommands(pb::MT_EMC_AXIS_INCR_JOG, axisIndex);
+        int ticket = sendUrgentCommandMessage(containerType);
+        failDroppedCommands(droppedTickets, "command superseded");
+        return ticket;
+    }
+    else if (containerType == pb::MT_EMC_AXIS_JOG)
+    {
+        return sendCoalescedCommandMessage(containerType, axisIndex);
+    }
+
+    return sendCommandMessage(containerType, axisIndex);
 }
 
-void QApplicationCommand::loadToolTable()
+int QApplicationCommand::loadToolTable()
 {
     if (m_connectionState != Connected) {
-        return;
+        return 0;
     }
 
-    sendCommandMessage(pb::MT_EMC_TOOL_LOAD_TOOL_TABLE);
+    return sendCommandMessage(pb::MT_EMC_TOOL_LOAD_TOOL_TABLE);
 }
 
-void QApplicationCommand::setMaximumVelocity(double velocity)
+int QApplicationCommand::setMaximumVelocity(double velocity)
 {
     if (m_connectionState != Connected) {
-        return;
+        return 0;
     }
 
     pb::EmcCommandParameters *commandParams = m_tx.mutable_emc_command_params();
     commandParams->set_velocity(velocity);
 
-    sendCommandMessage(pb::MT_EMC_TRAJ_SET_MAX_VELOCITY);
+    return sendCoalescedCommandMessage(pb::MT_EMC_TRAJ_SET_MAX_VELOCITY, 0);
 }
 
-void QApplicationCommand::executeMdi(const QString &interpreter, const QString &command)
+int QApplicationCommand::executeMdi(const QString &interpreter, const QString &command)
 {
     if (m_connectionState != Connected) {
-        return;
+        return 0;
     }
 
     pb::EmcCommandParameters *commandParams = m_tx.mutable_emc_command_params();
     commandParams->set_command(command.toStdString());
     m_tx.set_interp_name(interpreter.toStdString());
 
-    sendCommandMessage(pb::MT_EMC_TASK_PLAN_EXECUTE);
+    return sendCommandMessage(pb::MT_EMC_TASK_PLAN_EXECUTE);
 }
 
-void QApplicationCommand::setMistEnabled(bool enable)
+int QApplicationCommand::setMistEnabled(bool enable)
 {
     if (m_connectionState != Connected) {
-        return;
+        return 0;
     }
 
     if (enable)
     {
-        sendCommandMessage(pb::MT_EMC_COOLANT_MIST_ON);
+        return sendCommandMessage(pb::MT_EMC_COOLANT_MIST_ON);
     }
     else
     {
-        sendCommandMessage(pb::MT_EMC_COOLANT_MIST_OFF);
+        return sendCommandMessage(pb::MT_EMC_COOLANT_MIST_OFF);
     }
 }
 
-void QApplicationCommand::setTaskMode(const QString &interpreter, TaskMode mode)
+int QApplicationCommand::setTaskMode(const QString &interpreter, TaskMode mode)
 {
     if (m_connectionState != Connected) {
-        return;
+        return 0;
     }
 
     pb::EmcCommandParameters *commandParams = m_tx.mutable_emc_command_params();
     commandParams->set_task_mode((pb::EmcTaskModeType)mode);
     m_tx.set_interp_name(interpreter.toStdString());
 
-    sendCommandMessage(pb::MT_EMC_TASK_SET_MODE);
+    return sendCommandMessage(pb::MT_EMC_TASK_SET_MODE);
 }
 
-void QApplicationCommand::overrideLimits()
+int QApplicationCommand::overrideLimits()
 {
     if (m_connectionState != Connected) {
-        return;
+        return 0;
     }
 
-    sendCommandMessage(pb::MT_EMC_AXIS_OVERRIDE_LIMITS);
+    return sendCommandMessage(pb::MT_EMC_AXIS_OVERRIDE_LIMITS);
 }
 
-void QApplicationCommand::openProgram(const QString &interpreter, const QString &filePath)
+int QApplicationCommand::openProgram(const QString &interpreter, const QString &filePath)
 {
     if (m_connectionState != Connected) {
-        return;
+        return 0;
     }
 
     pb::EmcCommandParameters *commandParams = m_tx.mutable_emc_command_params();
     commandParams->set_path(QUrl(filePath).toLocalFile().toStdString());
     m_tx.set_interp_name(interpreter.toStdString());
 
-    sendCommandMessage(pb::MT_EMC_TASK_PLAN_OPEN);
+    return sendCommandMessage(pb::MT_EMC_TASK_PLAN_OPEN);
 }
 
-void QApplicationCommand::resetProgram(const QString &interpreter)
+int QApplicationCommand::resetProgram(const QString &interpreter)
 {
     if (m_connectionState != Connected) {
-        return;
+        return 0;
     }
 
     m_tx.set_interp_name(interpreter.toStdString());
 
-    sendCommandMessage(pb::MT_EMC_TASK_PLAN_INIT);
+    return sendCommandMessage(pb::MT_EMC_TASK_PLAN_INIT);
 }
 
-void QApplicationCommand::setAdaptiveFeedEnabled(bool enable)
+int QApplicationCommand::setAdaptiveFeedEnabled(bool enable)
 {
     if (m_connectionState != Connected) {
-        return;
+        return 0;
     }
 
     pb::EmcCommandParameters *commandParams = m_tx.mutable_emc_command_params();
     commandParams->set_enable(enable);
 
-    sendCommandMessage(pb::MT_EMC_MOTION_ADAPTIVE);
+    return sendCommandMessage(pb::MT_EMC_MOTION_ADAPTIVE);
 }
 
-void QApplicationCommand::setAnalogOutput(int index, double value)
+int QApplicationCommand::setAnalogOutput(int index, double value)
 {
     if (m_connectionState != Connected) {
-        return;
+        return 0;
     }
 
     pb::EmcCommandParameters *commandParams = m_tx.mutable_emc_command_params();
     commandParams->set_index(index);
     commandParams->set_value(value);
 
-    sendCommandMessage(pb::MT_EMC_MOTION_SET_AOUT);
+    return sendCommandMessage(pb::MT_EMC_MOTION_SET_AOUT);
 }
 
-void QApplicationCommand::setBlockDeleteEnabled(bool enable)
+int QApplicationCommand::setBlockDeleteEnabled(bool enable)
 {
     if (m_connectionState != Connected) {
-        return;
+        return 0;
     }
 
     pb::EmcCommandParameters *commandParams = m_tx.mutable_emc_command_params();
     commandParams->set_enable(enable);
 
-    sendCommandMessage(pb::MT_EMC_TASK_PLAN_SET_BLOCK_DELETE);
+    return sendCommandMessage(pb::MT_EMC_TASK_PLAN_SET_BLOCK_DELETE);
 }
 
-void QApplicationCommand::setDigitalOutput(int index, bool enable)
+int QApplicationCommand::setDigitalOutput(int index, bool enable)
 {
     if (m_connectionState != Connected) {
-        return;
+        return 0;
     }
 
     pb::EmcCommandParameters *commandParams = m_tx.mutable_emc_command_params();
     commandParams->set_index(index);
     commandParams->set_enable(enable);
 
-    sendCommandMessage(pb::MT_EMC_MOTION_SET_DOUT);
+    return sendCommandMessage(pb::MT_EMC_MOTION_SET_DOUT);
 }
 
-void QApplicationCommand::setFeedHoldEnabled(bool enable)
+int QApplicationCommand::setFeedHoldEnabled(bool enable)
 {
     if (m_connectionState != Connected) {
-        return;
+        return 0;
     }
 
     pb::EmcCommandParameters *commandParams = m_tx.mutable_emc_command_params();
     commandParams->set_enable(enable);
 
-    sendCommandMessage(pb::MT_EMC_TRAJ_SET_FH_ENABLE);
+    return sendCommandMessage(pb::MT_EMC_TRAJ_SET_FH_ENABLE);
 }
 
-void QApplicationCommand::setFeedOverrideEnabled(bool enable)
+int QApplicationCommand::setFeedOverrideEnabled(bool enable)
 {
     if (m_connectionState != Connected) {
-        return;
+        return 0;
     }
 
     pb::EmcCommandParameters *commandParams = m_tx.mutable_emc_command_params();
     commandParams->set_enable(enable);
 
-    sendCommandMessage(pb::MT_EMC_TRAJ_SET_FO_ENABLE);
+    return sendCommandMessage(pb::MT_EMC_TRAJ_SET_FO_ENABLE);
 }
 
-void QApplicationCommand::setAxisMaxPositionLimit(int axisIndex, double value)
+int QApplicationCommand::setAxisMaxPositionLimit(int axisIndex, double value)
 {
     if (m_connectionState != Connected) {
-        return;
+        return 0;
     }
 
     pb::EmcCommandParameters *commandParams = m_tx.mutable_emc_command_params();
     commandParams->set_index(axisIndex);
     commandParams->set_value(value);
 
-    sendCommandMessage(pb::MT_EMC_AXIS_SET_MAX_POSITION_LIMIT);
+    return sendCommandMessage(pb::MT_EMC_AXIS_SET_MAX_POSITION_LIMIT);
 }
 
-void QApplicationCommand::setAxisMinPositionLimit(int axisIndex, double value)
+int QApplicationCommand::setAxisMinPositionLimit(int axisIndex, double value)
 {
     if (m_connectionState != Connected) {
-        return;
+        return 0;
     }
 
     pb::EmcCommandParameters *commandParams = m_tx.mutable_emc_command_params();
     commandParams->set_index(axisIndex);
     commandParams->set_value(value);
 
-    sendCommandMessage(pb::MT_EMC_AXIS_SET_MIN_POSITION_LIMIT);
+    return sendCommandMessage(pb::MT_EMC_AXIS_SET_MIN_POSITION_LIMIT);
 }
 
-void QApplicationCommand::setOptionalStopEnabled(bool enable)
+int QApplicationCommand::setOptionalStopEnabled(bool enable)
 {
     if (m_connectionState != Connected) {
-        return;
+        return 0;
     }
 
     pb::EmcCommandParameters *commandParams = m_tx.mutable_emc_command_params();
     commandParams->set_enable(enable);
 
-    sendCommandMessage(pb::MT_EMC_TASK_PLAN_SET_OPTIONAL_STOP);
+    return sendCommandMessage(pb::MT_EMC_TASK_PLAN_SET_OPTIONAL_STOP);
 }
 
-void QApplicationCommand::setSpindleOverrideEnabled(bool enable)
+int QApplicationCommand::setSpindleOverrideEnabled(bool enable)
 {
     if (m_connectionState != Connected) {
-        return;
+        return 0;
     }
 
     pb::EmcCommandParameters *commandParams = m_tx.mutable_emc_command_params();
     commandParams->set_enable(enable);
 
-    sendCommandMessage(pb::MT_EMC_TRAJ_SET_SO_ENABLE);
+    return sendCommandMessage(pb::MT_EMC_TRAJ_SET_SO_ENABLE);
 }
 
-void QApplicationCommand::setSpindle(QApplicationCommand::SpindleMode mode)
+int QApplicationCommand::setSpindle(QApplicationCommand::SpindleMode mode)
 {
-    setSpindle(mode, 0.0);
+    return setSpindle(mode, 0.0);
 }
 
-void QApplicationCommand::setSpindle(QApplicationCommand::SpindleMode mode, double velocity = 0.0)
+int QApplicationCommand::setSpindle(QApplicationCommand::SpindleMode mode, double velocity = 0.0)
 {
     if (m_connectionState != Connected) {
-        return;
+        return 0;
     }
 
     pb::ContainerType containerType;
@@ -469,53 +524,53 @@ void QApplicationCommand::setSpindle(QApplicationCommand::SpindleMode mode, doub
         containerType = pb::MT_EMC_SPINDLE_CONSTANT;
     default:
         m_tx.Clear();
-        return;
+        return 0;
     }
 
-    sendCommandMessage(containerType);
+    return sendCommandMessage(containerType);
 }
 
-void QApplicationCommand::setSpindleOverride(double scale)
+int QApplicationCommand::setSpindleOverride(double scale)
 {
     if (m_connectionState != Connected) {
-        return;
+        return 0;
     }
 
     pb::EmcCommandParameters *commandParams = m_tx.mutable_emc_command_params();
     commandParams->set_scale(scale);
 
-    sendCommandMessage(pb::MT_EMC_TRAJ_SET_SPINDLE_SCALE);
+    return sendCoalescedCommandMessage(pb::MT_EMC_TRAJ_SET_SPINDLE_SCALE, 0);
 }
 
-void QApplicationCommand::setTaskState(const QString &interpreter, TaskState state)
+int QApplicationCommand::setTaskState(const QString &interpreter, TaskState state)
 {
     if (m_connectionState != Connected) {
-        return;
+        return 0;
     }
 
     pb::EmcCommandParameters *commandParams = m_tx.mutable_emc_command_params();
     commandParams->set_task_state((pb::EmcTaskStateType)state);
     m_tx.set_interp_name(interpreter.toStdString());
 
-    sendCommandMessage(pb::MT_EMC_TASK_SET_STATE);
+    return sendCommandMessage(pb::MT_EMC_TASK_SET_STATE);
 }
 
-void QApplicationCommand::setTeleopEnabled(bool enable)
+int QApplicationCommand::setTeleopEnabled(bool enable)
 {
     if (m_connectionState != Connected) {
-        return;
+        return 0;
     }
 
     pb::EmcCommandParameters *commandParams = m_tx.mutable_emc_command_params();
     commandParams->set_enable(enable);
 
-    sendCommandMessage(pb::MT_EMC_TRAJ_SET_TELEOP_ENABLE);
+    return sendCommandMessage(pb::MT_EMC_TRAJ_SET_TELEOP_ENABLE);
 }
 
-void QApplicationCommand::setTeleopVector(double a, double b, double c, double u = 0.0, double v = 0.0, double w = 0.0)
+int QApplicationCommand::setTeleopVector(double a, double b, double c, double u = 0.0, double v = 0.0, double w = 0.0)
 {
     if (m_connectionState != Connected) {
-        return;
+        return 0;
     }
 
     pb::EmcCommandParameters *commandParams = m_tx.mutable_emc_command_params();
@@ -527,13 +582,21 @@ void QApplicationCommand::setTeleopVector(double a, double b, double c, double u
     pose->set_v(v);
     pose->set_w(w);
 
-    sendCommandMessage(pb::MT_EMC_TRAJ_SET_TELEOP_VECTOR);
+    if ((a == 0.0) && (b == 0.0) && (c == 0.0) && (u == 0.0) && (v == 0.0) && (w == 0.0))
+    {
+        QList<int> droppedTickets = takePendingCommands(pb::MT_EMC_TRAJ_SET_TELEOP_VECTOR, 0);
+        int ticket = sendUrgentCommandMessage(pb::MT_EMC_TRAJ_SET_TELEOP_VECTOR);
+        failDroppedCommands(droppedTickets, "command superseded");
+        return ticket;
+    }
+
+    return sendCoalescedCommandMessage(pb::MT_EMC_TRAJ_SET_TELEOP_VECTOR, 0);
 }
 
-void QApplicationCommand::setToolOffset(int index, double zOffset, double xOffset, double diameter, double frontangle, double backangle, int orientation)
+int QApplicationCommand::setToolOffset(int index, double zOffset, double xOffset, double diameter, double frontangle, double backangle, int orientation)
 {
     if (m_connectionState != Connected) {
-        return;
+        return 0;
     }
 
     pb::EmcCommandParameters *commandParams = m_tx.mutable_emc_command_params();
@@ -546,40 +609,40 @@ void QApplicationCommand::setToolOffset(int index, double zOffset, double xOffse
     tooldata->set_backangle(backangle);
     tooldata->set_orientation(orientation);
 
-    sendCommandMessage(pb::MT_EMC_TOOL_SET_OFFSET);
+    return sendCommandMessage(pb::MT_EMC_TOOL_SET_OFFSET);
 }
 
-void QApplicationCommand::setTrajectoryMode(QApplicationStatus::TrajectoryMode mode)
+int QApplicationCommand::setTrajectoryMode(QApplicationStatus::TrajectoryMode mode)
 {
     if (m_connectionState != Connected) {
-        return;
+        return 0;
     }
 
     pb::EmcCommandParameters *commandParams = m_tx.mutable_emc_command_params();
     commandParams->set_traj_mode((pb::EmcTrajectoryModeType)mode);
 
-    sendCommandMessage(pb::MT_EMC_TRAJ_SET_MODE);
+    return sendCommandMessage(pb::MT_EMC_TRAJ_SET_MODE);
 }
 
-void QApplicationCommand::unhomeAxis(int index)
+int QApplicationCommand::unhomeAxis(int index)
 {
     if (m_connectionState != Connected) {
-        return;
+        return 0;
     }
 
     pb::EmcCommandParameters *commandParams = m_tx.mutable_emc_command_params();
     commandParams->set_index(index);
 
-    sendCommandMessage(pb::MT_EMC_AXIS_UNHOME);
+    return sendCommandMessage(pb::MT_EMC_AXIS_UNHOME);
 }
 
-void QApplicationCommand::shutdown()
+int QApplicationCommand::shutdown()
 {
     if (m_connectionState != Connected) {
-        return;
+        return 0;
     }
 
-    sendCommandMessage(pb::MT_SHUTDOWN);
+    return sendCommandMessage(pb::MT_SHUTDOWN);
 }
 
 void QApplicationCommand::start()
@@ -614,6 +677,9 @@ void QApplicationCommand::cleanup()
 {
     stopCommandHeartbeat();
     disconnectSockets();
+    failPendingCommands("connection closed");
+    m_ticketsSupported = false;     // the next server may not support tickets
+    m_trackingTickets = false;
 }
 
 void QApplicationCommand::startCommandHeartbeat()
@@ -682,26 +748,357 @@ void QApplicationCommand::updateError(QApplicationCommand::ConnectionError error
     }
 }
 
-void QApplicationCommand::sendCommandMessage(pb::ContainerType type)
+/** Sends a command and returns its ticket, 0 if it could not be sent
+ *  Pings are sent without ticket. The server reports the progress of a
+ *  command with MT_TICKET_UPDATE messages referring to the ticket. The
+ *  index is the axis of axis commands, a queued command can be dropped
+ *  by type and index when a later command supersedes it.
+ */
+int QApplicationCommand::sendCommandMessage(pb::ContainerType type, int index)
 {
     if (m_commandSocket == NULL) {  // disallow sending messages when not connected
-        return;
+        m_tx.Clear();
+        return 0;
     }
 
-    try {
-        m_tx.set_type(type);
-        m_commandSocket->sendMessage(QByteArray(m_tx.SerializeAsString().c_str(), m_tx.ByteSize()));
+    if (type == pb::MT_PING)
+    {
+        sendSerializedMessage(serializeCommandMessage(type, 0));
+        return 0;
+    }
+
+    QueuedCommand command;
+    command.ticket = nextTicket();
+    command.type = type;
+    command.index = index;
+    command.message = serializeCommandMessage(type, command.ticket);
+
+    return dispatchCommand(command, false);
+}
+
+/** Sends a command ahead of queued commands, ignoring the window */
+int QApplicationCommand::sendUrgentCommandMessage(pb::ContainerType type)
+{
+    if (m_commandSocket == NULL) {
+        m_tx.Clear();
+        return 0;
+    }
+
+    QueuedCommand command;
+    command.ticket = nextTicket();
+    command.type = type;
+    command.index = -1;
+    command.message = serializeCommandMessage(type, command.ticket);
+
+    return dispatchCommand(command, true);
+}
+
+/** Sends a continuous command at most once per coalescing interval
+ *  The first command of an interval is sent right away, later ones
+ *  replace the pending value for the same type and index and keep its
+ *  ticket. The latest value is sent when the interval elapses.
+ */
+int QApplicationCommand::sendCoalescedCommandMessage(pb::ContainerType type, int index)
+{
+    if (m_commandSocket == NULL) {
+        m_tx.Clear();
+        return 0;
+    }
+
+    if (m_coalescingInterval <= 0)
+    {
+        return sendCommandMessage(type, index);
+    }
+
+    if (!m_coalescingTimer->isActive())
+    {
+        m_coalescingTimer->start(m_coalescingInterval);
+        return sendCommandMessage(type, index);
+    }
+
+    QPair<int, int> key = qMakePair((int)type, index);
+    int ticket;
+
+    if (m_coalescedCommands.contains(key))
+    {
+        ticket = m_coalescedCommands.value(key).first;
+    }
+    else
+    {
+        ticket = nextTicket();
+        m_coalescedOrder.append(key);
+    }
+    m_coalescedCommands.insert(key, qMakePair(ticket, serializeCommandMessage(type, ticket)));
+    emit pendingCommandsChanged(pendingCommands());
+
+    return ticket;
+}
+
+int QApplicationCommand::nextTicket()
+{
+    int ticket = m_nextTicket;
+
+    m_nextTicket = (m_nextTicket == INT_MAX) ? 1 : (m_nextTicket + 1);
+
+    return ticket;
+}
+
+QByteArray QApplicationCommand::serializeCommandMessage(pb::ContainerType type, int ticket)
+{
+    m_tx.set_type(type);
+    if (ticket != 0)
+    {
+        m_tx.set_ticket(ticket);
+    }
+    QByteArray message(m_tx.SerializeAsString().c_str(), m_tx.ByteSize());
 #ifdef QT_DEBUG
     std::string s;
     gpb::TextFormat::PrintToString(m_tx, &s);
     DEBUG_TAG(3, "command", "sent message" << QString::fromStdString(s))
 #endif
-        m_tx.Clear();
+    m_tx.Clear();
+
+    return message;
+}
+
+/** Sends a serialized command or queues it if the window is full */
+int QApplicationCommand::dispatchCommand(const QueuedCommand &command, bool urgent)
+{
+    if (!urgent
+        && (!m_queuedCommands.isEmpty()
+            || ((m_maxPendingCommands > 0) && (m_sentTickets.size() >= m_maxPendingCommands))))
+    {
+        m_queuedCommands.enqueue(command);
+        emit pendingCommandsChanged(pendingCommands());
+        return command.ticket;
+    }
+
+    if (!sendSerializedMessage(command.message))
+    {
+        return 0;
+    }
+
+    trackCommand(command.ticket);
+    emit pendingCommandsChanged(pendingCommands());
+
+    return command.ticket;
+}
+
+/** Removes the coalesced and queued commands with the given type and index
+ *  and returns their tickets. Used when a command supersedes them, e.g. a
+ *  stopped jog must not be followed by a jog that was still waiting for a
+ *  slot. The caller fails the tickets once the superseding command is sent,
+ *  handlers of commandFailed may send commands themselves.
+ */
+QList<int> QApplicationCommand::takePendingCommands(pb::ContainerType type, int index)
+{
+    QPair<int, int> key = qMakePair((int)type, index);
+    QList<int> tickets;
+
+    if (m_coalescedCommands.contains(key))
+    {
+        tickets.append(m_coalescedCommands.take(key).first);
+        m_coalescedOrder.removeOne(key);
+    }
+
+    QMutableListIterator<QueuedCommand> it(m_queuedCommands);
+    while (it.hasNext())
+    {
+        const QueuedCommand &command = it.next();
+        if ((command.type == (int)type) && (command.index == index))
+        {
+            tickets.append(command.ticket);
+            it.remove();
+        }
+    }
+
+    return tickets;
+}
+
+/** Removes all commands that have not been sent yet and returns their tickets, used by abort */
+QList<int> QApplicationCommand::takePendingCommands()
+{
+    QList<int> tickets;
+
+    while (!m_queuedCommands.isEmpty())
+    {
+        tickets.append(m_queuedCommands.dequeue().ticket);
+    }
+    for (int i = 0; i < m_coalescedOrder.size(); ++i)
+    {
+        tickets.append(m_coalescedCommands.value(m_coalescedOrder.at(i)).first);
+    }
+    m_coalescedCommands.clear();
+    m_coalescedOrder.clear();
+
+    return tickets;
+}
+
+void QApplicationCommand::failDroppedCommands(QList<int> tickets, const QString &errorString)
+{
+    if (tickets.isEmpty())
+    {
+        return;
+    }
+
+    qSort(tickets);
+    emit pendingCommandsChanged(pendingCommands());
+    foreach (int ticket, tickets)
+    {
+        emit commandFailed(ticket, errorString);
+    }
+}
+
+bool QApplicationCommand::sendSerializedMessage(const QByteArray &message)
+{
+    try {
+        m_commandSocket->sendMessage(message);
     }
     catch (const zmq::error_t &e) {
         QString errorString;
         errorString = QString("Error %1: ").arg(e.num()) + QString(e.what());
         updateState(Error, SocketError, errorString);
+        return false;
+    }
+
+    return true;
+}
+
+/** Sends queued commands until the window is full */
+void QApplicationCommand::sendQueuedCommands()
+{
+    if (m_queuedCommands.isEmpty())
+    {
+        return;
+    }
+
+    while (!m_queuedCommands.isEmpty()
+           && ((m_maxPendingCommands <= 0) || (m_sentTickets.size() < m_maxPendingCommands)))
+    {
+        QueuedCommand command = m_queuedCommands.head();
+
+        if ((m_commandSocket == NULL) || !sendSerializedMessage(command.message))
+        {
+            return; // cleanup fails the remaining commands
+        }
+
+        m_queuedCommands.dequeue();
+        trackCommand(command.ticket);
+    }
+}
+
+/** Tracks a sent command until it is finished or times out
+ *  Commands are tracked once a window is set or the server has shown
+ *  ticket support, which then stays on until the connection is closed.
+ *  Without both the commands are fire and forget, tracking them would
+ *  only fail them after the timeout.
+ */
+void QApplicationCommand::trackCommand(int ticket)
+{
+    if (!m_trackingTickets)
+    {
+        if ((m_maxPendingCommands <= 0) && !m_ticketsSupported)
+        {
+            return;
+        }
+        m_trackingTickets = true;
+        m_firstTrackedTicket = ticket;
+    }
+
+    m_sentTickets.insert(ticket);
+    m_unacknowledgedTickets.insert(ticket);
+    m_ticketDeadlines.insert(ticket, m_ticketClock.elapsed() + acknowledgeTimeout);
+
+    if (!m_ticketTimeoutTimer->isActive())
+    {
+        m_ticketTimeoutTimer->start();
+    }
+}
+
+/** Returns true for tickets sent before the tracking started
+ *  Their ticket updates are passed on without bookkeeping.
+ */
+bool QApplicationCommand::isUntrackedTicket(int ticket) const
+{
+    if (m_sentTickets.contains(ticket) || (ticket <= 0) || (ticket >= m_nextTicket))
+    {
+        return false;
+    }
+
+    return !m_trackingTickets || (ticket < m_firstTrackedTicket);
+}
+
+/** Gives an acknowledged command completionTimeout until it is finished */
+void QApplicationCommand::updateTicketDeadline(int ticket)
+{
+    if (m_completionTimeout > 0)
+    {
+        m_ticketDeadlines.insert(ticket, m_ticketClock.elapsed() + m_completionTimeout);
+    }
+    else
+    {
+        m_ticketDeadlines.remove(ticket);
+    }
+}
+
+void QApplicationCommand::finishCommand(int ticket, bool success, const QString &errorString)
+{
+    if (m_sentTickets.remove(ticket))
+    {
+        m_unacknowledgedTickets.remove(ticket);
+        m_ticketDeadlines.remove(ticket);
+
+        sendQueuedCommands();
+        emit pendingCommandsChanged(pendingCommands());
+    }
+    else if (!isUntrackedTicket(ticket))
+    {
+        return; // unknown or already finished
+    }
+
+    if (success)
+    {
+        emit commandCompleted(ticket);
+    }
+    else
+    {
+        emit commandFailed(ticket, errorString);
+    }
+}
+
+/** Fails all sent and queued commands, used when the connection is lost */
+void QApplicationCommand::failPendingCommands(const QString &errorString)
+{
+    QList<int> tickets;
+
+    m_coalescingTimer->stop();
+
+    if (m_sentTickets.isEmpty() && m_queuedCommands.isEmpty() && m_coalescedCommands.isEmpty())
+    {
+        return;
+    }
+
+    tickets = m_sentTickets.toList();
+    qSort(tickets);
+    while (!m_queuedCommands.isEmpty())
+    {
+        tickets.append(m_queuedCommands.dequeue().ticket);
+    }
+    for (int i = 0; i < m_coalescedOrder.size(); ++i)
+    {
+        tickets.append(m_coalescedCommands.value(m_coalescedOrder.at(i)).first);
+    }
+    m_coalescedCommands.clear();
+    m_coalescedOrder.clear();
+    m_sentTickets.clear();
+    m_unacknowledgedTickets.clear();
+    m_ticketDeadlines.clear();
+    m_ticketTimeoutTimer->stop();
+
+    emit pendingCommandsChanged(0);
+    foreach (int ticket, tickets)
+    {
+        emit commandFailed(ticket, errorString);
     }
 }
 
@@ -728,6 +1125,37 @@ void QApplicationCommand::commandMessageReceived(const QList<QByteArray> &messag
 
 #ifdef QT_DEBUG
         DEBUG_TAG(2, "command", "ping ack")
+#endif
+        return;
+    }
+    else if (m_rx.type() == pb::MT_TICKET_UPDATE)
+    {
+        const pb::TicketUpdate &ticketUpdate = m_rx.ticket_update();
+        int ticket = (int)ticketUpdate.cticket();
+
+        m_ticketsSupported = true;
+
+        if (m_unacknowledgedTickets.remove(ticket)
+            || (isUntrackedTicket(ticket) && (ticketUpdate.status() == pb::RCS_RECEIVED)))
+        {
+            emit commandAcknowledged(ticket);
+        }
+
+        if (ticketUpdate.status() == pb::RCS_DONE)
+        {
+            finishCommand(ticket, true, "");
+        }
+        else if (ticketUpdate.status() == pb::RCS_ERROR)
+        {
+            finishCommand(ticket, false, QString::fromStdString(ticketUpdate.text()));
+        }
+        else if (m_sentTickets.contains(ticket))
+        {
+            updateTicketDeadline(ticket);
+        }
+
+#ifdef QT_DEBUG
+        DEBUG_TAG(2, "command", "ticket update" << ticket << ticketUpdate.status())
 #endif
         return;
     }
@@ -740,6 +1168,12 @@ void QApplicationCommand::commandMessageReceived(const QList<QByteArray> &messag
             errorString.append(QString::fromStdString(m_rx.note(i)) + "\n");
         }
 
+        if (m_rx.has_reply_ticket())    // the command failed, not the connection
+        {
+            finishCommand(m_rx.reply_ticket(), false, errorString);
+            return;
+        }
+
         m_commandSocketState = Down;
         updateState(Error, ServiceError, errorString); // not sure if we should really disconnect here
 
@@ -785,6 +1219,84 @@ void QApplicationCommand::commandHeartbeatTimerTick()
 #endif
 }
 
+/** Fails the tracked commands whose deadline passed
+ *  A sent command has to be acknowledged within acknowledgeTimeout, a
+ *  server without ticket support would block the window forever
+ *  otherwise. An acknowledged command has completionTimeout after its
+ *  last ticket update to finish.
+ */
+void QApplicationCommand::ticketTimeoutTimerTick()
+{
+    qint64 now = m_ticketClock.elapsed();
+    QList<int> tickets;
+
+    QHashIterator<int, qint64> i(m_ticketDeadlines);
+    while (i.hasNext())
+    {
+        i.next();
+        if (i.value() <= now)
+        {
+            tickets.append(i.key());
+        }
+    }
+
+    qSort(tickets);
+    foreach (int ticket, tickets)
+    {
+        if (m_unacknowledgedTickets.contains(ticket))
+        {
+            finishCommand(ticket, false, "command not acknowledged by the server");
+        }
+        else
+        {
+            finishCommand(ticket, false, "command not completed by the server");
+        }
+    }
+
+    if (m_ticketDeadlines.isEmpty())
+    {
+        m_ticketTimeoutTimer->stop();
+    }
+}
+
+/** Sends the latest value of every coalesced command */
+void QApplicationCommand::coalescingTimerTick()
+{
+    QHash<QPair<int, int>, QPair<int, QByteArray> > commands = m_coalescedCommands;
+    QList<QPair<int, int> > order = m_coalescedOrder;
+
+    if (order.isEmpty())
+    {
+        return;
+    }
+
+    m_coalescedCommands.clear();
+    m_coalescedOrder.clear();
+
+    for (int i = 0; i < order.size(); ++i)
+    {
+        QueuedCommand command;
+        command.ticket = commands.value(order.at(i)).first;
+        command.type = order.at(i).first;
+        command.index = order.at(i).second;
+        command.message = commands.value(order.at(i)).second;
+
+        if ((m_commandSocket == NULL) || (dispatchCommand(command, false) == 0))
+        {
+            for (int j = i; j < order.size(); ++j)  // the connection is gone
+            {
+                emit commandFailed(commands.value(order.at(j)).first, "connection closed");
+            }
+            return;
+        }
+    }
+
+    if (m_coalescingInterval > 0)
+    {
+        m_coalescingTimer->start(m_coalescingInterval);
+    }
+}
+
 /** Connects the 0MQ sockets */
 bool QApplicationCommand::connectSockets()
 {
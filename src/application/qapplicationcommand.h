@@ -25,7 +25,12 @@
 
 #include <abstractserviceimplementation.h>
 #include <QTimer>
+#include <QElapsedTimer>
 #include <QUrl>
+#include <QSet>
+#include <QQueue>
+#include <QPair>
+#include <QHash>
 #include <QCoreApplication>
 #include <QHostInfo>
 #include <nzmqt/nzmqt.hpp>
@@ -43,6 +48,27 @@ namespace gpb = google::protobuf;
 
 using namespace nzmqt;
 
+/** Sends commands to the Machinekit command service
+ *
+ *  Every command returns a ticket number, 0 if the command was not sent.
+ *  The commandAcknowledged, commandCompleted and commandFailed signals
+ *  refer to this ticket, so a sequence of commands can be sent without
+ *  waiting and still react to the completion of each command. With
+ *  maxPendingCommands set, commands exceeding the window are queued.
+ *
+ *  Sent commands are tracked once a window is set or the server has sent
+ *  a ticket update, otherwise they are fire and forget. A tracked command
+ *  fails if the server does not acknowledge it within three seconds or,
+ *  once acknowledged, does not finish it within completionTimeout.
+ *
+ *  Continuous commands like overrides, maximum velocity, teleop vector
+ *  and continuous jog are coalesced: within coalescingInterval only the
+ *  latest value per command and axis is kept and sent when the interval
+ *  elapses. Stopping a jog, a zero teleop vector and abort are sent
+ *  immediately. Stopping a jog discards the coalesced and queued jogs of
+ *  the axis, a zero teleop vector the pending teleop vectors and abort
+ *  every command not sent yet. Discarded commands are failed.
+ */
 class QApplicationCommand : public AbstractServiceImplementation
 {
     Q_OBJECT
@@ -52,6 +78,10 @@ class QApplicationCommand : public AbstractServiceImplementation
     Q_PROPERTY(State connectionState READ connectionState NOTIFY connectionStateChanged)
     Q_PROPERTY(ConnectionError error READ error NOTIFY errorChanged)
     Q_PROPERTY(QString errorString READ errorString NOTIFY errorStringChanged)
+    Q_PROPERTY(int maxPendingCommands READ maxPendingCommands WRITE setMaxPendingCommands NOTIFY maxPendingCommandsChanged)
+    Q_PROPERTY(int pendingCommands READ pendingCommands NOTIFY pendingCommandsChanged)
+    Q_PROPERTY(int coalescingInterval READ coalescingInterval WRITE setCoalescingInterval NOTIFY coalescingIntervalChanged)
+    Q_PROPERTY(int completionTimeout READ completionTimeout WRITE setCompletionTimeout NOTIFY completionTimeoutChanged)
     Q_ENUMS(State ConnectionError SpindleBrake JogType TaskState TaskMode SpindleMode)
 
 public:
@@ -140,6 +170,26 @@ public:
         return m_connected;
     }
 
+    int maxPendingCommands() const
+    {
+        return m_maxPendingCommands;
+    }
+
+    int pendingCommands() const
+    {
+        return m_sentTickets.size() + m_queuedCommands.size() + m_coalescedCommands.size();
+    }
+
+    int coalescingInterval() const
+    {
+        return m_coalescingInterval;
+    }
+
+    int completionTimeout() const
+    {
+        return m_completionTimeout;
+    }
+
 public slots:
 
     void setCommandUri(QString arg)
@@ -160,48 +210,74 @@ public slots:
         emit heartbeatPeriodChanged(arg);
     }
 
-    void abort(const QString &interpreter);
-    void runProgram(const QString &interpreter, int lineNumber);
-    void pauseProgram(const QString &interpreter);
-    void stepProgram(const QString &interpreter);
-    void resumeProgram(const QString &interpreter);
-    void resetProgram(const QString &interpreter);
-    void setTaskMode(const QString &interpreter, TaskMode mode);
-    void setTaskState(const QString &interpreter, TaskState state);
-    void openProgram(const QString &interpreter, const QString &fileName);
-    void executeMdi(const QString &interpreter, const QString &command);
-    void setSpindleBrake(SpindleBrake brake);
-    void setDebugLevel(int debugLevel);
-    void setFeedOverride(double scale);
-    void setFloodEnabled(bool enable);
-    void homeAxis(int index);
-    void jog(JogType type, int axisIndex);
-    void jog(JogType type, int axisIndex, double velocity);
-    void jog(JogType type, int axisIndex, double velocity, double distance);
-    void loadToolTable();
-    void setMaximumVelocity(double velocity);
-    void setMistEnabled(bool enable);
-    void overrideLimits();
-    void setAdaptiveFeedEnabled(bool enable);
-    void setAnalogOutput(int index, double value);
-    void setBlockDeleteEnabled(bool enable);
-    void setDigitalOutput(int index, bool enable);
-    void setFeedHoldEnabled(bool enable);
-    void setFeedOverrideEnabled(bool enable);
-    void setAxisMaxPositionLimit(int axisIndex, double value);
-    void setAxisMinPositionLimit(int axisIndex, double value);
-    void setOptionalStopEnabled(bool enable);
-    void setSpindleOverrideEnabled(bool enable);
-    void setSpindle(SpindleMode mode);
-    void setSpindle(SpindleMode mode, double velocity);
-    void setSpindleOverride(double scale);
-    void setTeleopEnabled(bool enable);
-    void setTeleopVector(double a, double b, double c, double u, double v, double w);
-    void setToolOffset(int index, double zOffset, double xOffset, double diameter, double frontangle, double backangle, int orientation);
-    void setTrajectoryMode(QApplicationStatus::TrajectoryMode mode);
-    void unhomeAxis(int index);
-    void shutdown();
+    void setMaxPendingCommands(int arg);
+
+    void setCoalescingInterval(int arg)
+    {
+        if (m_coalescingInterval == arg)
+            return;
+
+        m_coalescingInterval = arg;
+        emit coalescingIntervalChanged(arg);
+    }
+
+    void setCompletionTimeout(int arg)
+    {
+        if (m_completionTimeout == arg)
+            return;
+
+        m_completionTimeout = arg;
+        emit completionTimeoutChanged(arg);
+    }
+
+    int abort(const QString &interpreter);
+    int runProgram(const QString &interpreter, int lineNumber);
+    int pauseProgram(const QString &interpreter);
+    int stepProgram(const QString &interpreter);
+    int resumeProgram(const QString &interpreter);
+    int resetProgram(const QString &interpreter);
+    int setTaskMode(const QString &interpreter, TaskMode mode);
+    int setTaskState(const QString &interpreter, TaskState state);
+    int openProgram(const QString &interpreter, const QString &fileName);
+    int executeMdi(const QString &interpreter, const QString &command);
+    int setSpindleBrake(SpindleBrake brake);
+    int setDebugLevel(int debugLevel);
+    int setFeedOverride(double scale);
+    int setFloodEnabled(bool enable);
+    int homeAxis(int index);
+    int jog(JogType type, int axisIndex);
+    int jog(JogType type, int axisIndex, double velocity);
+    int jog(JogType type, int axisIndex, double velocity, double distance);
+    int loadToolTable();
+    int setMaximumVelocity(double velocity);
+    int setMistEnabled(bool enable);
+    int overrideLimits();
+    int setAdaptiveFeedEnabled(bool enable);
+    int setAnalogOutput(int index, double value);
+    int setBlockDeleteEnabled(bool enable);
+    int setDigitalOutput(int index, bool enable);
+    int setFeedHoldEnabled(bool enable);
+    int setFeedOverrideEnabled(bool enable);
+    int setAxisMaxPositionLimit(int axisIndex, double value);
+    int setAxisMinPositionLimit(int axisIndex, double value);
+    int setOptionalStopEnabled(bool enable);
+    int setSpindleOverrideEnabled(bool enable);
+    int setSpindle(SpindleMode mode);
+    int setSpindle(SpindleMode mode, double velocity);
+    int setSpindleOverride(double scale);
+    int setTeleopEnabled(bool enable);
+    int setTeleopVector(double a, double b, double c, double u, double v, double w);
+    int setToolOffset(int index, double zOffset, double xOffset, double diameter, double frontangle, double backangle, int orientation);
+    int setTrajectoryMode(QApplicationStatus::TrajectoryMode mode);
+    int unhomeAxis(int index);
+    int shutdown();
 private:
+    struct QueuedCommand {
+        int ticket;
+        int type;
+        int index;      // axis or -1
+        QByteArray message;
+    };
 
     QString         m_commandUri;
     int             m_heartbeatPeriod;
@@ -210,6 +286,9 @@ private:
     State           m_connectionState;
     ConnectionError m_error;
     QString         m_errorString;
+    int             m_maxPendingCommands;
+    int             m_coalescingInterval;
+    int             m_completionTimeout;
 
     PollingZMQContext *m_context;
     ZMQSocket   *m_commandSocket;
@@ -220,6 +299,19 @@ private:
     // more efficient to reuse a protobuf Message
     pb::Container   m_rx;
     pb::Container   m_tx;
+    int             m_nextTicket;
+    bool            m_ticketsSupported;         // the server sent a ticket update
+    bool            m_trackingTickets;
+    int             m_firstTrackedTicket;
+    QSet<int>       m_sentTickets;              // sent, tracked and not finished
+    QSet<int>       m_unacknowledgedTickets;    // sent and not seen by the server yet
+    QHash<int, qint64> m_ticketDeadlines;       // ticket -> ms on m_ticketClock
+    QElapsedTimer   m_ticketClock;
+    QTimer          *m_ticketTimeoutTimer;
+    QQueue<QueuedCommand> m_queuedCommands;    // waiting for a free slot in the window
+    QTimer          *m_coalescingTimer;
+    QHash<QPair<int, int>, QPair<int, QByteArray> > m_coalescedCommands;   // type and axis -> ticket and message
+    QList<QPair<int, int> > m_coalescedOrder;
 
     void start();
     void stop();
@@ -229,12 +321,29 @@ private:
     void updateState(State state);
     void updateState(State state, ConnectionError error, const QString &errorString);
     void updateError(ConnectionError error, const QString &errorString);
-    void sendCommandMessage(pb::ContainerType type);
+    int sendCommandMessage(pb::ContainerType type, int index = -1);
+    int sendUrgentCommandMessage(pb::ContainerType type);
+    int sendCoalescedCommandMessage(pb::ContainerType type, int index);
+    int nextTicket();
+    QByteArray serializeCommandMessage(pb::ContainerType type, int ticket);
+    int dispatchCommand(const QueuedCommand &command, bool urgent);
+    QList<int> takePendingCommands(pb::ContainerType type, int index);
+    QList<int> takePendingCommands();
+    void failDroppedCommands(QList<int> tickets, const QString &errorString);
+    bool sendSerializedMessage(const QByteArray &message);
+    void sendQueuedCommands();
+    void finishCommand(int ticket, bool success, const QString &errorString);
+    void failPendingCommands(const QString &errorString);
+    void trackCommand(int ticket);
+    bool isUntrackedTicket(int ticket) const;
+    void updateTicketDeadline(int ticket);
 
 private slots:
     void commandMessageReceived(const QList<QByteArray> &messageList);
     void pollError(int errorNum, const QString &errorMsg);
     void commandHeartbeatTimerTick();
+    void coalescingTimerTick();
+    void ticketTimeoutTimerTick();
 
     bool connectSockets();
     void disconnectSockets();
@@ -246,6 +355,13 @@ signals:
     void errorStringChanged(QString arg);
     void heartbeatPeriodChanged(int arg);
     void connectedChanged(bool arg);
+    void maxPendingCommandsChanged(int arg);
+    void pendingCommandsChanged(int arg);
+    void coalescingIntervalChanged(int arg);
+    void completionTimeoutChanged(int arg);
+    void commandAcknowledged(int ticket);
+    void commandCompleted(int ticket);
+    void commandFailed(int ticket, const QString &errorString);
 };
 
 #endif // QEMCCOMMAND_H
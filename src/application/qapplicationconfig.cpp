@@ -21,6 +21,13 @@
 ****************************************************************************/
 #include "qapplicationconfig.h"
 #include "service.h"
+#include "applicationfileextractor.h"
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QJsonDocument>
+#include <QSaveFile>
+#include <QSet>
+#include <QStandardPaths>
 
 /*!
     \qmltype ApplicationConfig
@@ -149,6 +156,35 @@
     The filter values are AND connected.
 */
 
+/*! \qmlproperty bool ApplicationConfig::cacheEnabled
+
+    This property holds whether the files of the selected application are
+    kept in a content-addressed cache in \l cachePath. The cache does not
+    reduce the network traffic: the config protocol has no way to tell the
+    server which files are known, so every file is still transferred. The
+    hashes are derived from the received content and only save the local
+    work.
+
+    Complete applications are kept as bundles in a directory named by the
+    hash of their content. When the received files are the same as on the
+    last download and the bundle still exists, the application is loaded
+    from the bundle without decompressing or writing any file. Equal
+    content, for example the same UI on another machine, shares a bundle.
+    With Qt 5.8 or later the main file is compiled before
+    \l{ApplicationConfigItem::loaded} is set, the QML disk cache next to
+    the bundle files is reused on subsequent loads.
+
+    The default value is \c{false}.
+*/
+
+/*! \qmlproperty string ApplicationConfig::cachePath
+
+    This property holds the directory of the application file cache.
+
+    The default value is the \c{applications} directory in the application
+    cache directory.
+*/
+
 /*! \qmlmethod void QApplicationConfig::selectConfig(QString name)
 
     Selects the configuration with the given name and updates \l{selectedConfig}.
@@ -170,13 +206,32 @@ QApplicationConfig::QApplicationConfig(QQuickItem *parent) :
      m_errorString(""),
      m_selectedConfig(new QApplicationConfigItem(this)),
      m_filter(new QApplicationConfigFilter(this)),
+     m_cacheEnabled(false),
+     m_cachePath(""),
+     m_extractionPool(new QThreadPool(this)),
+     m_extractionGeneration(0),
+     m_extractionPending(0),
+     m_extractionTotal(0),
+     m_extractionFailed(false),
+     m_applicationPath(""),
+     m_applicationPathPersistent(false),
+     m_precompiledComponent(NULL),
      m_context(NULL),
      m_configSocket(NULL)
 {
+    QString basePath;
+#ifndef PORTABLE
+    basePath = QStandardPaths::writableLocation(QStandardPaths::CacheLocation);
+#else
+    basePath = QDir::currentPath();
+#endif
+    m_cachePath = QDir(basePath).filePath("applications");
 }
 
 QApplicationConfig::~QApplicationConfig()
 {
+    cancelExtraction();
+    m_extractionPool->waitForDone();    // workers reference m_extractionGeneration
     disconnectSocket();
     cleanupFiles();
 }
@@ -233,6 +288,16 @@ QString QApplicationConfig::errorString() const
     return m_errorString;
 }
 
+bool QApplicationConfig::isCacheEnabled() const
+{
+    return m_cacheEnabled;
+}
+
+QString QApplicationConfig::cachePath() const
+{
+    return m_cachePath;
+}
+
 QQmlListProperty<QApplicationConfigItem> QApplicationConfig::configs()
 {
     return QQmlListProperty<QApplicationConfigItem>(this, m_configs);
@@ -290,6 +355,24 @@ void QApplicationConfig::setFilter(QApplicationConfigFilter *arg)
     emit filterChanged(arg);
 }
 
+void QApplicationConfig::setCacheEnabled(bool arg)
+{
+    if (m_cacheEnabled == arg)
+        return;
+
+    m_cacheEnabled = arg;
+    emit cacheEnabledChanged(arg);
+}
+
+void QApplicationConfig::setCachePath(QString arg)
+{
+    if (m_cachePath == arg)
+        return;
+
+    m_cachePath = arg;
+    emit cachePathChanged(arg);
+}
+
 void QApplicationConfig::start()
 {
 #ifdef QT_DEBUG
@@ -452,9 +535,7 @@ void QApplicationConfig::configMessageReceived(QList<QByteArray> messageList)
     {
         for (int i = 0; i < m_rx.app_size(); ++i)
         {
-            pb::Application app;
-
-            app = m_rx.app(i);
+            const pb::Application &app = m_rx.app(i);
 
             QApplicationConfigItem::ApplicationType type;
 
@@ -463,7 +544,6 @@ void QApplicationConfig::configMessageReceived(QList<QByteArray> messageList)
             if (m_filter->type() == type)     // detail comes when application was already filtered, so we only check the type to make sure it is compatible
             {
                 QString baseFilePath;
-                QStringList fileList;
                 QDir dir;
 
                 if (m_selectedConfig == NULL)
@@ -475,10 +555,48 @@ void QApplicationConfig::configMessageReceived(QList<QByteArray> messageList)
                 m_selectedConfig->setDescription(QString::fromStdString(app.description()));
                 m_selectedConfig->setType(type);
 
-                baseFilePath = Service::applicationTempPath(m_selectedConfig->name());
+                cancelExtraction();
+                removeApplicationDirectory();       // directory of an older request, its workers do not write anymore
+                m_extractionPending = 0;
+                m_extractionTotal = 0;
+                m_extractionFailed = false;
+                m_extractedManifest = QJsonObject();
+                m_extractedSource = "";
+                m_selectedConfig->setProgress(0.0);
+
+                if (m_cacheEnabled && (app.file_size() > 0))
+                {
+                    QJsonObject manifest = loadManifest(m_selectedConfig->name());
+                    QString bundle = manifest.value("bundle").toString();
+
+                    m_extractedSource = sourceHash(app);
+                    if ((manifest.value("source").toString() == m_extractedSource)
+                        && !bundle.isEmpty() && QFileInfo(bundlePath(bundle)).isDir())   // unchanged since the last download
+                    {
+                        m_extractedManifest = manifest.value("files").toObject();
+                        m_applicationPath = bundlePath(bundle);
+                        m_applicationPathPersistent = true;
+                        finishExtraction();
+                        continue;
+                    }
+
+                    baseFilePath = QDir(m_cachePath).filePath(QString("bundles/.staging-%1-%2/")
+                                                              .arg(QCoreApplication::applicationPid())
+                                                              .arg(m_extractionGeneration.load()));
+                }
+                else    // one directory per request, a late worker of an older request never touches it
+                {
+                    baseFilePath = QString("%1%2/").arg(Service::applicationTempPath(m_selectedConfig->name()))
+                                                   .arg(m_extractionGeneration.load());
+                }
+                m_applicationPath = baseFilePath;
+
                 if (!dir.mkpath(baseFilePath))
                 {
                     qDebug() << "not able to create directory";
+                    removeApplicationDirectory();
+                    m_selectedConfig->setLoading(false);
+                    continue;
                 }
 
 #ifdef QT_DEBUG
@@ -487,62 +605,178 @@ void QApplicationConfig::configMessageReceived(QList<QByteArray> messageList)
 
                 for (int j = 0; j < app.file_size(); ++j)
                 {
-                    pb::File file;
-                    QString filePath;
-                    QByteArray data;
+                    const pb::File &file = app.file(j);
+                    QString fileName;
+                    ApplicationFileExtractor *extractor;
 
-                    file = app.file(j);
-                    filePath = baseFilePath + QString::fromStdString(file.name());
+                    fileName = QString::fromStdString(file.name());
+                    extractor = new ApplicationFileExtractor(this, &m_extractionGeneration, fileName, baseFilePath + fileName);
 
-                    QFileInfo fileInfo(filePath);
-                    if (!dir.mkpath(fileInfo.absolutePath()))
+                    if (file.has_blob())
                     {
-                        qDebug() << "not able to create directory";
+                        if ((file.encoding() != pb::ZLIB) && (file.encoding() != pb::CLEARTEXT))
+                        {
+                            qDebug() << "unknown encoding";
+                            delete extractor;
+                            continue;
+                        }
+
+                        extractor->setData(QByteArray(file.blob().data(), file.blob().size()), file.encoding() == pb::ZLIB);
                     }
-
-                    QFile localFile(filePath);
-                    if (!localFile.open(QIODevice::WriteOnly))
+                    else
                     {
-                        qDebug() << "not able to create file" << filePath;
+                        delete extractor;
                         continue;
                     }
 
-                    data = QByteArray(file.blob().data(), file.blob().size());
+                    m_extractionPending++;
+                    m_extractionTotal++;
+                    m_extractionPool->start(extractor);
+                }
 
-                    if (file.encoding() == pb::ZLIB)
-                    {
-                        quint32 test = ((quint32)data.at(0) << 24) + ((quint32)data.at(1) << 16) + ((quint32)data.at(2) << 8) + ((quint32)data.at(3) << 0);
-                        qDebug() << test << (quint8)data.at(0) << (quint8)data.at(1) << (quint8)data.at(2) << (quint8)data.at(3);   // TODO
-                        data = qUncompress(data);
-                    }
-                    else if (file.encoding() != pb::CLEARTEXT)
-                    {
-                        qDebug() << "unknown encoding";
-                        localFile.close();
-                        continue;
-                    }
+                if (m_extractionPending == 0)
+                {
+                    finishExtraction();
+                }
+            }
+        }
+    }
+}
 
-                    localFile.write(data);
-                    localFile.close();
+/** Called by the file extractors when a file is written, the application is
+ *  loaded once all files of the current request are done
+ */
+void QApplicationConfig::fileExtracted(int generation, const QString &fileName, const QString &filePath, const QString &hash, bool success)
+{
+    if (generation != m_extractionGeneration.load())
+    {
+        return;
+    }
 
-                    fileList.append(filePath);
+    if (success)
+    {
+        m_extractedManifest.insert(fileName, hash);
 
 #ifdef QT_DEBUG
-                    qDebug() << "created file: " << filePath;
+        qDebug() << "created file: " << filePath;
 #endif
-                }
+    }
+    else
+    {
+        qDebug() << "not able to create file" << filePath;
+        m_extractionFailed = true;
+    }
 
-                QApplicationDescription applicationDescription;
+    m_extractionPending--;
+    m_selectedConfig->setProgress((double)(m_extractionTotal - m_extractionPending) / m_extractionTotal);
 
-                applicationDescription.setSourceDir(QUrl("file:///" + baseFilePath));
-                // TODO check validity
+    if (m_extractionPending == 0)
+    {
+        finishExtraction();
+    }
+}
 
-                m_selectedConfig->setFiles(fileList);
-                m_selectedConfig->setMainFile(applicationDescription.mainFile());
-                m_selectedConfig->setLoaded(true);
-                m_selectedConfig->setLoading(false);
-            }
-        }
+void QApplicationConfig::finishExtraction()
+{
+    QStringList fileList;
+
+    if (m_extractionFailed)     // an incomplete application is not loaded
+    {
+        removeApplicationDirectory();
+        m_selectedConfig->setProgress(0.0);
+        m_selectedConfig->setLoading(false);
+        return;
+    }
+
+    if (m_cacheEnabled && !m_extractedSource.isEmpty())
+    {
+        QString hash = bundleHash(m_extractedManifest);
+
+        m_applicationPath = promoteBundle(m_applicationPath, bundlePath(hash));
+        m_applicationPathPersistent = (m_applicationPath == bundlePath(hash));
+        saveManifest(m_selectedConfig->name(), m_extractedManifest, hash, m_extractedSource);
+    }
+
+    foreach (const QString &fileName, m_extractedManifest.keys())
+    {
+        fileList.append(m_applicationPath + fileName);
+    }
+
+    QApplicationDescription applicationDescription;
+
+    applicationDescription.setSourceDir(QUrl("file:///" + m_applicationPath));
+    // TODO check validity
+
+    m_selectedConfig->setFiles(fileList);
+    m_selectedConfig->setMainFile(applicationDescription.mainFile());
+    m_selectedConfig->setProgress(1.0);
+
+    if (!precompile(applicationDescription.mainFile()))
+    {
+        m_selectedConfig->setLoaded(true);
+        m_selectedConfig->setLoading(false);
+    }
+}
+
+/** Compiles the main file asynchronously before the application is reported
+ *  as loaded. The compiled types are written to the QML disk cache next to the
+ *  stable bundle files, loading the same bundle again does not need to parse
+ *  the sources. The disk cache exists since Qt 5.8, older versions load the
+ *  application directly. Returns false if the application is not precompiled.
+ */
+bool QApplicationConfig::precompile(const QUrl &mainFile)
+{
+    releasePrecompiledComponent();
+
+#if QT_VERSION >= QT_VERSION_CHECK(5, 8, 0)
+    QQmlEngine *engine;
+
+    engine = qmlEngine(this);
+    if ((engine == NULL) || mainFile.isEmpty())
+    {
+        return false;
+    }
+
+    m_precompiledComponent = new QQmlComponent(engine, mainFile, QQmlComponent::Asynchronous, this);
+    if (!m_precompiledComponent->isLoading())
+    {
+        return false;
+    }
+
+    connect(m_precompiledComponent, SIGNAL(statusChanged(QQmlComponent::Status)),
+            this, SLOT(precompileStatusChanged(QQmlComponent::Status)));
+
+    return true;
+#else
+    Q_UNUSED(mainFile)
+    return false;
+#endif
+}
+
+void QApplicationConfig::precompileStatusChanged(QQmlComponent::Status status)
+{
+    if ((QObject::sender() != m_precompiledComponent) || (status == QQmlComponent::Loading))
+    {
+        return;
+    }
+
+#ifdef QT_DEBUG
+    if (status == QQmlComponent::Error)
+    {
+        qDebug() << "precompiling failed:" << m_precompiledComponent->errorString();
+    }
+#endif
+
+    m_selectedConfig->setLoaded(true);
+    m_selectedConfig->setLoading(false);
+}
+
+void QApplicationConfig::releasePrecompiledComponent()
+{
+    if (m_precompiledComponent != NULL)
+    {
+        m_precompiledComponent->deleteLater();
+        m_precompiledComponent = NULL;
     }
 }
 
@@ -571,6 +805,31 @@ void QApplicationConfig::cleanupFiles()
         QDir dir(path);
         dir.removeRecursively();
     }
+
+    removeApplicationDirectory();
+}
+
+/** Removes the directory the application was extracted to unless it is a
+ *  cached bundle, the extraction must be cancelled before
+ */
+void QApplicationConfig::removeApplicationDirectory()
+{
+    if (!m_applicationPath.isEmpty() && !m_applicationPathPersistent)
+    {
+        QDir(m_applicationPath).removeRecursively();
+    }
+    m_applicationPath = "";
+    m_applicationPathPersistent = false;
+}
+
+/** Invalidates the running extraction without waiting for the workers,
+ *  files not started yet are dropped and started workers stop before
+ *  writing, their results are ignored
+ */
+void QApplicationConfig::cancelExtraction()
+{
+    m_extractionGeneration.fetchAndAddOrdered(1);
+    m_extractionPool->clear();
 }
 
 void QApplicationConfig::request(pb::ContainerType type)
@@ -589,6 +848,15 @@ void QApplicationConfig::request(pb::ContainerType type)
 
 void QApplicationConfig::selectConfig(QString name)
 {
+    requestApplication(name);
+}
+
+/** Requests the files of an application */
+void QApplicationConfig::requestApplication(const QString &name)
+{
+    releasePrecompiledComponent();
+    cancelExtraction();
+
     m_selectedConfig->setLoaded(false);
     m_selectedConfig->setLoading(true);
     m_selectedConfig->setName(name);
@@ -596,11 +864,166 @@ void QApplicationConfig::selectConfig(QString name)
     pb::Application *app = m_tx.add_app();
 
     app->set_name(name.toStdString());
+
     request(pb::MT_RETRIEVE_APPLICATION);
 }
 
+QString QApplicationConfig::manifestFilePath(const QString &name) const
+{
+    return QDir(m_cachePath).filePath("manifests/" + QString::fromLatin1(QUrl::toPercentEncoding(name)) + ".json");
+}
+
+/** Returns the manifest of the last download of an application: the file
+ *  name > hash map, the bundle and the source hash of the received files
+ */
+QJsonObject QApplicationConfig::loadManifest(const QString &name) const
+{
+    QFile file(manifestFilePath(name));
+
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        return QJsonObject();
+    }
+
+    return QJsonDocument::fromJson(file.readAll()).object();
+}
+
+void QApplicationConfig::saveManifest(const QString &name, const QJsonObject &files, const QString &bundle, const QString &source)
+{
+    QJsonObject manifest;
+    QFileInfo fileInfo(manifestFilePath(name));
+
+    if (!QDir().mkpath(fileInfo.absolutePath()))
+    {
+        return;
+    }
+
+    manifest.insert("files", files);
+    manifest.insert("bundle", bundle);
+    manifest.insert("source", source);
+
+    QSaveFile file(fileInfo.filePath());
+    if (!file.open(QIODevice::WriteOnly))
+    {
+        return;
+    }
+    file.write(QJsonDocument(manifest).toJson());
+    file.commit();
+
+    removeUnusedBundles();
+}
+
+/** Removes bundles that are not referenced by any manifest anymore */
+void QApplicationConfig::removeUnusedBundles()
+{
+    QSet<QString> usedBundles;
+    QDir manifestDir(QDir(m_cachePath).filePath("manifests"));
+    QDir bundleDir(QDir(m_cachePath).filePath("bundles"));
+
+    foreach (const QFileInfo &fileInfo, manifestDir.entryInfoList(QStringList() << "*.json", QDir::Files))
+    {
+        QFile file(fileInfo.filePath());
+
+        if (!file.open(QIODevice::ReadOnly))
+        {
+            return;     // do not remove bundles of a manifest we cannot read
+        }
+
+        QJsonObject manifest = QJsonDocument::fromJson(file.readAll()).object();
+        usedBundles.insert(manifest.value("bundle").toString());
+    }
+
+    foreach (const QFileInfo &fileInfo, bundleDir.entryInfoList(QDir::Dirs | QDir::NoDotAndDotDot | QDir::Hidden))
+    {
+        if (fileInfo.fileName().startsWith(".staging-"))
+        {
+            if (fileInfo.lastModified().secsTo(QDateTime::currentDateTime()) < 3600)   // may still be in use
+            {
+                continue;
+            }
+        }
+        else if (usedBundles.contains(fileInfo.fileName()))
+        {
+            continue;
+        }
+
+        QDir(fileInfo.filePath()).removeRecursively();
+    }
+}
+
+/** Hash identifying a set of files, equal for all applications with the same content */
+QString QApplicationConfig::bundleHash(const QJsonObject &manifest)
+{
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+
+    foreach (const QString &fileName, manifest.keys())  // keys are sorted
+    {
+        hash.addData(fileName.toUtf8());
+        hash.addData("\n", 1);
+        hash.addData(manifest.value(fileName).toString().toLatin1());
+        hash.addData("\n", 1);
+    }
+
+    return QString::fromLatin1(hash.result().toHex());
+}
+
+/** Hash of the files as received, identifies an unchanged application
+ *  before anything is decompressed or written
+ */
+QString QApplicationConfig::sourceHash(const pb::Application &app)
+{
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+
+    for (int i = 0; i < app.file_size(); ++i)
+    {
+        const pb::File &file = app.file(i);
+        QByteArray header = QString("%1\n%2\n%3\n").arg(QString::fromStdString(file.name()))
+                                                    .arg((int)file.encoding())
+                                                    .arg(file.blob().size()).toUtf8();
+
+        hash.addData(header);
+        hash.addData(file.blob().data(), (int)file.blob().size());
+    }
+
+    return QString::fromLatin1(hash.result().toHex());
+}
+
+QString QApplicationConfig::bundlePath(const QString &hash) const
+{
+    return QDir(m_cachePath).filePath("bundles/" + hash) + "/";
+}
+
+/** Moves a completely written staging directory to its bundle directory,
+ *  returns the directory the application has to be loaded from
+ */
+QString QApplicationConfig::promoteBundle(const QString &stagingPath, const QString &bundlePath)
+{
+    QString source = QDir::cleanPath(stagingPath);
+    QString target = QDir::cleanPath(bundlePath);
+
+    if (source == target)
+    {
+        return bundlePath;
+    }
+
+    if (QFileInfo(target).isDir())  // bundle already exists, the staged files are not needed
+    {
+        QDir(source).removeRecursively();
+        return bundlePath;
+    }
+
+    if (QDir().rename(source, target))
+    {
+        return bundlePath;
+    }
+
+    return stagingPath;
+}
+
 void QApplicationConfig::unselectConfig()
 {
+    cancelExtraction();
+    releasePrecompiledComponent();
     cleanupFiles();
 
     m_selectedConfig->setName("");
@@ -609,6 +1032,7 @@ void QApplicationConfig::unselectConfig()
     m_selectedConfig->setMainFile(QUrl(""));
     m_selectedConfig->setLoaded(false);
     m_selectedConfig->setLoading(false);
+    m_selectedConfig->setProgress(0.0);
 }
 
 void QApplicationConfig::setConfigUri(QString arg)
@@ -27,6 +27,11 @@
 #include <QTimer>
 #include <QCoreApplication>
 #include <QDir>
+#include <QJsonObject>
+#include <QThreadPool>
+#include <QAtomicInt>
+#include <QQmlEngine>
+#include <QQmlComponent>
 #include <nzmqt/nzmqt.hpp>
 #include <google/protobuf/text_format.h>
 #include "qapplicationconfigitem.h"
@@ -56,6 +61,8 @@ class QApplicationConfig : public QQuickItem
     Q_PROPERTY(QApplicationConfigItem *selectedConfig READ selectedConfig NOTIFY selectedConfigChanged)
     Q_PROPERTY(QQmlListProperty<QApplicationConfigItem> configs READ configs NOTIFY configsChanged)
     Q_PROPERTY(QApplicationConfigFilter *filter READ filter WRITE setFilter NOTIFY filterChanged)
+    Q_PROPERTY(bool cacheEnabled READ isCacheEnabled WRITE setCacheEnabled NOTIFY cacheEnabledChanged)
+    Q_PROPERTY(QString cachePath READ cachePath WRITE setCachePath NOTIFY cachePathChanged)
     Q_ENUMS(State)
     Q_ENUMS(ConnectionError)
 public:
@@ -83,6 +90,8 @@ public:
     State connectionState() const;
     ConnectionError error() const;
     QString errorString() const;
+    bool isCacheEnabled() const;
+    QString cachePath() const;
     QQmlListProperty<QApplicationConfigItem> configs();
     int appConfigCount() const;
     QApplicationConfigItem *appConfig(int index) const;
@@ -95,6 +104,8 @@ public slots:
     void setReady(bool arg);
     void setSelectedConfig(QApplicationConfigItem * arg);
     void setFilter(QApplicationConfigFilter * arg);
+    void setCacheEnabled(bool arg);
+    void setCachePath(QString arg);
 
 private:
     bool    m_componentCompleted;
@@ -108,6 +119,18 @@ private:
     QApplicationConfigItem *m_selectedConfig;
     QList<QApplicationConfigItem*> m_configs;
     QApplicationConfigFilter *m_filter;
+    bool m_cacheEnabled;
+    QString m_cachePath;
+    QThreadPool *m_extractionPool;  // decompresses and writes the application files
+    QAtomicInt m_extractionGeneration;  // identifies the request the running extractors belong to
+    int m_extractionPending;
+    int m_extractionTotal;
+    bool m_extractionFailed;
+    QJsonObject m_extractedManifest;
+    QString m_extractedSource;          // source hash of the received files, empty without cache
+    QString m_applicationPath;          // directory the selected application is loaded from
+    bool m_applicationPathPersistent;   // directory is a cached bundle and must not be removed
+    QQmlComponent *m_precompiledComponent;
 
     PollingZMQContext *m_context;
     ZMQSocket *m_configSocket;
@@ -121,6 +144,20 @@ private:
     void updateError(ConnectionError error, QString errorString);
     void sendConfigMessage(const QByteArray &data);
     void cleanupFiles();
+    void requestApplication(const QString &name);
+    QString manifestFilePath(const QString &name) const;
+    QJsonObject loadManifest(const QString &name) const;
+    void saveManifest(const QString &name, const QJsonObject &files, const QString &bundle, const QString &source);
+    void finishExtraction();
+    void removeApplicationDirectory();
+    void cancelExtraction();
+    void removeUnusedBundles();
+    static QString bundleHash(const QJsonObject &manifest);
+    static QString sourceHash(const pb::Application &app);
+    QString bundlePath(const QString &hash) const;
+    QString promoteBundle(const QString &stagingPath, const QString &bundlePath);
+    bool precompile(const QUrl &mainFile);
+    void releasePrecompiledComponent();
 
 private slots:
     bool connectSocket();
@@ -128,6 +165,8 @@ private slots:
     void configMessageReceived(QList<QByteArray> messageList);
     void pollError(int errorNum, const QString &errorMsg);
     void request(pb::ContainerType type);
+    void precompileStatusChanged(QQmlComponent::Status status);
+    void fileExtracted(int generation, const QString &fileName, const QString &filePath, const QString &hash, bool success);
 
 signals:
     void configUriChanged(QString arg);
@@ -135,6 +174,8 @@ signals:
     void selectedConfigChanged(QApplicationConfigItem * arg);
     void configsChanged(QQmlListProperty<QApplicationConfigItem> arg);
     void filterChanged(QApplicationConfigFilter * arg);
+    void cacheEnabledChanged(bool arg);
+    void cachePathChanged(QString arg);
     void connectionStateChanged(State arg);
     void errorChanged(ConnectionError arg);
     void errorStringChanged(QString arg);
@@ -76,6 +76,12 @@
     The default value is \c{false}.
 */
 
+/*! \qmlproperty real ApplicationConfigItem::progress
+
+    This property holds the share of application files already written
+    while the configuration is loading, ranging from \c{0.0} to \c{1.0}.
+*/
+
 /*! \qmlproperty list<string> ApplicationConfigItem::files
 
     This property holds a list of the loaded file paths.
@@ -109,6 +115,7 @@ QApplicationConfigItem::QApplicationConfigItem(QObject *parent) :
     m_webUri(""),
     m_loaded(false),
     m_loading(false),
+    m_progress(0.0),
     m_files(QStringList()),
     m_mainFile("")
 {
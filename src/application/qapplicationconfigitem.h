@@ -38,6 +38,7 @@ class QApplicationConfigItem : public QObject
     Q_PROPERTY(QUrl webUri READ webUri WRITE setWebUri NOTIFY webUriChanged)
     Q_PROPERTY(bool loaded READ isLoaded WRITE setLoaded NOTIFY loadedChanged)
     Q_PROPERTY(bool loading READ isLoading WRITE setLoading NOTIFY loadingChanged)
+    Q_PROPERTY(double progress READ progress WRITE setProgress NOTIFY progressChanged)
     Q_PROPERTY(QStringList files READ files WRITE setFiles NOTIFY filesChanged)
     Q_PROPERTY(QUrl mainFile READ mainFile WRITE setMainFile NOTIFY mainFileChanged)
     Q_ENUMS(ApplicationType)
@@ -91,6 +92,11 @@ public:
         return m_loading;
     }
 
+    double progress() const
+    {
+        return m_progress;
+    }
+
 public slots:
 
     void setName(QString arg)
@@ -152,6 +158,15 @@ public slots:
         emit loadingChanged(arg);
     }
 
+    void setProgress(double arg)
+    {
+        if (m_progress == arg)
+            return;
+
+        m_progress = arg;
+        emit progressChanged(arg);
+    }
+
 private:
     QString m_name;
     QString m_description;
@@ -159,6 +174,7 @@ private:
     QUrl m_webUri;
     bool m_loaded;
     bool m_loading;
+    double m_progress;
     QStringList m_files;
     QUrl m_mainFile;
 
@@ -180,6 +196,8 @@ signals:
 
 
     void loadingChanged(bool arg);
+
+    void progressChanged(double arg);
 };
 
 #endif // QAPPCONFIGITEM_H
@@ -32,6 +32,7 @@ QApplicationError::QApplicationError(QObject *parent) :
     m_error(NoError),
     m_errorString(""),
     m_channels(ErrorChannel | TextChannel | DisplayChannel),
+    m_notifications(new QApplicationNotificationModel(this)),
     m_context(NULL),
     m_errorSocket(NULL),
     m_errorHeartbeatTimer(new QTimer(this))
@@ -168,7 +169,7 @@ void QApplicationError::errorMessageReceived(const QList<QByteArray> &messageLis
     {
         for (int i = 0; i < m_rx.note_size(); ++i)
         {
-            messageReceived((ErrorType)m_rx.type(), QString::fromStdString(m_rx.note(i)));
+            m_notifications->addMessage(m_rx.type(), QString::fromStdString(m_rx.note(i)));
         }
 
         refreshErrorHeartbeat();
@@ -29,6 +29,7 @@
 #include <nzmqt/nzmqt.hpp>
 #include <google/protobuf/text_format.h>
 #include "message.pb.h"
+#include "qapplicationnotificationmodel.h"
 
 #if defined(Q_OS_IOS)
 namespace gpb = google_public::protobuf;
@@ -47,6 +48,7 @@ class QApplicationError : public AbstractServiceImplementation
     Q_PROPERTY(ConnectionError error READ error NOTIFY errorChanged)
     Q_PROPERTY(QString errorString READ errorString NOTIFY errorStringChanged)
     Q_PROPERTY(ErrorChannels channels READ channels WRITE setChannels NOTIFY channelsChanged)
+    Q_PROPERTY(QApplicationNotificationModel *notifications READ notifications CONSTANT)
     Q_ENUMS(State ConnectionError ErrorType)
     Q_FLAGS(ErrorChannels)
 
@@ -119,6 +121,11 @@ public:
         return m_connected;
     }
 
+    QApplicationNotificationModel *notifications() const
+    {
+        return m_notifications;
+    }
+
 public slots:
 
     void setErrorUri(QString arg)
@@ -147,6 +154,7 @@ private:
     ConnectionError m_error;
     QString         m_errorString;
     ErrorChannels   m_channels;
+    QApplicationNotificationModel *m_notifications;
 
     PollingZMQContext *m_context;
     ZMQSocket   *m_errorSocket;
@@ -181,7 +189,6 @@ signals:
     void errorChanged(ConnectionError arg);
     void errorStringChanged(QString arg);
     void channelsChanged(ErrorChannels arg);
-    void messageReceived(ErrorType type, const QString &text);
     void connectedChanged(bool arg);
 };
 
@@ -21,6 +21,13 @@
 ****************************************************************************/
 
 #include "qapplicationfile.h"
+#include "applicationfileuploadpreparer.h"
+#include <QStandardPaths>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSaveFile>
+
+static const qint64 maxCompressedUploadSize = 16 * 1024 * 1024;  // file and deflate stream are held in memory
 
 QApplicationFile::QApplicationFile(QObject *parent) :
     AbstractServiceImplementation(parent),
@@ -35,13 +42,54 @@ QApplicationFile::QApplicationFile(QObject *parent) :
     m_progress(0.0),
     m_networkReady(false),
     m_model(NULL),
+    m_idleTimeout(30000),
+    m_resumeUploads(true),
+    m_verifyUploads(true),
+    m_compressUploads(false),
     m_networkManager(NULL),
     m_file(NULL),
-    m_ftp(NULL)
+    m_ftp(NULL),
+    m_ftpConnected(false),
+    m_ftpUri(""),
+    m_idleTimer(new QTimer(this)),
+    m_operationRunning(false),
+    m_uploadPool(new QThreadPool(this)),
+    m_uploadPhase(UploadIdlePhase),
+    m_uploadGeneration(0),
+    m_uploadName(""),
+    m_uploadSize(0),
+    m_uploadOffset(0),
+    m_uploadTransferred(0),
+    m_uploadCompressed(false),
+    m_uploadPrepared(false),
+    m_uploadHash(""),
+    m_rawCommandId(-1),
+    m_rawReplyCode(0),
+    m_rawReplyText(""),
+    m_checksumSupported(true),
+    m_compressionSupported(true),
+    m_listingPath(""),
+    m_removePath("")
 {
     m_localPath = generateTempPath();
+    m_uploadPool->setMaxThreadCount(1);
+
+    QString basePath;
+#ifndef PORTABLE
+    basePath = QStandardPaths::writableLocation(QStandardPaths::CacheLocation);
+#else
+    basePath = QDir::currentPath();
+#endif
+    m_uploadStateFilePath = QDir(basePath).filePath("interruptedUploads.json");
+
+    m_idleTimer->setSingleShot(true);
+    m_idleTimer->setInterval(m_idleTimeout);
+    connect(m_idleTimer, SIGNAL(timeout()),
+            this, SLOT(idleTimeoutReached()));
 
     m_model = new QApplicationFileModel(this);
+    connect(m_model, SIGNAL(listingRequested(QString)),
+            this, SLOT(refreshDirectory(QString)));
 
     m_networkManager = new QNetworkAccessManager(this);
     connect(m_networkManager, SIGNAL(networkAccessibleChanged(QNetworkAccessManager::NetworkAccessibility)),
@@ -55,6 +103,8 @@ QApplicationFile::QApplicationFile(QObject *parent) :
 
 QApplicationFile::~QApplicationFile()
 {
+    interruptUpload();  // a running upload can be resumed after a restart
+    qDeleteAll(m_listingItems);
     cleanupTempPath();
     cleanupFtp();
     cleanupFile();
@@ -64,17 +114,212 @@ QApplicationFile::~QApplicationFile()
 
 void QApplicationFile::startUpload()
 {
-    QUrl url;
-    QFileInfo fileInfo(QUrl(m_localFilePath).toLocalFile());
-    QString remotePath;
+    Operation operation;
+
+    if (!ready())
+    {
+        return;
+    }
+
+    operation.type = UploadOperation;
+    operation.localFilePath = m_localFilePath;
+    operation.remotePath = m_remotePath;
+    enqueueOperation(operation);
+}
+
+void QApplicationFile::startDownload()
+{
+    Operation operation;
+
+    if (!ready())
+    {
+        return;
+    }
+
+    operation.type = DownloadOperation;
+    operation.remoteFilePath = m_remoteFilePath;
+    operation.remotePath = m_remotePath;
+    enqueueOperation(operation);
+}
+
+/** Lists the root and all expanded directories again, the model only applies the differences */
+void QApplicationFile::refreshFiles()
+{
+    refreshDirectory("");
+
+    foreach (const QString &path, m_model->expandedDirectories())
+    {
+        refreshDirectory(path);
+    }
+}
+
+/** Lists the root directory only if it was not listed before */
+void QApplicationFile::updateFiles()
+{
+    if (!m_model->isListed(""))
+    {
+        refreshDirectory("");
+    }
+}
+
+void QApplicationFile::refreshDirectory(const QString &path)
+{
+    Operation operation;
+
+    if (!ready())
+    {
+        return;
+    }
+
+    foreach (const Operation &queuedOperation, m_operations)
+    {
+        // one refresh covers all changes before it
+        if ((queuedOperation.type == RefreshOperation) && (queuedOperation.name == path))
+        {
+            return;
+        }
+    }
+
+    operation.type = RefreshOperation;
+    operation.name = path;
+    enqueueOperation(operation);
+}
+
+void QApplicationFile::removeFile(QString name)
+{
+    Operation operation;
+
+    if (!ready())
+    {
+        return;
+    }
+
+    operation.type = RemoveOperation;
+    operation.name = name;
+    enqueueOperation(operation);
+}
+
+void QApplicationFile::abort()
+{
+    if (!m_ftp)
+    {
+        return;
+    }
+    clearOperations();
+    interruptUpload();
+    updateState(NoTransfer);
+    m_ftp->abort();
+    m_ftp->close();
+    m_ftpConnected = false;
+}
+
+void QApplicationFile::clearError()
+{
+    updateState(NoTransfer);
+    updateError(NoError, "");
+    processOperations();
+}
+
+/** Operations are executed one after another on a single control connection
+ *  that stays open until it was idle for idleTimeout ms
+ */
+void QApplicationFile::enqueueOperation(const Operation &operation)
+{
+    m_operations.append(operation);
+    processOperations();
+}
+
+void QApplicationFile::processOperations()
+{
+    bool started;
+
+    if (m_operationRunning || m_operations.isEmpty() || (m_transferState == Error) || (m_ftp == NULL))
+    {
+        return;
+    }
+
+    m_idleTimer->stop();
+
+    Operation operation = m_operations.takeFirst();
+    started = true;
+    switch (operation.type)
+    {
+    case UploadOperation:
+        started = executeUpload(operation);
+        break;
+    case DownloadOperation:
+        started = executeDownload(operation);
+        break;
+    case RefreshOperation:
+        executeRefresh(operation);
+        break;
+    case RemoveOperation:
+        executeRemove(operation);
+        break;
+    }
 
-    if (!ready() || (m_transferState != NoTransfer))
+    if (started)
+    {
+        m_operationRunning = true;
+    }
+    else
+    {
+        clearOperations();
+    }
+}
+
+void QApplicationFile::finishOperation()
+{
+    m_operationRunning = false;
+    processOperations();
+
+    if (!m_operationRunning && m_ftpConnected)
+    {
+        m_idleTimer->start();
+    }
+}
+
+void QApplicationFile::clearOperations()
+{
+    m_operations.clear();
+    m_operationRunning = false;
+}
+
+/** Opens the control connection if it is not open yet, commands are queued by QFtp */
+void QApplicationFile::connectFtp()
+{
+    QUrl url(m_uri);
+
+    if (m_ftpConnected && (m_ftpUri == m_uri))
     {
         return;
     }
 
-    url.setUrl(m_uri);
-    remotePath = QUrl(m_remotePath).toLocalFile();
+    if (m_ftpConnected)  // service moved, reconnect
+    {
+        m_ftp->close();
+    }
+
+    if (!m_ftpUri.isEmpty() && (m_ftpUri != m_uri))  // cached listings belong to the old service
+    {
+        m_model->clear();
+    }
+
+    m_ftp->connectToHost(url.host(), url.port());
+    m_ftp->login();
+    m_ftpConnected = true;
+    m_checksumSupported = true;     // the server may have been replaced
+    m_compressionSupported = true;
+    m_ftpUri = m_uri;
+}
+
+bool QApplicationFile::executeUpload(const Operation &operation)
+{
+    QFileInfo fileInfo(QUrl(operation.localFilePath).toLocalFile());
+    QString remotePath;
+
+    setLocalFilePath(operation.localFilePath);
+    remotePath = QUrl(operation.remotePath).toLocalFile();
     m_remoteFilePath = QUrl::fromLocalFile(QDir(remotePath).filePath(fileInfo.fileName())).toString();
     emit remoteFilePathChanged(m_remoteFilePath);
 
@@ -82,43 +327,51 @@ void QApplicationFile::startUpload()
 
     if (m_file->open(QIODevice::ReadOnly))
     {
-        m_ftp->connectToHost(url.host(), url.port());
-        m_ftp->login();
-        m_ftp->put(m_file, fileInfo.fileName(), QFtp::Binary);
-        m_ftp->close();
+        connectFtp();
+
+        resetUpload();
+        m_uploadName = fileInfo.fileName();
+        m_uploadSize = m_file->size();
 
         m_progress = 0.0;
         emit progressChanged(m_progress);
         updateState(UploadRunning);
         updateError(NoError, "");
+
+        if (m_compressUploads && m_compressionSupported
+            && (m_uploadSize <= maxCompressedUploadSize))   // compressed in memory, large programs are sent as they are
+        {
+            sendUploadCommand(UploadModePhase, "MODE Z");
+        }
+        else
+        {
+            startUploadPreparation(false);
+            startUploadOffset();
+        }
+        return true;
     }
     else
     {
         updateState(Error);
         updateError(FileError, m_file->errorString());
+        cleanupFile();
+        return false;
     }
 }
 
-void QApplicationFile::startDownload()
+bool QApplicationFile::executeDownload(const Operation &operation)
 {
-    QUrl url;
     QDir dir;
     QString localFilePath;
     QString remoteFilePath;
     QString remotePath;
     QString fileName;
 
-    if (!ready() || (m_transferState != NoTransfer))
-    {
-        return;
-    }
-
-    remoteFilePath = QUrl(m_remoteFilePath).toLocalFile();
-    remotePath = QUrl(m_remotePath).toLocalFile();
+    setRemoteFilePath(operation.remoteFilePath);
+    remoteFilePath = QUrl(operation.remoteFilePath).toLocalFile();
+    remotePath = QUrl(operation.remotePath).toLocalFile();
     fileName = remoteFilePath.mid(remotePath.length() + 1);
 
-    url.setUrl(m_uri);
-
     localFilePath = applicationFilePath(fileName);
     m_localFilePath = QUrl::fromLocalFile(localFilePath).toString();
     emit localFilePathChanged(m_localFilePath);
@@ -129,77 +382,336 @@ void QApplicationFile::startDownload()
     {
         updateState(Error);
         updateError(FileError, tr("Cannot create directory"));
-        return;
+        return false;
     }
 
     m_file = new QFile(localFilePath, this);
 
     if (m_file->open(QIODevice::WriteOnly))
     {
-        m_ftp->connectToHost(url.host(), url.port());
-        m_ftp->login();
+        connectFtp();
         m_ftp->get(fileName, m_file, QFtp::Binary);
-        m_ftp->close();
         m_progress = 0.0;
         emit progressChanged(m_progress);
         updateState(DownloadRunning);
         updateError(NoError, "");
+        return true;
     }
     else
     {
         updateState(Error);
         updateError(FileError, m_file->errorString());
+        cleanupFile();
+        return false;
     }
 }
 
-void QApplicationFile::refreshFiles()
+void QApplicationFile::executeRefresh(const Operation &operation)
 {
-    QUrl url(m_uri);
+    qDeleteAll(m_listingItems);
+    m_listingItems.clear();
+    m_listingPath = operation.name;
 
-    if (!ready() || (m_transferState != NoTransfer))
+    connectFtp();
+    m_ftp->list(m_listingPath);
+    updateState(RefreshRunning);
+}
+
+void QApplicationFile::executeRemove(const Operation &operation)
+{
+    m_removePath = QApplicationFileModel::parentPath(operation.name);
+    connectFtp();
+    m_ftp->remove(operation.name);
+    updateState(RemoveRunning);
+}
+
+/** Uploads run in phases, every phase waits for one raw command or for the
+ *  preparation worker:
+ *  MODE Z (compressed) -> SIZE (resume) -> STOR -> MODE S -> SIZE -> XSHA1 (verify)
+ */
+void QApplicationFile::continueUpload(bool success)
+{
+    bool ok;
+    qint64 remoteSize;
+    QRegExp hashPattern("\\b[0-9a-fA-F]{40}\\b");
+
+    switch (m_uploadPhase)
     {
+    case UploadModePhase:
+        m_uploadCompressed = success && (m_rawReplyCode == 200);
+        if (m_rawReplyCode >= 500)  // not implemented, do not ask again on this connection
+        {
+            m_compressionSupported = false;
+        }
+        startUploadPreparation(m_uploadCompressed);
+        if (m_uploadCompressed)
+        {
+            m_uploadPhase = UploadPreparePhase;
+        }
+        else    // server cannot decompress, fall back to a plain transfer
+        {
+            startUploadOffset();
+        }
+        break;
+    case UploadOffsetPhase:
+        remoteSize = m_rawReplyText.simplified().toLongLong(&ok);
+        if (success && (m_rawReplyCode == 213) && ok && (remoteSize > 0) && (remoteSize < m_uploadSize))
+        {
+            m_uploadOffset = remoteSize;
+        }
+        startUploadTransfer();
+        break;
+    case UploadModeResetPhase:  // stream mode must be supported by every server
+        startUploadVerification();
+        break;
+    case UploadSizePhase:
+        remoteSize = m_rawReplyText.simplified().toLongLong(&ok);
+        if (success && (m_rawReplyCode == 213) && (!ok || (remoteSize != m_uploadSize)))
+        {
+            storeInterruptedUpload("");
+            failUpload(VerificationError, tr("Uploaded file size does not match, %1 of %2 bytes arrived")
+                       .arg(remoteSize).arg(m_uploadSize));
+            break;
+        }
+
+        if (!m_uploadPrepared && m_checksumSupported)
+        {
+            m_uploadPhase = UploadHashPhase;
+        }
+        else
+        {
+            startUploadChecksum();
+        }
+        break;
+    case UploadChecksumPhase:
+        // servers without checksum support only get the size verified
+        if (m_rawReplyCode >= 500)
+        {
+            m_checksumSupported = false;
+        }
+        else if (success && (hashPattern.indexIn(m_rawReplyText) != -1)
+                && (hashPattern.cap(0).toLower() != m_uploadHash))
+        {
+            storeInterruptedUpload("");
+            failUpload(VerificationError, tr("Uploaded file checksum does not match"));
+            break;
+        }
+        finishUpload();
+        break;
+    default:
+        break;
+    }
+}
+
+void QApplicationFile::startUploadPreparation(bool compress)
+{
+    ApplicationFileUploadPreparer *preparer;
+
+    if ((!m_verifyUploads || !m_checksumSupported) && !compress)
+    {
+        m_uploadPrepared = true;
         return;
     }
 
-    m_model->clear();
-    m_ftp->connectToHost(url.host(), url.port());
-    m_ftp->login();
-    m_ftp->list();
-    m_ftp->close();
-    updateState(RefreshRunning);
+    preparer = new ApplicationFileUploadPreparer(this, m_uploadGeneration, m_file->fileName());
+    preparer->setCompress(compress);
+    m_uploadPool->start(preparer);
 }
 
-void QApplicationFile::removeFile(QString name)
+/** An upload of the same local file that was interrupted before continues
+ *  where the server stopped receiving
+ */
+void QApplicationFile::startUploadOffset()
 {
-    QUrl url(m_uri);
+    if (!m_resumeUploads || (interruptedUpload() != uploadSignature()))
+    {
+        startUploadTransfer();
+        return;
+    }
+
+    m_ftp->rawCommand("TYPE I");    // some servers refuse SIZE in ASCII mode
+    sendUploadCommand(UploadOffsetPhase, "SIZE " + m_uploadName);
+}
+
+void QApplicationFile::startUploadTransfer()
+{
+    m_uploadPhase = UploadTransferPhase;
+    m_uploadTransferred = 0;
+
+    if (m_uploadCompressed)
+    {
+        m_ftp->put(m_uploadData, m_uploadName, QFtp::Binary);
+        m_uploadData.clear();
+    }
+    else if (m_uploadOffset > 0)
+    {
+        m_ftp->putAt(m_file, m_uploadName, m_uploadOffset, QFtp::Binary);
+    }
+    else
+    {
+        m_ftp->put(m_file, m_uploadName, QFtp::Binary);
+    }
+}
 
-    if (!ready() || (m_transferState != NoTransfer))
+void QApplicationFile::startUploadVerification()
+{
+    if (!m_verifyUploads)
     {
+        finishUpload();
         return;
     }
 
-    m_ftp->connectToHost(url.host(), url.port());
-    m_ftp->login();
-    m_ftp->remove(name);
-    m_ftp->close();
-    updateState(RemoveRunning);
+    sendUploadCommand(UploadSizePhase, "SIZE " + m_uploadName);
 }
 
-void QApplicationFile::abort()
+/** Servers that rejected XSHA1 before only get the size verified */
+void QApplicationFile::startUploadChecksum()
 {
-    if (!m_ftp)
+    if (!m_checksumSupported || m_uploadHash.isEmpty())
     {
+        finishUpload();
         return;
     }
-    updateState(NoTransfer);
-    m_ftp->abort();
-    m_ftp->close();
+
+    sendUploadCommand(UploadChecksumPhase, "XSHA1 " + m_uploadName);
 }
 
-void QApplicationFile::clearError()
+void QApplicationFile::finishUpload()
 {
+    resetUpload();
+    emit uploadFinished();
     updateState(NoTransfer);
-    updateError(NoError, "");
+    refreshDirectory("");
+    finishOperation();
+}
+
+void QApplicationFile::failUpload(QApplicationFile::TransferError error, const QString &errorString)
+{
+    if (m_uploadCompressed) // do not leave the connection in compressed mode
+    {
+        m_ftp->close();
+        m_ftpConnected = false;
+    }
+
+    resetUpload();
+    cleanupFile();
+    clearOperations();
+    updateState(Error);
+    updateError(error, errorString);
+
+    if (m_ftpConnected)
+    {
+        m_idleTimer->start();
+    }
+}
+
+/** Remembers how far an upload came so the next upload of the same file can resume */
+void QApplicationFile::interruptUpload()
+{
+    if ((m_uploadPhase == UploadTransferPhase) && !m_uploadCompressed)
+    {
+        if (m_resumeUploads && (m_uploadTransferred > 0))  // a rejected resume starts over next time
+        {
+            storeInterruptedUpload(uploadSignature());
+        }
+        else
+        {
+            storeInterruptedUpload("");
+        }
+    }
+
+    resetUpload();
+}
+
+void QApplicationFile::resetUpload()
+{
+    m_uploadPool->clear();
+    m_uploadGeneration++;
+    m_uploadPhase = UploadIdlePhase;
+    m_uploadOffset = 0;
+    m_uploadTransferred = 0;
+    m_uploadCompressed = false;
+    m_uploadPrepared = false;
+    m_uploadHash.clear();
+    m_uploadData.clear();
+    m_rawCommandId = -1;
+}
+
+void QApplicationFile::sendUploadCommand(QApplicationFile::UploadPhase phase, const QString &command)
+{
+    m_uploadPhase = phase;
+    m_rawReplyCode = 0;
+    m_rawReplyText.clear();
+    m_rawCommandId = m_ftp->rawCommand(command);
+}
+
+QString QApplicationFile::uploadSignature() const
+{
+    QFileInfo fileInfo(QUrl(m_localFilePath).toLocalFile());
+
+    return QString("%1:%2:%3").arg(fileInfo.absoluteFilePath())
+            .arg(fileInfo.size())
+            .arg(fileInfo.lastModified().toMSecsSinceEpoch());
+}
+
+/** Identifies the target of an upload across connections and instances */
+QString QApplicationFile::uploadKey() const
+{
+    return m_uri + QUrl(m_remoteFilePath).path();
+}
+
+QString QApplicationFile::interruptedUpload() const
+{
+    QFile file(m_uploadStateFilePath);
+
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        return QString();
+    }
+
+    return QJsonDocument::fromJson(file.readAll()).object().value(uploadKey()).toString();
+}
+
+/** Remembers the local file signature of an interrupted upload, an empty
+ *  signature forgets it. The file is read again before writing, other
+ *  instances may have changed it.
+ */
+void QApplicationFile::storeInterruptedUpload(const QString &signature)
+{
+    QFile file(m_uploadStateFilePath);
+    QJsonObject uploads;
+
+    if (file.open(QIODevice::ReadOnly))
+    {
+        uploads = QJsonDocument::fromJson(file.readAll()).object();
+        file.close();
+    }
+
+    if (uploads.value(uploadKey()).toString() == signature)
+    {
+        return;
+    }
+
+    if (signature.isEmpty())
+    {
+        uploads.remove(uploadKey());
+    }
+    else
+    {
+        uploads.insert(uploadKey(), signature);
+    }
+
+    if (!QDir().mkpath(QFileInfo(m_uploadStateFilePath).absolutePath()))
+    {
+        return;
+    }
+
+    QSaveFile saveFile(m_uploadStateFilePath);
+    if (saveFile.open(QIODevice::WriteOnly))
+    {
+        saveFile.write(QJsonDocument(uploads).toJson(QJsonDocument::Compact));
+        saveFile.commit();
+    }
 }
 
 void QApplicationFile::updateState(QApplicationFile::TransferState state)
@@ -253,6 +765,11 @@ void QApplicationFile::initializeFtp()
     this, SLOT(addToList(QUrlInfo)));
     connect(m_ftp, SIGNAL(dataTransferProgress(qint64,qint64)),
     this, SLOT(transferProgress(qint64,qint64)));
+    connect(m_ftp, SIGNAL(stateChanged(int)),
+    this, SLOT(ftpStateChanged(int)));
+    connect(m_ftp, SIGNAL(rawCommandReply(int,QString)),
+    this, SLOT(ftpRawCommandReply(int,QString)));
+    m_ftpConnected = false;
 
     m_networkReady = true;
     emit readyChanged(m_networkReady);
@@ -265,9 +782,13 @@ void QApplicationFile::cleanupFtp()
         return;
     }
 
+    clearOperations();
+    interruptUpload();
+    m_idleTimer->stop();
     m_ftp->abort();
     m_ftp->deleteLater();
     m_ftp = NULL;
+    m_ftpConnected = false;
 
     m_networkReady = false;
     emit readyChanged(m_networkReady);
@@ -287,7 +808,18 @@ void QApplicationFile::cleanupFile()
 
 void QApplicationFile::transferProgress(qint64 bytesSent, qint64 bytesTotal)
 {
-    m_progress = (double)bytesSent / (double)bytesTotal;
+    if (m_uploadPhase == UploadTransferPhase)
+    {
+        m_uploadTransferred = bytesSent;
+    }
+
+    if (bytesTotal <= 0)    // size unknown
+    {
+        return;
+    }
+
+    // a resumed upload reports the remaining bytes, the total is the whole file
+    m_progress = (double)(m_uploadOffset + bytesSent) / (double)bytesTotal;
     emit progressChanged(m_progress);
 }
 
@@ -307,26 +839,45 @@ void QApplicationFile::addToList(const QUrlInfo &urlInfo)
 {
     QApplicationFileItem *item;
 
-    if (!urlInfo.isDir()) // for now disable folders
+    if ((urlInfo.name() == ".") || (urlInfo.name() == ".."))
     {
-        item = new QApplicationFileItem();
-        item->setName(urlInfo.name());
-        item->setSize(urlInfo.size());
-        item->setOwner(urlInfo.owner());
-        item->setGroup(urlInfo.group());
-        item->setLastModified(urlInfo.lastModified());
-        item->setDir(urlInfo.isDir());
-
-        m_model->addItem(item);
+        return;
     }
+
+    // collected until the listing is complete and merged into the model at once
+    item = new QApplicationFileItem();
+    item->setName(urlInfo.name());
+    item->setSize(urlInfo.size());
+    item->setOwner(urlInfo.owner());
+    item->setGroup(urlInfo.group());
+    item->setLastModified(urlInfo.lastModified());
+    item->setDir(urlInfo.isDir());
+
+    m_listingItems.append(item);
 }
 
-void QApplicationFile::ftpCommandFinished(int, bool error)
+void QApplicationFile::ftpCommandFinished(int id, bool error)
 {
+    if (m_ftp->currentCommand() == QFtp::RawCommand)
+    {
+        // a failing command cancels the commands queued after it
+        if ((m_uploadPhase != UploadIdlePhase) && (error || (id == m_rawCommandId)))
+        {
+            continueUpload(!error);
+        }
+
+        return;
+    }
+
     if (error)
     {
+        interruptUpload();
+        qDeleteAll(m_listingItems);
+        m_listingItems.clear();
         cleanupFile();
+        clearOperations();
         m_ftp->close();
+        m_ftpConnected = false;
 
         if (m_transferState != NoTransfer) // may be a user abort operation
         {
@@ -342,6 +893,7 @@ void QApplicationFile::ftpCommandFinished(int, bool error)
         cleanupFile();
         emit downloadFinished();
         updateState(NoTransfer);
+        finishOperation();
 
         return;
     }
@@ -349,17 +901,27 @@ void QApplicationFile::ftpCommandFinished(int, bool error)
     if (m_ftp->currentCommand() == QFtp::Put)
     {
         cleanupFile();
-        emit uploadFinished();
-        updateState(NoTransfer);
-        refreshFiles();
+        storeInterruptedUpload("");
+
+        if (m_uploadCompressed)
+        {
+            sendUploadCommand(UploadModeResetPhase, "MODE S");
+        }
+        else
+        {
+            startUploadVerification();
+        }
 
         return;
     }
 
     if (m_ftp->currentCommand() == QFtp::List)
     {
+        m_model->updateDirectory(m_listingPath, m_listingItems);
+        m_listingItems.clear();
         emit refreshFinished();
         updateState(NoTransfer);
+        finishOperation();
 
         return;
     }
@@ -368,6 +930,68 @@ void QApplicationFile::ftpCommandFinished(int, bool error)
     {
         emit removeFinished();
         updateState(NoTransfer);
-        refreshFiles();
+        refreshDirectory(m_removePath);
+        finishOperation();
+    }
+}
+
+void QApplicationFile::ftpStateChanged(int state)
+{
+    // the server closed the control connection, reconnect with the next operation
+    if ((state == QFtp::Unconnected) && (m_ftp->currentCommand() != QFtp::Close) && !m_ftp->hasPendingCommands())
+    {
+        m_ftpConnected = false;
+    }
+}
+
+void QApplicationFile::idleTimeoutReached()
+{
+    if (m_operationRunning || !m_ftpConnected)
+    {
+        return;
+    }
+
+    m_ftp->close();
+    m_ftpConnected = false;
+}
+
+void QApplicationFile::ftpRawCommandReply(int replyCode, const QString &detail)
+{
+    m_rawReplyCode = replyCode;
+    m_rawReplyText = detail;
+}
+
+void QApplicationFile::uploadPrepared(int generation, const QString &hash, const QByteArray &data, bool success)
+{
+    if (generation != m_uploadGeneration)   // upload was canceled
+    {
+        return;
+    }
+
+    m_uploadPrepared = true;
+
+    if (!success)
+    {
+        if (m_uploadPhase == UploadPreparePhase)
+        {
+            failUpload(FileError, tr("Cannot compress file"));
+        }
+        else if (m_uploadPhase == UploadHashPhase)  // verify the size only
+        {
+            finishUpload();
+        }
+        return;
+    }
+
+    m_uploadHash = hash;
+    m_uploadData = data;
+
+    if (m_uploadPhase == UploadPreparePhase)
+    {
+        startUploadTransfer();
+    }
+    else if (m_uploadPhase == UploadHashPhase)
+    {
+        startUploadChecksum();
     }
 }
@@ -30,6 +30,9 @@
 #include <QNetworkRequest>
 #include <QFileInfo>
 #include <QDir>
+#include <QTimer>
+#include <QThreadPool>
+#include <QRegExp>
 #include "qftp.h"
 #include "qapplicationfilemodel.h"
 
@@ -47,6 +50,10 @@ class QApplicationFile : public AbstractServiceImplementation
     Q_PROPERTY(double progress READ progress NOTIFY progressChanged)
     Q_PROPERTY(bool networkReady READ networkReady NOTIFY networkReadyChanged)
     Q_PROPERTY(QApplicationFileModel *model READ model NOTIFY modelChanged)
+    Q_PROPERTY(int idleTimeout READ idleTimeout WRITE setIdleTimeout NOTIFY idleTimeoutChanged)
+    Q_PROPERTY(bool resumeUploads READ resumeUploads WRITE setResumeUploads NOTIFY resumeUploadsChanged)
+    Q_PROPERTY(bool verifyUploads READ verifyUploads WRITE setVerifyUploads NOTIFY verifyUploadsChanged)
+    Q_PROPERTY(bool compressUploads READ compressUploads WRITE setCompressUploads NOTIFY compressUploadsChanged)
     Q_ENUMS(TransferState TransferError)
 
 public:
@@ -65,7 +72,8 @@ public:
     enum TransferError {
         NoError = 0,
         FtpError = 1,
-        FileError = 2
+        FileError = 2,
+        VerificationError = 3
     };
 
     QString uri() const
@@ -123,6 +131,26 @@ public:
         return m_model;
     }
 
+    int idleTimeout() const
+    {
+        return m_idleTimeout;
+    }
+
+    bool resumeUploads() const
+    {
+        return m_resumeUploads;
+    }
+
+    bool verifyUploads() const
+    {
+        return m_verifyUploads;
+    }
+
+    bool compressUploads() const
+    {
+        return m_compressUploads;
+    }
+
 public slots:
     void setUri(QString arg)
     {
@@ -169,9 +197,48 @@ public slots:
         emit remotePathChanged(arg);
     }
 
+    void setIdleTimeout(int arg)
+    {
+        if (m_idleTimeout == arg)
+            return;
+
+        m_idleTimeout = arg;
+        m_idleTimer->setInterval(arg);
+        emit idleTimeoutChanged(arg);
+    }
+
+    void setResumeUploads(bool arg)
+    {
+        if (m_resumeUploads == arg)
+            return;
+
+        m_resumeUploads = arg;
+        emit resumeUploadsChanged(arg);
+    }
+
+    void setVerifyUploads(bool arg)
+    {
+        if (m_verifyUploads == arg)
+            return;
+
+        m_verifyUploads = arg;
+        emit verifyUploadsChanged(arg);
+    }
+
+    void setCompressUploads(bool arg)
+    {
+        if (m_compressUploads == arg)
+            return;
+
+        m_compressUploads = arg;
+        emit compressUploadsChanged(arg);
+    }
+
     void startUpload();
     void startDownload();
     void refreshFiles();
+    void updateFiles();
+    void refreshDirectory(const QString &path);
     void removeFile(QString name);
     void abort();
     void clearError();
@@ -188,10 +255,66 @@ private:
     double          m_progress;
     bool            m_networkReady;
     QApplicationFileModel * m_model;
+    int             m_idleTimeout;
+    bool            m_resumeUploads;
+    bool            m_verifyUploads;
+    bool            m_compressUploads;
+
+    enum OperationType {
+        UploadOperation,
+        DownloadOperation,
+        RefreshOperation,
+        RemoveOperation
+    };
+
+    struct Operation {
+        OperationType type;
+        QString localFilePath;
+        QString remoteFilePath;
+        QString remotePath;
+        QString name;
+    };
+
+    enum UploadPhase {
+        UploadIdlePhase,        // no upload running
+        UploadModePhase,        // switching to compressed transfer mode
+        UploadOffsetPhase,      // asking the server how much of an interrupted upload arrived
+        UploadPreparePhase,     // waiting for the compressed data
+        UploadTransferPhase,    // data connection running
+        UploadModeResetPhase,   // switching back to stream mode
+        UploadSizePhase,        // comparing the size of the remote file
+        UploadHashPhase,        // waiting for the local checksum
+        UploadChecksumPhase     // comparing the checksum of the remote file
+    };
 
     QNetworkAccessManager   *m_networkManager;
     QFile                   *m_file;
     QFtp                    *m_ftp;
+    bool                    m_ftpConnected;     // control connection is open or being opened
+    QString                 m_ftpUri;           // uri the control connection belongs to
+    QTimer                  *m_idleTimer;       // closes the control connection when unused
+    QList<Operation>        m_operations;       // operations waiting for the control connection
+    bool                    m_operationRunning;
+    QThreadPool             *m_uploadPool;
+    UploadPhase             m_uploadPhase;
+    int                     m_uploadGeneration; // discards results of canceled uploads
+    QString                 m_uploadName;       // remote file name
+    qint64                  m_uploadSize;       // local file size
+    qint64                  m_uploadOffset;     // bytes already on the server when resuming
+    qint64                  m_uploadTransferred;
+    bool                    m_uploadCompressed; // server accepted MODE Z
+    bool                    m_uploadPrepared;
+    QString                 m_uploadHash;       // hex encoded SHA-1 of the local file
+    QByteArray              m_uploadData;       // compressed file content
+    int                     m_rawCommandId;     // raw command the upload is waiting for
+    int                     m_rawReplyCode;
+    QString                 m_rawReplyText;
+    QString                 m_uploadStateFilePath;  // interrupted uploads, shared by all instances and runs
+    bool                    m_checksumSupported;    // cleared when the server rejects XSHA1, per connection
+    bool                    m_compressionSupported; // cleared when the server rejects MODE Z, per connection
+    QString                 m_listingPath;      // directory of the running listing
+    QList<QApplicationFileItem*> m_listingItems;
+    QString                 m_removePath;       // directory of the removed file
 
     void start() {}
     void stop() {}
@@ -203,12 +326,40 @@ private:
     void initializeFtp();
     void cleanupFtp();
     void cleanupFile();
+    void enqueueOperation(const Operation &operation);
+    void processOperations();
+    void finishOperation();
+    void clearOperations();
+    void connectFtp();
+    bool executeUpload(const Operation &operation);
+    bool executeDownload(const Operation &operation);
+    void executeRefresh(const Operation &operation);
+    void executeRemove(const Operation &operation);
+    void continueUpload(bool success);
+    void startUploadPreparation(bool compress);
+    void startUploadOffset();
+    void startUploadTransfer();
+    void startUploadVerification();
+    void startUploadChecksum();
+    void finishUpload();
+    void failUpload(TransferError error, const QString &errorString);
+    void interruptUpload();
+    void resetUpload();
+    void sendUploadCommand(UploadPhase phase, const QString &command);
+    QString uploadSignature() const;
+    QString uploadKey() const;
+    QString interruptedUpload() const;
+    void storeInterruptedUpload(const QString &signature);
 
 private slots:
     void transferProgress(qint64 bytesSent, qint64 bytesTotal);
     void networkAccessibleChanged(QNetworkAccessManager::NetworkAccessibility accesible);
     void addToList(const QUrlInfo &urlInfo);
     void ftpCommandFinished(int, bool error);
+    void ftpStateChanged(int state);
+    void idleTimeoutReached();
+    void ftpRawCommandReply(int replyCode, const QString &detail);
+    void uploadPrepared(int generation, const QString &hash, const QByteArray &data, bool success);
 
 signals:
     void uriChanged(QString arg);
@@ -226,6 +377,10 @@ signals:
     void removeFinished();
     void networkReadyChanged(bool networkReady);
     void modelChanged(QApplicationFileModel * model);
+    void idleTimeoutChanged(int arg);
+    void resumeUploadsChanged(bool arg);
+    void verifyUploadsChanged(bool arg);
+    void compressUploadsChanged(bool arg);
 };
 
 #endif // QAPPLICATIONFILE_H
@@ -24,6 +24,7 @@
 
 QApplicationFileItem::QApplicationFileItem():
     m_name(""),
+    m_path(""),
     m_size(0),
     m_owner(""),
     m_group(""),
@@ -43,6 +44,16 @@ void QApplicationFileItem::setName(const QString &name)
     m_name = name;
 }
 
+QString QApplicationFileItem::path() const
+{
+    return m_path;
+}
+
+void QApplicationFileItem::setPath(const QString &path)
+{
+    m_path = path;
+}
+
 qint64 QApplicationFileItem::size() const
 {
     return m_size;
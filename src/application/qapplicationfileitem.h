@@ -34,6 +34,9 @@ public:
     QString name() const;
     void setName(const QString &name);
 
+    QString path() const;
+    void setPath(const QString &path);
+
     qint64 size() const;
     void setSize(qint64 size);
 
@@ -51,6 +54,7 @@ public:
 
 private:
     QString m_name;
+    QString m_path;     // relative to the remote root directory
     qint64 m_size;
     QString m_owner;
     QString m_group;
@@ -21,6 +21,7 @@
 ****************************************************************************/
 
 #include "qapplicationfilemodel.h"
+#include <QtAlgorithms>
 
 QApplicationFileModel::QApplicationFileModel(QObject *parent):
     QAbstractListModel(parent)
@@ -30,7 +31,10 @@ QApplicationFileModel::QApplicationFileModel(QObject *parent):
 
 QApplicationFileModel::~QApplicationFileModel()
 {
-    qDeleteAll(m_items);
+    foreach (const QList<QApplicationFileItem*> &listing, m_listings)
+    {
+        qDeleteAll(listing);
+    }
 }
 
 QVariant QApplicationFileModel::data(const QModelIndex &index, int role) const
@@ -73,14 +77,159 @@ QHash<int, QByteArray> QApplicationFileModel::roleNames() const
     roles[GroupRole] = "group";
     roles[LastModifiedRole] = "lastModified";
     roles[DirRole] = "dir";
+    roles[PathRole] = "path";
+    roles[DepthRole] = "depth";
+    roles[ExpandedRole] = "expanded";
+    roles[NodeRole] = "node";
     return roles;
 }
 
+/** Merges a new listing of the directory at path into the cached tree
+ *
+ *  Both listings are sorted, unchanged entries keep their item and their
+ *  expanded children, only added and removed entries insert or remove rows.
+ *  The model takes ownership of the items.
+ */
+void QApplicationFileModel::updateDirectory(const QString &path, QList<QApplicationFileItem *> items)
+{
+    QList<QApplicationFileItem*> oldItems;
+    QList<QApplicationFileItem*> newItems;
+    bool visible;
+    int row;
+    int i;
+    int j;
+
+    if (!path.isEmpty() && !isKnownDirectory(path)) // directory vanished while it was listed
+    {
+        qDeleteAll(items);
+        return;
+    }
+
+    foreach (QApplicationFileItem *item, items)
+    {
+        item->setPath(path.isEmpty() ? item->name() : (path + "/" + item->name()));
+    }
+    qSort(items.begin(), items.end(), lessThan);
+
+    oldItems = m_listings.value(path);
+    visible = path.isEmpty() || (m_expanded.contains(path) && isVisible(path));
+    row = path.isEmpty() ? 0 : (rowOf(path) + 1);
+    i = 0;
+    j = 0;
+
+    while ((i < oldItems.count()) || (j < items.count()))
+    {
+        int result;
+
+        if (i >= oldItems.count())
+        {
+            result = 1;
+        }
+        else if (j >= items.count())
+        {
+            result = -1;
+        }
+        else
+        {
+            result = compare(oldItems.at(i), items.at(j));
+        }
+
+        if (result < 0)         // removed
+        {
+            QApplicationFileItem *item = oldItems.at(i);
+
+            if (visible)
+            {
+                removeRowRange(row, subtreeEnd(row) - 1);
+            }
+            if (item->isDir())
+            {
+                dropListing(item->path());
+            }
+            delete item;
+            i++;
+        }
+        else if (result > 0)    // added
+        {
+            QApplicationFileItem *item = items.at(j);
+
+            if (visible)
+            {
+                beginInsertRows(QModelIndex(), row, row);
+                m_items.insert(row, item);
+                endInsertRows();
+                row++;
+            }
+            newItems.append(item);
+            j++;
+        }
+        else                    // unchanged name, keep the item
+        {
+            QApplicationFileItem *item = oldItems.at(i);
+            QApplicationFileItem *newItem = items.at(j);
+
+            if ((item->size() != newItem->size())
+                || (item->lastModified() != newItem->lastModified())
+                || (item->owner() != newItem->owner())
+                || (item->group() != newItem->group()))
+            {
+                item->setSize(newItem->size());
+                item->setLastModified(newItem->lastModified());
+                item->setOwner(newItem->owner());
+                item->setGroup(newItem->group());
+
+                if (visible)
+                {
+                    emit dataChanged(index(row), index(row));
+                }
+            }
+
+            if (visible)
+            {
+                row = subtreeEnd(row);
+            }
+            delete newItem;
+            newItems.append(item);
+            i++;
+            j++;
+        }
+    }
+
+    m_listings.insert(path, newItems);
+}
+
+/** Expanded directories parents first, used to refresh everything visible */
+QStringList QApplicationFileModel::expandedDirectories() const
+{
+    QStringList directories;
+
+    foreach (const QString &path, m_expanded)
+    {
+        if (m_listings.contains(path))
+        {
+            directories.append(path);
+        }
+    }
+    qSort(directories);     // a parent sorts before its children
+
+    return directories;
+}
+
+QString QApplicationFileModel::parentPath(const QString &path)
+{
+    int index = path.lastIndexOf('/');
+
+    return (index == -1) ? QString("") : path.left(index);
+}
+
 void QApplicationFileModel::addItem(QApplicationFileItem *item)
 {
-    beginUpdate();
+    item->setPath(item->name());
+
+    beginInsertRows(QModelIndex(), m_items.count(), m_items.count());
+    m_listings[""].append(item);
     m_items.append(item);
-    endUpdate();
+    endInsertRows();
 }
 
 QString QApplicationFileModel::getName(int row)
@@ -88,17 +237,98 @@ QString QApplicationFileModel::getName(int row)
     return data(createIndex(row, 0), NameRole).toString();
 }
 
-void QApplicationFileModel::clear()
+QString QApplicationFileModel::getPath(int row)
 {
-    if (m_items.count() == 0)
+    return data(createIndex(row, 0), PathRole).toString();
+}
+
+bool QApplicationFileModel::isDir(int row)
+{
+    return data(createIndex(row, 0), DirRole).toBool();
+}
+
+bool QApplicationFileModel::isExpanded(int row)
+{
+    return data(createIndex(row, 0), ExpandedRole).toBool();
+}
+
+bool QApplicationFileModel::isListed(const QString &path) const
+{
+    return m_listings.contains(path);
+}
+
+/** Shows the children of a directory, the listing is requested if it is not cached */
+void QApplicationFileModel::expand(int row)
+{
+    QApplicationFileItem *item;
+    QList<QApplicationFileItem*> children;
+
+    if ((row < 0) || (row >= m_items.count()))
+    {
+        return;
+    }
+
+    item = m_items.at(row);
+    if (!item->isDir() || m_expanded.contains(item->path()))
+    {
+        return;
+    }
+
+    m_expanded.insert(item->path());
+    emit dataChanged(index(row), index(row));
+
+    if (!m_listings.contains(item->path()))
+    {
+        emit listingRequested(item->path());
+        return;
+    }
+
+    flattenDirectory(item->path(), children);
+    if (children.isEmpty())
+    {
+        return;
+    }
+
+    beginInsertRows(QModelIndex(), row + 1, row + children.count());
+    for (int i = 0; i < children.count(); ++i)
+    {
+        m_items.insert(row + 1 + i, children.at(i));
+    }
+    endInsertRows();
+}
+
+/** Hides the children of a directory, the listing stays cached */
+void QApplicationFileModel::collapse(int row)
+{
+    QApplicationFileItem *item;
+
+    if ((row < 0) || (row >= m_items.count()))
+    {
+        return;
+    }
+
+    item = m_items.at(row);
+    if (!m_expanded.contains(item->path()))
     {
         return;
     }
 
-    beginRemoveRows(QModelIndex(), 0, (m_items.count()-1));
-    qDeleteAll(m_items);
+    removeRowRange(row + 1, subtreeEnd(row) - 1);
+    m_expanded.remove(item->path());
+    emit dataChanged(index(row), index(row));
+}
+
+void QApplicationFileModel::clear()
+{
+    beginResetModel();
+    foreach (const QList<QApplicationFileItem*> &listing, m_listings)
+    {
+        qDeleteAll(listing);
+    }
+    m_listings.clear();
+    m_expanded.clear();
     m_items.clear();
-    endRemoveRows();
+    endResetModel();
 }
 
 void QApplicationFileModel::beginUpdate()
@@ -134,6 +364,21 @@ QVariant QApplicationFileModel::internalData(const QModelIndex &index, int role)
         return QVariant(item->lastModified().toString(Qt::SystemLocaleShortDate));
     case DirRole:
         return QVariant(item->isDir());
+    case PathRole:
+        return QVariant(item->path());
+    case DepthRole:
+        return QVariant(depth(item));
+    case ExpandedRole:
+        return QVariant(m_expanded.contains(item->path()));
+    case NodeRole:  // everything a tree delegate needs in one role
+    {
+        QVariantMap node;
+        node.insert("name", item->name());
+        node.insert("depth", depth(item));
+        node.insert("dir", item->isDir());
+        node.insert("expanded", m_expanded.contains(item->path()));
+        return QVariant(node);
+    }
     default:
         return QVariant();
     }
@@ -165,3 +410,127 @@ QString QApplicationFileModel::formatByteSize(qint64 bytes) const
         return QString::number((double)bytes, 'f', 0) + "B";
     }
 }
+
+int QApplicationFileModel::depth(const QApplicationFileItem *item) const
+{
+    return item->path().count('/');
+}
+
+int QApplicationFileModel::rowOf(const QString &path) const
+{
+    for (int i = 0; i < m_items.count(); ++i)
+    {
+        if (m_items.at(i)->path() == path)
+        {
+            return i;
+        }
+    }
+
+    return -1;
+}
+
+/** Returns the first row after the row and its visible children */
+int QApplicationFileModel::subtreeEnd(int row) const
+{
+    int itemDepth = depth(m_items.at(row));
+    int end = row + 1;
+
+    while ((end < m_items.count()) && (depth(m_items.at(end)) > itemDepth))
+    {
+        end++;
+    }
+
+    return end;
+}
+
+bool QApplicationFileModel::isVisible(const QString &path) const
+{
+    return rowOf(path) != -1;
+}
+
+bool QApplicationFileModel::isKnownDirectory(const QString &path) const
+{
+    foreach (const QApplicationFileItem *item, m_listings.value(parentPath(path)))
+    {
+        if (item->isDir() && (item->path() == path))
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void QApplicationFileModel::flattenDirectory(const QString &path, QList<QApplicationFileItem *> &items) const
+{
+    foreach (QApplicationFileItem *item, m_listings.value(path))
+    {
+        items.append(item);
+        if (item->isDir() && m_expanded.contains(item->path()))
+        {
+            flattenDirectory(item->path(), items);
+        }
+    }
+}
+
+void QApplicationFileModel::dropListing(const QString &path)
+{
+    QMutableSetIterator<QString> it(m_expanded);
+
+    while (it.hasNext())    // includes directories whose listing is still requested
+    {
+        const QString &expandedPath = it.next();
+        if ((expandedPath == path) || expandedPath.startsWith(path + "/"))
+        {
+            it.remove();
+        }
+    }
+
+    foreach (QApplicationFileItem *item, m_listings.take(path))
+    {
+        if (item->isDir())
+        {
+            dropListing(item->path());
+        }
+        delete item;
+    }
+}
+
+void QApplicationFileModel::removeRowRange(int first, int last)
+{
+    if (last < first)
+    {
+        return;
+    }
+
+    beginRemoveRows(QModelIndex(), first, last);
+    for (int i = last; i >= first; --i)
+    {
+        m_items.removeAt(i);
+    }
+    endRemoveRows();
+}
+
+/** Directories first, then case insensitive by name */
+int QApplicationFileModel::compare(const QApplicationFileItem *a, const QApplicationFileItem *b)
+{
+    int result;
+
+    if (a->isDir() != b->isDir())
+    {
+        return a->isDir() ? -1 : 1;
+    }
+
+    result = QString::compare(a->name(), b->name(), Qt::CaseInsensitive);
+    if (result == 0)
+    {
+        result = QString::compare(a->name(), b->name(), Qt::CaseSensitive);
+    }
+
+    return result;
+}
+
+bool QApplicationFileModel::lessThan(const QApplicationFileItem *a, const QApplicationFileItem *b)
+{
+    return compare(a, b) < 0;
+}
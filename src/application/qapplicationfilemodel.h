@@ -24,6 +24,9 @@
 ****************************************************************************/
 
 #include <QAbstractListModel>
+#include <QHash>
+#include <QSet>
+#include <QStringList>
 #include "qapplicationfileitem.h"
 
 class QApplicationFileModel : public QAbstractListModel
@@ -38,7 +41,11 @@ public:
             OwnerRole,
             GroupRole,
             LastModifiedRole,
-            DirRole
+            DirRole,
+            PathRole,
+            DepthRole,
+            ExpandedRole,
+            NodeRole
         };
 
     explicit QApplicationFileModel(QObject *parent = 0);
@@ -50,18 +57,43 @@ public:
     int rowCount(const QModelIndex &parent = QModelIndex()) const;
     QHash<int, QByteArray> roleNames() const;
 
+    void updateDirectory(const QString &path, QList<QApplicationFileItem*> items);
+    QStringList expandedDirectories() const;
+    static QString parentPath(const QString &path);
+
 public slots:
     void addItem(QApplicationFileItem *item);
     QString getName(int row);
+    QString getPath(int row);
+    bool isDir(int row);
+    bool isExpanded(int row);
+    bool isListed(const QString &path) const;
+    void expand(int row);
+    void collapse(int row);
     void clear();
     void beginUpdate();
     void endUpdate();
 
+signals:
+    void listingRequested(const QString &path);
+
 private:
-    QList<QApplicationFileItem*> m_items;
+    QList<QApplicationFileItem*> m_items;   // visible rows, children follow their directory
+    QHash<QString, QList<QApplicationFileItem*> > m_listings;  // cached sorted listing of every loaded directory, owns the items
+    QSet<QString> m_expanded;
 
     QVariant internalData(const QModelIndex &index, int role) const;
     QString formatByteSize(qint64 bytes) const;
+    int depth(const QApplicationFileItem *item) const;
+    int rowOf(const QString &path) const;
+    int subtreeEnd(int row) const;
+    bool isVisible(const QString &path) const;
+    bool isKnownDirectory(const QString &path) const;
+    void flattenDirectory(const QString &path, QList<QApplicationFileItem*> &items) const;
+    void dropListing(const QString &path);
+    void removeRowRange(int first, int last);
+    static bool lessThan(const QApplicationFileItem *a, const QApplicationFileItem *b);
+    static int compare(const QApplicationFileItem *a, const QApplicationFileItem *b);
 };
 
 #endif // QAPPLICATIONFILEMODEL_H
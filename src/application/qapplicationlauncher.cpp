@@ -1,5 +1,6 @@
 #include "qapplicationlauncher.h"
 #include "debughelper.h"
+#include <QQmlEngine>
 
 QApplicationLauncher::QApplicationLauncher(QObject *parent) :
     AbstractServiceImplementation(parent),
@@ -15,6 +16,7 @@ QApplicationLauncher::QApplicationLauncher(QObject *parent) :
     m_errorString(""),
     m_launchers(QJsonValue(QJsonArray())),
     m_synced(false),
+    m_outputCapacity(1000),
     m_context(NULL),
     m_subscribeSocket(NULL),
     m_commandSocket(NULL),
@@ -32,7 +34,29 @@ QApplicationLauncher::QApplicationLauncher(QObject *parent) :
 
 QApplicationLauncher::~QApplicationLauncher()
 {
-    Service::removeTempPath("launcher"); // clean up dir created by json
+    Service::releaseFiles("launcher", this); // clean up files created by json, other launchers may still use them
+}
+
+/** Returns the stdout model of the launcher with the given index */
+QApplicationLauncherOutputModel *QApplicationLauncher::output(int index)
+{
+    QApplicationLauncherOutputModel *output;
+
+    if (index < 0)
+    {
+        return NULL;
+    }
+
+    output = m_outputs.value(index, NULL);
+    if (output == NULL)
+    {
+        output = new QApplicationLauncherOutputModel(this);
+        output->setCapacity(m_outputCapacity);
+        QQmlEngine::setObjectOwnership(output, QQmlEngine::CppOwnership);
+        m_outputs.insert(index, output);
+    }
+
+    return output;
 }
 
 void QApplicationLauncher::start(int index)
@@ -329,8 +353,15 @@ void QApplicationLauncher::subscribeMessageReceived(QList<QByteArray> messageLis
 
     if (m_rx.type() == pb::MT_LAUNCHER_FULL_UPDATE) //value update
     {
+        foreach (QApplicationLauncherOutputModel *output, m_outputs)
+        {
+            output->clear();
+        }
+        takeOutput(&m_rx);
+
         m_launchers = QJsonValue(QJsonArray()); // clear old value
         Service::updateValue(m_rx, &m_launchers, "launcher", "launcher"); // launcher protobuf value, launcher temp path
+        Service::removeUnusedFiles("launcher", this, m_launchers);  // images that are not sent anymore
         emit launchersChanged(m_launchers);
 
         if (m_subscribeSocketState != Service::Up)
@@ -348,8 +379,15 @@ void QApplicationLauncher::subscribeMessageReceived(QList<QByteArray> messageLis
         }
     }
     else if (m_rx.type() == pb::MT_LAUNCHER_INCREMENTAL_UPDATE){
-        Service::updateValue(m_rx, &m_launchers, "launcher", "launcher"); // launcher protobuf value, launcher temp path
-        emit launchersChanged(m_launchers);
+        if (takeOutput(&m_rx))  // most updates only carry new stdout lines
+        {
+            Service::updateValue(m_rx, &m_launchers, "launcher", "launcher"); // launcher protobuf value, launcher temp path
+            if (m_rx.launcher_size() > 0)
+            {
+                Service::removeUnusedFiles("launcher", this, m_launchers);
+            }
+            emit launchersChanged(m_launchers);
+        }
 
         refreshSubscribeHeartbeat();
     }
@@ -479,6 +517,58 @@ void QApplicationLauncher::initializeObject()
 {
     m_launchers = QJsonValue(QJsonArray());
     emit launchersChanged(m_launchers);
+
+    foreach (QApplicationLauncherOutputModel *output, m_outputs)
+    {
+        output->clear();
+    }
+}
+
+/** Moves the stdout lines of the container to the output models
+ *  and removes them from the container, returns true if any launcher
+ *  carries other values that need to be merged into launchers
+ */
+bool QApplicationLauncher::takeOutput(pb::Container *container)
+{
+    bool stateChanged = false;
+
+    for (int i = 0; i < container->launcher_size(); ++i)
+    {
+        pb::Launcher *launcher = container->mutable_launcher(i);
+        std::vector<const gpb::FieldDescriptor*> fields;
+        QStringList lines;
+        int firstIndex = 0;
+
+        for (int j = 0; j < launcher->output_size(); ++j)
+        {
+            const pb::StdoutLine &stdoutLine = launcher->output(j);
+
+            if (!lines.isEmpty() && (stdoutLine.index() != (firstIndex + lines.count())))   // not consecutive
+            {
+                output(launcher->index())->appendLines(firstIndex, lines);
+                lines.clear();
+            }
+            if (lines.isEmpty())
+            {
+                firstIndex = stdoutLine.index();
+            }
+            lines.append(QString::fromStdString(stdoutLine.line()));
+        }
+
+        if (!lines.isEmpty())
+        {
+            output(launcher->index())->appendLines(firstIndex, lines);
+        }
+        launcher->clear_output();
+
+        launcher->GetReflection()->ListFields(*launcher, &fields);
+        if (fields.size() > 1)  // more than the index
+        {
+            stateChanged = true;
+        }
+    }
+
+    return stateChanged;
 }
 
 void QApplicationLauncher::commandHeartbeatTimerTick()
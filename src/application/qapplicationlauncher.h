@@ -26,12 +26,15 @@
 #include <abstractserviceimplementation.h>
 #include <service.h>
 #include <QJsonValue>
+#include <QHash>
+#include <QStringList>
 #include <nzmqt/nzmqt.hpp>
 #include <google/protobuf/text_format.h>
 #include <google/protobuf/message.h>
 #include <google/protobuf/descriptor.h>
 #include "message.pb.h"
 #include "config.pb.h"
+#include "qapplicationlauncheroutputmodel.h"
 
 #if defined(Q_OS_IOS)
 namespace gpb = google_public::protobuf;
@@ -53,6 +56,7 @@ class QApplicationLauncher : public AbstractServiceImplementation
     Q_PROPERTY(QString errorString READ errorString NOTIFY errorStringChanged)
     Q_PROPERTY(QJsonValue launchers READ launchers NOTIFY launchersChanged)
     Q_PROPERTY(bool synced READ isSynced NOTIFY syncedChanged)
+    Q_PROPERTY(int outputCapacity READ outputCapacity WRITE setOutputCapacity NOTIFY outputCapacityChanged)
 
 public:
     explicit QApplicationLauncher(QObject *parent = 0);
@@ -103,6 +107,11 @@ public:
         return m_synced;
     }
 
+    int outputCapacity() const
+    {
+        return m_outputCapacity;
+    }
+
 public slots:
     void setLaunchercmdUri(QString arg)
     {
@@ -131,6 +140,20 @@ public slots:
         emit heartbeatPeriodChanged(arg);
     }
 
+    void setOutputCapacity(int arg)
+    {
+        if (m_outputCapacity == arg)
+            return;
+
+        m_outputCapacity = arg;
+        foreach (QApplicationLauncherOutputModel *output, m_outputs)
+        {
+            output->setCapacity(arg);
+        }
+        emit outputCapacityChanged(arg);
+    }
+
+    QApplicationLauncherOutputModel *output(int index);
     void start(int index);
     void terminate(int index);
     void kill(int index);
@@ -151,6 +174,8 @@ private:
     QString m_errorString;
     QJsonValue m_launchers;
     bool m_synced;
+    int m_outputCapacity;
+    QHash<int, QApplicationLauncherOutputModel*> m_outputs; // stdout per launcher index
 
     PollingZMQContext *m_context;
     ZMQSocket  *m_subscribeSocket;
@@ -177,6 +202,7 @@ private:
     void updateSync();
     void clearSync();
     void initializeObject();
+    bool takeOutput(pb::Container *container);
 
 private slots:
     void subscribeMessageReceived(QList<QByteArray> messageList);
@@ -200,6 +226,7 @@ signals:
     void errorStringChanged(QString arg);
     void launchersChanged(QJsonValue arg);
     void syncedChanged(bool arg);
+    void outputCapacityChanged(int arg);
 };
 
 #endif // QAPPLICATIONLAUNCHER_H
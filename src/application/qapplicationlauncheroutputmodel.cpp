@@ -0,0 +1,194 @@
+/****************************************************************************
+**
+** Copyright (C) 2015 Alexander Rössler
+** License: LGPL version 2.1
+**
+** This file is part of QtQuickVcp.
+**
+** All rights reserved. This program and the accompanying materials
+** are made available under the terms of the GNU Lesser General Public License
+** (LGPL) version 2.1 which accompanies this distribution, and is available at
+** http://www.gnu.org/licenses/lgpl-2.1.html
+**
+** This library is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+** Lesser General Public License for more details.
+**
+** Contributors:
+** Alexander Rössler @ The Cool Tool GmbH <mail DOT aroessler AT gmail DOT com>
+**
+****************************************************************************/
+
+#include "qapplicationlauncheroutputmodel.h"
+
+QApplicationLauncherOutputModel::QApplicationLauncherOutputModel(QObject *parent) :
+    QAbstractListModel(parent),
+    m_capacity(1000),
+    m_count(0),
+    m_start(0),
+    m_nextIndex(0)
+{
+    m_lines.resize(m_capacity);
+    m_lineIndexes.resize(m_capacity);
+}
+
+QVariant QApplicationLauncherOutputModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || (index.row() >= m_count))
+    {
+        return QVariant();
+    }
+
+    switch (role)
+    {
+    case LineRole:
+        return QVariant(m_lines.at(bufferPosition(index.row())));
+    case LineIndexRole:
+        return QVariant(m_lineIndexes.at(bufferPosition(index.row())));
+    default:
+        return QVariant();
+    }
+}
+
+int QApplicationLauncherOutputModel::rowCount(const QModelIndex &parent) const
+{
+    Q_UNUSED(parent)
+    return m_count;
+}
+
+QHash<int, QByteArray> QApplicationLauncherOutputModel::roleNames() const
+{
+    QHash<int, QByteArray> roles;
+    roles[LineRole] = "line";
+    roles[LineIndexRole] = "lineIndex";  // index is reserved by the views
+    return roles;
+}
+
+void QApplicationLauncherOutputModel::appendLine(int index, const QString &line)
+{
+    appendLines(index, QStringList() << line);
+}
+
+/** Appends lines starting with the remote line index firstIndex
+ *
+ *  Lines that are already known are skipped, a line with index 0
+ *  starts a new output (the launcher was restarted).
+ */
+void QApplicationLauncherOutputModel::appendLines(int firstIndex, const QStringList &lines)
+{
+    QStringList newLines;
+    int newIndex;
+    int overflow;
+
+    if (lines.isEmpty())
+    {
+        return;
+    }
+
+    if ((firstIndex == 0) && (m_nextIndex > 0))
+    {
+        clear();
+    }
+
+    newIndex = firstIndex + qMax(0, m_nextIndex - firstIndex);
+    newLines = lines.mid(newIndex - firstIndex);    // skip known lines
+    if (newLines.isEmpty())
+    {
+        return;
+    }
+    m_nextIndex = firstIndex + lines.count();
+
+    if (newLines.count() > m_capacity)
+    {
+        newIndex += newLines.count() - m_capacity;
+        newLines = newLines.mid(newLines.count() - m_capacity);
+    }
+
+    overflow = m_count + newLines.count() - m_capacity;
+    if (overflow > 0)   // drop the oldest lines
+    {
+        beginRemoveRows(QModelIndex(), 0, overflow - 1);
+        for (int i = 0; i < overflow; ++i)
+        {
+            m_lines[bufferPosition(i)].clear();
+        }
+        m_start = (m_start + overflow) % m_capacity;
+        m_count -= overflow;
+        endRemoveRows();
+    }
+
+    beginInsertRows(QModelIndex(), m_count, m_count + newLines.count() - 1);
+    foreach (const QString &line, newLines)
+    {
+        m_lines[bufferPosition(m_count)] = line;
+        m_lineIndexes[bufferPosition(m_count)] = newIndex;
+        newIndex++;
+        m_count++;
+    }
+    endInsertRows();
+
+    emit countChanged(m_count);
+}
+
+void QApplicationLauncherOutputModel::setCapacity(int arg)
+{
+    QVector<QString> lines;
+    QVector<int> lineIndexes;
+    int count;
+
+    if ((m_capacity == arg) || (arg < 1))
+    {
+        return;
+    }
+
+    beginResetModel();
+    count = qMin(m_count, arg);     // keep the newest lines
+    lines.resize(arg);
+    lineIndexes.resize(arg);
+    for (int i = 0; i < count; ++i)
+    {
+        lines[i] = m_lines.at(bufferPosition(m_count - count + i));
+        lineIndexes[i] = m_lineIndexes.at(bufferPosition(m_count - count + i));
+    }
+    m_lines = lines;
+    m_lineIndexes = lineIndexes;
+    m_start = 0;
+    m_count = count;
+    m_capacity = arg;
+    endResetModel();
+
+    emit capacityChanged(arg);
+    emit countChanged(m_count);
+}
+
+/** Returns all lines as one string, lines include their line break */
+QString QApplicationLauncherOutputModel::text() const
+{
+    QString text;
+
+    for (int i = 0; i < m_count; ++i)
+    {
+        text.append(m_lines.at(bufferPosition(i)));
+    }
+
+    return text;
+}
+
+void QApplicationLauncherOutputModel::clear()
+{
+    beginResetModel();
+    m_lines.fill(QString());
+    m_lineIndexes.fill(0);
+    m_start = 0;
+    m_count = 0;
+    m_nextIndex = 0;
+    endResetModel();
+
+    emit countChanged(m_count);
+}
+
+int QApplicationLauncherOutputModel::bufferPosition(int row) const
+{
+    return (m_start + row) % m_capacity;
+}
@@ -0,0 +1,87 @@
+/****************************************************************************
+**
+** Copyright (C) 2015 Alexander Rössler
+** License: LGPL version 2.1
+**
+** This file is part of QtQuickVcp.
+**
+** All rights reserved. This program and the accompanying materials
+** are made available under the terms of the GNU Lesser General Public License
+** (LGPL) version 2.1 which accompanies this distribution, and is available at
+** http://www.gnu.org/licenses/lgpl-2.1.html
+**
+** This library is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+** Lesser General Public License for more details.
+**
+** Contributors:
+** Alexander Rössler @ The Cool Tool GmbH <mail DOT aroessler AT gmail DOT com>
+**
+****************************************************************************/
+
+#ifndef QAPPLICATIONLAUNCHEROUTPUTMODEL_H
+#define QAPPLICATIONLAUNCHEROUTPUTMODEL_H
+
+#include <QAbstractListModel>
+#include <QVector>
+#include <QStringList>
+
+/** Holds the last capacity stdout lines of a launcher
+ *
+ *  Lines are stored in a fixed size ring buffer, new lines are only
+ *  appended and the oldest rows are removed when the buffer is full.
+ */
+class QApplicationLauncherOutputModel : public QAbstractListModel
+{
+    Q_OBJECT
+    Q_PROPERTY(int capacity READ capacity WRITE setCapacity NOTIFY capacityChanged)
+    Q_PROPERTY(int count READ count NOTIFY countChanged)
+    Q_ENUMS(OutputRoles)
+
+public:
+    enum OutputRoles {
+        LineRole = Qt::UserRole,
+        LineIndexRole
+    };
+
+    explicit QApplicationLauncherOutputModel(QObject *parent = 0);
+
+    QVariant data(const QModelIndex &index, int role) const;
+    int rowCount(const QModelIndex &parent = QModelIndex()) const;
+    QHash<int, QByteArray> roleNames() const;
+
+    void appendLine(int index, const QString &line);
+    void appendLines(int firstIndex, const QStringList &lines);
+
+    int capacity() const
+    {
+        return m_capacity;
+    }
+
+    int count() const
+    {
+        return m_count;
+    }
+
+public slots:
+    void setCapacity(int arg);
+    QString text() const;
+    void clear();
+
+signals:
+    void capacityChanged(int arg);
+    void countChanged(int arg);
+
+private:
+    int                 m_capacity;
+    int                 m_count;
+    int                 m_start;        // buffer position of the first row
+    int                 m_nextIndex;    // remote index expected for the next line
+    QVector<QString>    m_lines;
+    QVector<int>        m_lineIndexes;  // remote index of each line, same positions as m_lines
+
+    int bufferPosition(int row) const;
+};
+
+#endif // QAPPLICATIONLAUNCHEROUTPUTMODEL_H
@@ -0,0 +1,240 @@
+/****************************************************************************
+**
+** Copyright (C) 2015 Alexander Rössler
+** License: LGPL version 2.1
+**
+** This file is part of QtQuickVcp.
+**
+** All rights reserved. This program and the accompanying materials
+** are made available under the terms of the GNU Lesser General Public License
+** (LGPL) version 2.1 which accompanies this distribution, and is available at
+** http://www.gnu.org/licenses/lgpl-2.1.html
+**
+** This library is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+** Lesser General Public License for more details.
+**
+** Contributors:
+** Alexander Rössler @ The Cool Tool GmbH <mail DOT aroessler AT gmail DOT com>
+**
+****************************************************************************/
+
+#include "qapplicationnotificationmodel.h"
+
+QApplicationNotificationModel::QApplicationNotificationModel(QObject *parent) :
+    QAbstractListModel(parent),
+    m_capacity(100),
+    m_updateInterval(100),
+    m_messageCount(0),
+    m_updateTimer(new QTimer(this))
+{
+    m_updateTimer->setSingleShot(true);
+    m_updateTimer->setInterval(m_updateInterval);
+    connect(m_updateTimer, SIGNAL(timeout()),
+            this, SLOT(flush()));
+}
+
+QApplicationNotificationModel::~QApplicationNotificationModel()
+{
+    qDeleteAll(m_entries);
+    qDeleteAll(m_pending);
+}
+
+QVariant QApplicationNotificationModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || (index.row() >= m_entries.count()))
+    {
+        return QVariant();
+    }
+
+    const Entry *entry = m_entries.at(index.row());
+
+    switch (role)
+    {
+    case TypeRole:
+        return QVariant(entry->type);
+    case TextRole:
+        return QVariant(entry->text);
+    case RepeatCountRole:
+        return QVariant(entry->repeatCount);
+    case FirstTimeRole:
+        return QVariant(QDateTime::fromMSecsSinceEpoch(entry->firstTime));
+    case LastTimeRole:
+        return QVariant(QDateTime::fromMSecsSinceEpoch(entry->lastTime));
+    default:
+        return QVariant();
+    }
+}
+
+int QApplicationNotificationModel::rowCount(const QModelIndex &parent) const
+{
+    Q_UNUSED(parent)
+    return m_entries.count();
+}
+
+QHash<int, QByteArray> QApplicationNotificationModel::roleNames() const
+{
+    QHash<int, QByteArray> roles;
+    roles[TypeRole] = "type";
+    roles[TextRole] = "text";
+    roles[RepeatCountRole] = "repeatCount";
+    roles[FirstTimeRole] = "firstTime";
+    roles[LastTimeRole] = "lastTime";
+    return roles;
+}
+
+void QApplicationNotificationModel::setCapacity(int arg)
+{
+    if ((m_capacity == arg) || (arg < 1))
+    {
+        return;
+    }
+
+    m_capacity = arg;
+    removeOldest(m_entries.count() - m_capacity);
+    emit capacityChanged(arg);
+}
+
+/** Buffers a message, called for every received message so it only counts */
+void QApplicationNotificationModel::addMessage(int type, const QString &text)
+{
+    QString key = messageKey(type, text);
+    qint64 now = QDateTime::currentMSecsSinceEpoch();
+    Entry *entry;
+
+    m_messageCount++;
+
+    entry = m_pendingByKey.value(key, NULL);
+    if (entry != NULL)
+    {
+        entry->repeatCount++;
+        entry->lastTime = now;
+    }
+    else
+    {
+        entry = new Entry();
+        entry->type = type;
+        entry->text = text;
+        entry->key = key;
+        entry->repeatCount = 1;
+        entry->firstTime = now;
+        entry->lastTime = now;
+        m_pending.append(entry);
+        m_pendingByKey.insert(key, entry);
+
+        if (m_pending.count() > m_capacity)  // would be removed by the next update anyway
+        {
+            Entry *oldest = m_pending.takeFirst();
+            m_pendingByKey.remove(oldest->key);
+            delete oldest;
+        }
+    }
+
+    if (!m_updateTimer->isActive())
+    {
+        m_updateTimer->start();
+    }
+}
+
+void QApplicationNotificationModel::remove(int row)
+{
+    Entry *entry;
+
+    if ((row < 0) || (row >= m_entries.count()))
+    {
+        return;
+    }
+
+    beginRemoveRows(QModelIndex(), row, row);
+    entry = m_entries.takeAt(row);
+    m_entriesByKey.remove(entry->key);
+    delete entry;
+    endRemoveRows();
+
+    emit countChanged(m_entries.count());
+}
+
+void QApplicationNotificationModel::clear()
+{
+    beginResetModel();
+    qDeleteAll(m_entries);
+    m_entries.clear();
+    m_entriesByKey.clear();
+    qDeleteAll(m_pending);
+    m_pending.clear();
+    m_pendingByKey.clear();
+    endResetModel();
+
+    m_updateTimer->stop();
+    emit countChanged(0);
+}
+
+/** Applies the buffered messages, a repeated message moves its row to the end */
+void QApplicationNotificationModel::flush()
+{
+    if (m_pending.isEmpty())
+    {
+        return;
+    }
+
+    foreach (Entry *pendingEntry, m_pending)
+    {
+        Entry *entry = m_entriesByKey.value(pendingEntry->key, NULL);
+
+        if (entry != NULL)
+        {
+            int row = m_entries.indexOf(entry);
+            int lastRow = m_entries.count() - 1;
+
+            entry->repeatCount += pendingEntry->repeatCount;
+            entry->lastTime = pendingEntry->lastTime;
+            delete pendingEntry;
+
+            if (row != lastRow)
+            {
+                beginMoveRows(QModelIndex(), row, row, QModelIndex(), m_entries.count());
+                m_entries.move(row, lastRow);
+                endMoveRows();
+            }
+            emit dataChanged(index(lastRow), index(lastRow));
+        }
+        else
+        {
+            beginInsertRows(QModelIndex(), m_entries.count(), m_entries.count());
+            m_entries.append(pendingEntry);
+            m_entriesByKey.insert(pendingEntry->key, pendingEntry);
+            endInsertRows();
+        }
+    }
+
+    m_pending.clear();
+    m_pendingByKey.clear();
+
+    removeOldest(m_entries.count() - m_capacity);
+
+    emit countChanged(m_entries.count());
+    emit messageCountChanged(m_messageCount);
+}
+
+void QApplicationNotificationModel::removeOldest(int count)
+{
+    if (count <= 0)
+    {
+        return;
+    }
+
+    beginRemoveRows(QModelIndex(), 0, count - 1);
+    for (int i = 0; i < count; ++i)
+    {
+        Entry *entry = m_entries.takeFirst();
+        m_entriesByKey.remove(entry->key);
+        delete entry;
+    }
+    endRemoveRows();
+}
+
+QString QApplicationNotificationModel::messageKey(int type, const QString &text)
+{
+    return QString::number(type) + ":" + text;
+}
@@ -0,0 +1,130 @@
+/****************************************************************************
+**
+** Copyright (C) 2015 Alexander Rössler
+** License: LGPL version 2.1
+**
+** This file is part of QtQuickVcp.
+**
+** All rights reserved. This program and the accompanying materials
+** are made available under the terms of the GNU Lesser General Public License
+** (LGPL) version 2.1 which accompanies this distribution, and is available at
+** http://www.gnu.org/licenses/lgpl-2.1.html
+**
+** This library is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+** Lesser General Public License for more details.
+**
+** Contributors:
+** Alexander Rössler @ The Cool Tool GmbH <mail DOT aroessler AT gmail DOT com>
+**
+****************************************************************************/
+
+#ifndef QAPPLICATIONNOTIFICATIONMODEL_H
+#define QAPPLICATIONNOTIFICATIONMODEL_H
+
+#include <QAbstractListModel>
+#include <QDateTime>
+#include <QHash>
+#include <QTimer>
+
+/** Collects error and operator messages for display
+ *
+ *  Identical messages are merged into one row with a repeat count. New
+ *  messages are buffered and applied to the model at most once per
+ *  updateInterval, so a flood of messages results in a few row updates.
+ *  At most capacity rows are kept, the oldest rows are removed first.
+ */
+class QApplicationNotificationModel : public QAbstractListModel
+{
+    Q_OBJECT
+    Q_PROPERTY(int capacity READ capacity WRITE setCapacity NOTIFY capacityChanged)
+    Q_PROPERTY(int updateInterval READ updateInterval WRITE setUpdateInterval NOTIFY updateIntervalChanged)
+    Q_PROPERTY(int count READ count NOTIFY countChanged)
+    Q_PROPERTY(qint64 messageCount READ messageCount NOTIFY messageCountChanged)
+    Q_ENUMS(NotificationRoles)
+
+public:
+    enum NotificationRoles {
+        TypeRole = Qt::UserRole,
+        TextRole,
+        RepeatCountRole,
+        FirstTimeRole,
+        LastTimeRole
+    };
+
+    explicit QApplicationNotificationModel(QObject *parent = 0);
+    ~QApplicationNotificationModel();
+
+    QVariant data(const QModelIndex &index, int role) const;
+    int rowCount(const QModelIndex &parent = QModelIndex()) const;
+    QHash<int, QByteArray> roleNames() const;
+
+    int capacity() const
+    {
+        return m_capacity;
+    }
+
+    int updateInterval() const
+    {
+        return m_updateInterval;
+    }
+
+    int count() const
+    {
+        return m_entries.count();
+    }
+
+    qint64 messageCount() const
+    {
+        return m_messageCount;
+    }
+
+public slots:
+    void setCapacity(int arg);
+
+    void setUpdateInterval(int arg)
+    {
+        if (m_updateInterval == arg)
+            return;
+
+        m_updateInterval = arg;
+        m_updateTimer->setInterval(arg);
+        emit updateIntervalChanged(arg);
+    }
+
+    void addMessage(int type, const QString &text);
+    void remove(int row);
+    void clear();
+    void flush();
+
+signals:
+    void capacityChanged(int arg);
+    void updateIntervalChanged(int arg);
+    void countChanged(int arg);
+    void messageCountChanged(qint64 arg);
+
+private:
+    struct Entry {
+        int type;
+        QString text;
+        QString key;
+        int repeatCount;
+        qint64 firstTime;   // ms since epoch
+        qint64 lastTime;
+    };
+
+    int                     m_capacity;
+    int                     m_updateInterval;
+    qint64                  m_messageCount;
+    QList<Entry*>           m_entries;          // rows, oldest first
+    QHash<QString, Entry*>  m_entriesByKey;
+    QList<Entry*>           m_pending;          // messages not yet applied to the rows
+    QHash<QString, Entry*>  m_pendingByKey;
+    QTimer                  *m_updateTimer;
+
+    void removeOldest(int count);
+    static QString messageKey(int type, const QString &text);
+};
+
+#endif // QAPPLICATIONNOTIFICATIONMODEL_H
@@ -21,23 +21,47 @@
 ****************************************************************************/
 
 #include "qlocalsettings.h"
+#include "localsettingswriter.h"
+#ifdef QT_DEBUG
+#include <QDebug>
+#endif
 
 QLocalSettings::QLocalSettings(QObject *parent) :
     QObject(parent),
     m_application("machinekit"),
-    m_name("settings")
+    m_name("settings"),
+    m_saveDelay(250),
+    m_saveTimer(new QTimer(this)),
+    m_valuesChangedTimer(new QTimer(this)),
+    m_writerPool(new QThreadPool(this)),
+    m_writing(false),
+    m_savePending(false)
 {
+    m_saveTimer->setSingleShot(true);
+    connect(m_saveTimer, SIGNAL(timeout()),
+            this, SLOT(saveTimerTick()));
+
+    m_valuesChangedTimer->setSingleShot(true);
+    m_valuesChangedTimer->setInterval(0);
+    connect(m_valuesChangedTimer, SIGNAL(timeout()),
+            this, SLOT(emitValuesChanged()));
+
+    m_writerPool->setMaxThreadCount(1);
+
     updateFilePath();
 }
 
 QLocalSettings::~QLocalSettings()
 {
+    flushSettings();
 }
 
 void QLocalSettings::loadSettings()
 {
     QFile file(m_filePath);
 
+    flushSettings();    // the file must contain the saved changes
+
     if (file.exists() && file.open(QIODevice::ReadOnly))
     {
         m_values = QJsonDocument::fromJson(file.readAll()).object();
@@ -48,28 +72,75 @@ void QLocalSettings::loadSettings()
         m_values = QJsonObject();
     }
 
+    m_valuesChangedTimer->stop();
     emit valuesChanged(m_values);
 }
 
+/** Schedules writing the settings
+ *  Requests within the save delay are combined into one write.
+ */
 void QLocalSettings::saveSettings()
 {
-    QDir dir;
-    QFileInfo fileInfo(m_filePath);
+    if (!m_saveTimer->isActive())
+    {
+        m_saveTimer->start(m_saveDelay);
+    }
+}
+
+/** Writes pending changes synchronously */
+void QLocalSettings::flushSettings()
+{
+    bool pending = m_saveTimer->isActive() || m_savePending;
 
-    if (dir.mkpath(fileInfo.path()))
+    m_saveTimer->stop();
+    m_writerPool->waitForDone();
+    m_writing = false;
+    m_savePending = false;
+
+    if (pending)
     {
-        QFile file(m_filePath);
+        LocalSettingsWriter::write(m_filePath, m_values);
+    }
+}
 
+void QLocalSettings::saveTimerTick()
+{
+    if (m_writing)
+    {
+        m_savePending = true;
+        return;
+    }
 
-        if (file.open(QIODevice::WriteOnly))
-        {
-            QJsonDocument jsonDocument(m_values);
-            file.write(jsonDocument.toJson());
-            file.close();
-        }
+    m_writing = true;
+    m_writerPool->start(new LocalSettingsWriter(this, m_filePath, m_values)); // the snapshot is implicitly shared
+}
+
+void QLocalSettings::settingsWritten(const QString &filePath, bool success)
+{
+#ifdef QT_DEBUG
+    if (!success)
+    {
+        qDebug() << "failed to write settings" << filePath;
+    }
+#else
+    Q_UNUSED(filePath)
+    Q_UNUSED(success)
+#endif
+
+    m_writing = false;
+
+    if (m_savePending)
+    {
+        m_savePending = false;
+        saveTimerTick();
     }
 }
 
+void QLocalSettings::emitValuesChanged()
+{
+    emit valuesChanged(m_values);
+}
+
 void QLocalSettings::updateFilePath()
 {
     QString basePath;
@@ -78,6 +149,7 @@ void QLocalSettings::updateFilePath()
 #else
     basePath = QDir::currentPath();
 #endif
+    flushSettings();    // pending changes belong to the previous file
     m_filePath = QDir(basePath).filePath(m_application + "/" + m_name + ".json");
     emit filePathChanged(m_filePath);
 }
@@ -94,40 +166,24 @@ void QLocalSettings::load()
 
 QJsonValue QLocalSettings::value(const QString &key)
 {
-    QStringList heritanceList;
-    QJsonObject *parentObject;
-    QList<QJsonObject> objectList;
+    QStringList keys;
+    QJsonObject object;
 
-    heritanceList = key.split('.');
-    parentObject = &m_values;
+    keys = key.split('.');
+    object = m_values;
 
-    for (int i = 0; i < heritanceList.size(); ++i)
+    for (int i = 0; i < (keys.size() - 1); ++i)
     {
-        QString keyName = heritanceList.at(i);
-        bool isValueKey = (i == (heritanceList.size() - 1));
+        QJsonValue value = object.value(keys.at(i));
 
-        if (isValueKey)
-        {
-            return parentObject->value(keyName);
-        }
-        else
+        if (!value.isObject())
         {
-            QJsonObject object;
-            object = parentObject->value(keyName).toObject();
-
-            if (object.isEmpty())
-            {
-                return QJsonValue();
-            }
-            else
-            {
-                objectList.append(object);
-                parentObject = &objectList.last();
-            }
+            return QJsonValue();
         }
+        object = value.toObject();
     }
 
-    return QJsonValue();
+    return object.value(keys.last());
 }
 
 void QLocalSettings::setFilePath(QString arg)
@@ -135,6 +191,7 @@ void QLocalSettings::setFilePath(QString arg)
     if (m_filePath == arg)
         return;
 
+    flushSettings();
     m_filePath = arg;
     emit filePathChanged(arg);
 }
@@ -146,51 +203,45 @@ void QLocalSettings::setValue(const QString &key, const QJsonValue &value)
 
 void QLocalSettings::setValue(const QString &key, const QJsonValue &value, bool overwrite = true)
 {
-    QStringList heritanceList;
-    QJsonObject *parentObject;
-    QList<QJsonObject> objectList;
-
-    heritanceList = key.split('.');
-    parentObject = &m_values;
-
-    for (int i = 0; i < heritanceList.size(); ++i)
+    if (!updateValue(m_values, key.split('.'), 0, value, overwrite))
     {
-        QString keyName = heritanceList.at(i);
-        QJsonValueRef valueRef = (*parentObject)[keyName];
-        bool isValueKey = (i == (heritanceList.size() - 1));
+        return;
+    }
 
-        if (isValueKey)
-        {
-            if (!overwrite && !valueRef.isNull()) {
-                continue;
-            }
+    emit valueChanged(key, value);
+    m_valuesChangedTimer->start();
+}
 
-            valueRef = value;
-        }
-        else
+/** Sets the value of the key path starting at index in object
+ *  Only the objects on the key path are modified and written back, and
+ *  only if the value changed. Returns true if the value was changed.
+ */
+bool QLocalSettings::updateValue(QJsonObject &object, const QStringList &keys, int index, const QJsonValue &value, bool overwrite)
+{
+    const QString &keyName = keys.at(index);
+    QJsonValue currentValue = object.value(keyName);    // does not detach unchanged objects
+
+    if (index == (keys.size() - 1))
+    {
+        if (object.contains(keyName)
+            && ((!overwrite && !currentValue.isNull()) || (currentValue == value)))
         {
-            if (!valueRef.isObject())
-            {
-                objectList.append(QJsonObject());
-            }
-            else
-            {
-                objectList.append(valueRef.toObject());
-            }
-            parentObject = &objectList.last();
+            return false;
         }
+
+        object.insert(keyName, value);
+        return true;
     }
 
-    if (objectList.size() > 0)
+    QJsonObject childObject = currentValue.toObject();
+
+    if (!updateValue(childObject, keys, index + 1, value, overwrite))
     {
-        for (int i = (objectList.size() - 1); i >= 1; --i)
-        {
-            objectList[i-1][heritanceList.at(i)] = objectList[i];
-        }
-        m_values[heritanceList.first()] = objectList.at(0);
+        return false;
     }
 
-    emit valuesChanged(m_values);
+    object.insert(keyName, childObject);
+    return true;
 }
 
 void QLocalSettings::setValues(QJsonObject arg)
@@ -199,6 +250,7 @@ void QLocalSettings::setValues(QJsonObject arg)
         return;
 
     m_values = arg;
+    m_valuesChangedTimer->stop();
     emit valuesChanged(arg);
 }
 
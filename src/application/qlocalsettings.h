@@ -31,7 +31,18 @@
 #include <QFileInfo>
 #include <QDir>
 #include <QStandardPaths>
+#include <QTimer>
+#include <QThreadPool>
 
+/** JSON settings stored in the user configuration directory
+ *
+ *  setValue updates a single dotted key and notifies the change with
+ *  valueChanged. Notifications of the values property are combined, so
+ *  many changes in a row result in one valuesChanged signal. save writes
+ *  the settings at most once per saveDelay on a worker thread, replacing
+ *  the file atomically. Pending changes are written when the settings
+ *  are destroyed or loaded again.
+ */
 class QLocalSettings : public QObject
 {
     Q_OBJECT
@@ -39,6 +50,7 @@ class QLocalSettings : public QObject
     Q_PROPERTY(QString name READ name WRITE setName NOTIFY nameChanged)
     Q_PROPERTY(QString application READ application WRITE setApplication NOTIFY applicatioChanged)
     Q_PROPERTY(QString filePath READ filePath WRITE setFilePath NOTIFY filePathChanged)
+    Q_PROPERTY(int saveDelay READ saveDelay WRITE setSaveDelay NOTIFY saveDelayChanged)
 
 public:
     explicit QLocalSettings(QObject *parent = 0);
@@ -64,11 +76,18 @@ public:
         return m_filePath;
     }
 
+    int saveDelay() const
+    {
+        return m_saveDelay;
+    }
+
 signals:
     void valuesChanged(QJsonObject arg);
     void applicatioChanged(QString arg);
     void nameChanged(QString arg);
     void filePathChanged(QString arg);
+    void saveDelayChanged(int arg);
+    void valueChanged(const QString &key, const QJsonValue &value);
 
 public slots:
     void setValues(QJsonObject arg);
@@ -76,6 +95,15 @@ public slots:
     void setApplication(QString arg);
     void setName(QString arg);
     void setFilePath(QString arg);
+    void setSaveDelay(int arg)
+    {
+        if (m_saveDelay == arg)
+            return;
+
+        m_saveDelay = arg;
+        emit saveDelayChanged(arg);
+    }
+
     void save();
     void load();
     void setValue(const QString &key, const QJsonValue &value);
@@ -86,9 +114,22 @@ private:
     QString     m_application;
     QString     m_name;
     QString     m_filePath;
+    int         m_saveDelay;
+    QTimer      *m_saveTimer;
+    QTimer      *m_valuesChangedTimer;
+    QThreadPool *m_writerPool;
+    bool        m_writing;
+    bool        m_savePending;  // save requested while writing
 
     void loadSettings();
     void saveSettings();
+    void flushSettings();
     void updateFilePath();
+    bool updateValue(QJsonObject &object, const QStringList &keys, int index, const QJsonValue &value, bool overwrite);
+
+private slots:
+    void saveTimerTick();
+    void emitValuesChanged();
+    void settingsWritten(const QString &filePath, bool success);
 };
 #endif // QLOCALSETTINGS_H
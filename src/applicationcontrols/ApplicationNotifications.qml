@@ -27,17 +27,18 @@ import QtQuick.Window 2.0
 
 ListView {
     property int messageWidth: 100
+    property alias core: object.core
 
     id: root
     implicitWidth: 0
     implicitHeight: 200
     verticalLayoutDirection: ListView.BottomToTop
-    model: notificationModel
+    model: (object.error.notifications !== undefined) ? object.error.notifications : notificationModel
     delegate: notificationDelegate
 
     function addNotification (type, text)
     {
-        notificationModel.append({"type": type, "text": text})
+        root.model.addMessage(type, text)
     }
 
     SystemPalette {
@@ -66,7 +67,7 @@ ListView {
                 horizontalAlignment: Text.AlignHCenter
                 verticalAlignment: Text.AlignVCenter
                 wrapMode: Text.WordWrap
-                text: model.text
+                text: (model.repeatCount > 1) ? model.text + " (" + model.repeatCount + "\u00D7)" : model.text
             }
 
             Image {
@@ -98,15 +99,19 @@ ListView {
             MouseArea {
                 id: notificationMouseArea
                 anchors.fill: parent
-                onClicked: notificationModel.remove(model.index)
+                onClicked: root.model.remove(model.index)
                 hoverEnabled: true
             }
 
-            opacity: (notificationMouseArea.containsMouse || (notificationModel.count === (model.index+1))) ? 1.0 : 0.6
+            opacity: (notificationMouseArea.containsMouse || (root.count === (model.index+1))) ? 1.0 : 0.6
         }
     }
 
-    ListModel {
+    ApplicationObject {
+        id: object
+    }
+
+    ApplicationNotificationModel {     // used without an application core
         id: notificationModel
     }
 }
@@ -18,23 +18,35 @@ Dialog {
         if (row < 0)
             return
 
+        if (tableView.model.isDir(row)) {
+            _toggleDirectory(row)
+            return
+        }
+
         if (status.task.taskMode !== ApplicationStatus.TaskModeAuto)
             command.setTaskMode('execute', ApplicationCommand.TaskModeAuto)
         if (status.task.file !== "") {
             command.resetProgram('execute')
         }
-        var fileName = tableView.model.getName(row)
-        var newPath = file.remotePath + '/' + fileName
+        var filePath = tableView.model.getPath(row)
+        var newPath = file.remotePath + '/' + filePath
         command.openProgram('execute', newPath)
         dialog.close()
     }
 
     function _removeFile(row) {
-        if (row < 0)
+        if ((row < 0) || tableView.model.isDir(row))
             return
 
-        var fileName = tableView.model.getName(row)
-        file.removeFile(fileName)
+        var filePath = tableView.model.getPath(row)
+        file.removeFile(filePath)
+    }
+
+    function _toggleDirectory(row) {
+        if (tableView.model.isExpanded(row))
+            tableView.model.collapse(row)
+        else
+            tableView.model.expand(row)
     }
 
     function _uploadFileDialog() {
@@ -67,9 +79,21 @@ Dialog {
             model: file.model
 
             TableViewColumn {
-                role: "name"
+                role: "node"
                 title: qsTr("Name")
                 width: dialog.width * 0.4
+                delegate: Item {
+                    property var node: (styleData.value !== undefined) ? styleData.value : {"name": "", "depth": 0, "dir": false, "expanded": false}
+
+                    Text {
+                        anchors.fill: parent
+                        anchors.leftMargin: node.depth * Screen.pixelDensity * 4
+                        verticalAlignment: Text.AlignVCenter
+                        elide: styleData.elideMode
+                        color: styleData.textColor
+                        text: (node.dir ? (node.expanded ? "\u25BE " : "\u25B8 ") : "") + node.name
+                    }
+                }
             }
             TableViewColumn {
                 role: "size"
@@ -108,7 +132,7 @@ Dialog {
                 id: fileMenu
                 MenuItem {
                     text: qsTr("Remove file")
-                    enabled: _ready && (tableView.currentRow > -1)
+                    enabled: _ready && (tableView.currentRow > -1) && !tableView.model.isDir(tableView.currentRow)
                     onTriggered: _removeFile(tableView.currentRow)
                 }
                 MenuItem {
@@ -172,7 +196,7 @@ Dialog {
 
     onVisibleChanged: {
         if (visible)
-            file.refreshFiles()
+            file.updateFiles()  // cached listings are kept, Refresh lists again
     }
 
     Component.onCompleted: {
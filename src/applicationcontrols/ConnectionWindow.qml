@@ -490,6 +490,7 @@ Rectangle {
 
         launcher: (launcherPage.selectedLauncher < applicationLauncher.launchers.length) ?
                    applicationLauncher.launchers[launcherPage.selectedLauncher] : undefined
+        output: (launcher !== undefined) ? applicationLauncher.output(launcher.index) : null
         onGoBack: mainWindow.goBack()
     }
 
@@ -549,6 +550,7 @@ Rectangle {
         ready: ((mainWindow.state === "config") || (mainWindow.state === "app-loading"))
                && remoteVisible && configService.ready
         configUri: configService.uri
+        cacheEnabled: true
         onConnectionStateChanged: {
             if (applicationConfig.connectionState === ApplicationConfig.Error)
             {
@@ -576,6 +578,7 @@ Rectangle {
         id: serviceDiscovery
 
         running: true
+        cacheEnabled: true
         filter: ServiceDiscoveryFilter {
             id: serviceDiscoveryFilter
             name: ""
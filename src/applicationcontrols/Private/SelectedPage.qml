@@ -5,8 +5,7 @@ import QtQuick.Window 2.0
 
 Item {
     property var launcher: undefined
-    property string stdoutText: (launcher !== undefined) && (launcher.output !== undefined) ?
-                                    launcher.output.join("") : ""
+    property var output: null
     property string launcherName: (launcher !== undefined) ? launcher.name : ""
     property string titleText: {
         if (isRunning) {
@@ -86,12 +85,21 @@ Item {
             text: visible ? qsTr("Process exited with return code ") + returncode + qsTr(". See the log for details.") : ""
         }
 
-        TextArea {
+        ScrollView {
             Layout.fillHeight: true
             Layout.fillWidth: true
-            text: stdoutText
-            visible: true
-            readOnly: true
+
+            ListView {
+                id: outputView
+                model: root.output
+                delegate: Text {
+                    width: outputView.width
+                    text: line.replace(/\n$/, "")   // lines include their line break
+                    font.family: "monospace"
+                    wrapMode: Text.WrapAnywhere
+                }
+                onCountChanged: positionViewAtEnd()  // follow the output
+            }
         }
     }
 }
@@ -1,5 +1,11 @@
 #include "service.h"
 #include <QDebug>
+#include <QCryptographicHash>
+#include <QSaveFile>
+#include <QRegExp>
+#include <QHash>
+
+static QHash<QString, QHash<const QObject*, QSet<QString> > > referencedFiles; // temp dir > owner > urls in use
 
 Service::Service(QObject *parent) : QObject(parent)
 {
@@ -233,6 +239,9 @@ void Service::updateValue(const google::protobuf::Message &message, QJsonValue *
 
 /** Converts a protobuf File object to a json file descriptor
  *  stores the data to a temporary directory
+ *
+ *  Files are named after the SHA-1 of their encoded content, a blob
+ *  that was stored before is not decoded again and gets the same url.
  **/
 void Service::fileToJson(const pb::File &file, QJsonObject *object, const QString tempDir)
 {
@@ -240,49 +249,136 @@ void Service::fileToJson(const pb::File &file, QJsonObject *object, const QStrin
     QString fileName;
     QString tmpPath;
     QString filePath;
-    QString uuid;
     QByteArray data;
+    QCryptographicHash hash(QCryptographicHash::Sha1);
 
     if (!(file.has_name() && file.has_blob() && file.has_encoding())) {
         return;
     }
 
+    data = QByteArray(file.blob().data(), file.blob().size());
+    hash.addData(QByteArray::number(file.encoding()));
+    hash.addData(data);
+
     fileName = QString::fromStdString(file.name());
     tmpPath = applicationTempPath(tempDir);
-    uuid = QUuid::createUuid().toString();
-    uuid = uuid.replace('{', '_').replace('}', '_');
-    filePath = tmpPath + uuid + fileName;
-    QFile localFile(filePath);
+    filePath = tmpPath + QString::fromLatin1(hash.result().toHex()) + "_" + fileName;
 
-    if (!dir.mkpath(tmpPath))
+    if (QFile::exists(filePath))    // same content already stored
     {
-        qWarning() << "not able to create directory";
+        object->insert("url", QUrl::fromLocalFile(filePath).toString());
         return;
     }
 
-    if (!localFile.open(QIODevice::WriteOnly))
+    if (!dir.mkpath(tmpPath))
     {
-        qWarning() << "not able to create file" << filePath;
+        qWarning() << "not able to create directory";
         return;
     }
 
-    data = QByteArray(file.blob().data(), file.blob().size());
-
     if (file.encoding() == pb::ZLIB)
     {
-        quint32 test = ((quint32)data.at(0) << 24) + ((quint32)data.at(1) << 16) + ((quint32)data.at(2) << 8) + ((quint32)data.at(3) << 0);
-        qWarning() << test << (quint8)data.at(0) << (quint8)data.at(1) << (quint8)data.at(2) << (quint8)data.at(3);   // TODO
         data = qUncompress(data);
     }
     else if (file.encoding() != pb::CLEARTEXT)
     {
         qWarning() << "unknown encoding";
-        localFile.close();
+        return;
+    }
+
+    QSaveFile localFile(filePath);  // a partially written file must not be taken as stored
+
+    if (!localFile.open(QIODevice::WriteOnly))
+    {
+        qWarning() << "not able to create file" << filePath;
         return;
     }
 
     localFile.write(data);
-    localFile.close();
+    if (!localFile.commit())
+    {
+        qWarning() << "not able to write file" << filePath;
+        return;
+    }
 
     object->insert("url", QUrl::fromLocalFile(filePath).toString());
 }
+
+/** Updates the urls owner references in value and removes stored files of
+ *  the temporary directory that no owner references anymore. Files with the
+ *  same content are shared by all instances using the temporary directory.
+ **/
+void Service::removeUnusedFiles(const QString &tempDir, const QObject *owner, const QJsonValue &value)
+{
+    QSet<QString> usedFiles;
+
+    collectFileUrls(value, &usedFiles);
+    referencedFiles[tempDir].insert(owner, usedFiles);
+    removeUnreferencedFiles(tempDir);
+}
+
+/** Drops the references of owner, the temporary directory is removed
+ *  together with the last owner
+ **/
+void Service::releaseFiles(const QString &tempDir, const QObject *owner)
+{
+    referencedFiles[tempDir].remove(owner);
+
+    if (referencedFiles.value(tempDir).isEmpty())
+    {
+        referencedFiles.remove(tempDir);
+        removeTempPath(tempDir);
+    }
+    else
+    {
+        removeUnreferencedFiles(tempDir);
+    }
+}
+
+void Service::removeUnreferencedFiles(const QString &tempDir)
+{
+    QDir dir(applicationTempPath(tempDir));
+    QSet<QString> usedFiles;
+    QRegExp storedFilePattern("^[0-9a-f]{40}_.*");
+
+    foreach (const QSet<QString> &ownerFiles, referencedFiles.value(tempDir))
+    {
+        usedFiles.unite(ownerFiles);
+    }
+
+    foreach (const QFileInfo &fileInfo, dir.entryInfoList(QDir::Files))
+    {
+        if (storedFilePattern.exactMatch(fileInfo.fileName())
+            && !usedFiles.contains(QUrl::fromLocalFile(fileInfo.absoluteFilePath()).toString()))
+        {
+            QFile::remove(fileInfo.absoluteFilePath());
+        }
+    }
+}
+
+void Service::collectFileUrls(const QJsonValue &value, QSet<QString> *urls)
+{
+    if (value.isArray())
+    {
+        foreach (const QJsonValue &item, value.toArray())
+        {
+            collectFileUrls(item, urls);
+        }
+    }
+    else if (value.isObject())
+    {
+        QJsonObject object = value.toObject();
+
+        for (QJsonObject::const_iterator it = object.constBegin(); it != object.constEnd(); ++it)
+        {
+            if ((it.key() == "url") && it.value().isString())
+            {
+                urls->insert(it.value().toString());
+            }
+            else
+            {
+                collectFileUrls(it.value(), urls);
+            }
+        }
+    }
+}
@@ -9,6 +9,8 @@
 #include <QCoreApplication>
 #include <QUuid>
 #include <QUrl>
+#include <QSet>
+#include <QJsonValue>
 #include <google/protobuf/text_format.h>
 #include <google/protobuf/message.h>
 #include <google/protobuf/descriptor.h>
@@ -70,6 +72,16 @@ public:
     static void fileToJson(const pb::File &file,
                            QJsonObject *object,
                            const QString tempDir);
+    static void removeUnusedFiles(const QString &tempDir,
+                                  const QObject *owner,
+                                  const QJsonValue &value);
+    static void releaseFiles(const QString &tempDir,
+                             const QObject *owner);
+
+private:
+    static void removeUnreferencedFiles(const QString &tempDir);
+    static void collectFileUrls(const QJsonValue &value,
+                                QSet<QString> *urls);
 };
 
 #endif // SERVICE_H
@@ -15,6 +15,7 @@ SOURCES += \
     qhalremotecomponent.cpp \
     qhalgroup.cpp \
     qhalsignal.cpp \
+    qhalsharedmemorysocket.cpp
 
 HEADERS += \
     plugin.h \
@@ -22,6 +23,7 @@ HEADERS += \
     qhalremotecomponent.h \
     qhalgroup.h \
     qhalsignal.h \
+    qhalsharedmemorysocket.h \
     debughelper.h
 
 QML_INFRA_FILES = \
@@ -29,11 +29,39 @@
     same as \l{connectionState} == \c{HalGroup.Connected}.
  */
 
+/*! \qmlproperty object HalGroup::values
+
+    This property holds the values of all signals of the group keyed by
+    the signal name. The \c valuesChanged signal is emitted at most once
+    per update message received from the remote host.
+ */
+
+/*! \qmlproperty object HalGroup::changedValues
+
+    This property holds only the signal values that changed with the last
+    update message, keyed by the signal name. Use this property in the
+    \c onValuesChanged handler to react only to the signals that actually
+    changed.
+ */
+
+/*! \qmlproperty bool HalGroup::declaredSignalsOnly
+
+    This property holds whether only the \l{HalSignal}s declared inside the
+    \l containerItem are tracked. When set to \c true, group members without
+    a declared signal are skipped on the full update and their incremental
+    updates are ignored, so no signal objects and \l values entries are
+    created for them. Haltalk has no subscription per signal, the update
+    messages still carry all members of the group and are parsed in full.
+
+    The default value is \c{false}.
+ */
+
 QHalGroup::QHalGroup(QObject *parent) :
     AbstractServiceImplementation(parent),
     m_halgroupUri(""),
     m_name("default"),
     m_connected(false),
+    m_declaredSignalsOnly(false),
     m_halgroupSocketState(Down),
     m_connectionState(Disconnected),
     m_error(NoError),
@@ -198,38 +226,62 @@ void QHalGroup::signalUpdate(const pb::Signal &remoteSignal, QHalSignal *localSi
     {
         localSignal->setType(QHalSignal::Float);
         localSignal->setValue(QVariant(remoteSignal.halfloat()));
-        m_values[localSignal->name()] = remoteSignal.halfloat();
+        updateValue(localSignal->name(), remoteSignal.halfloat());
         updated =  true;
     }
     else if (remoteSignal.type() == pb::HAL_BIT)
     {
         localSignal->setType(QHalSignal::Bit);
         localSignal->setValue(QVariant(remoteSignal.halbit()));
-        m_values[localSignal->name()] = remoteSignal.halbit();
+        updateValue(localSignal->name(), remoteSignal.halbit());
         updated =  true;
     }
     else if (remoteSignal.type() == pb::HAL_S32)
     {
         localSignal->setType(QHalSignal::S32);
         localSignal->setValue(QVariant(remoteSignal.hals32()));
-        m_values[localSignal->name()] = remoteSignal.hals32();
+        updateValue(localSignal->name(), remoteSignal.hals32());
         updated =  true;
     }
     else if (remoteSignal.type() == pb::HAL_U32)
     {
         localSignal->setType(QHalSignal::U32);
         localSignal->setValue(QVariant(remoteSignal.halu32()));
-        m_values[localSignal->name()] = (int)remoteSignal.halu32();
+        updateValue(localSignal->name(), (int)remoteSignal.halu32());
         updated =  true;
     }
 
     if (updated)
     {
         localSignal->setSynced(true);   // when the signal is updated we are synced
-        emit valuesChanged(m_values);
     }
 }
 
+/** Stores a signal value, changes are collected until flushValues is called */
+void QHalGroup::updateValue(const QString &name, const QJsonValue &value)
+{
+    if (m_values.value(name) == value)
+    {
+        return;
+    }
+
+    m_values.insert(name, value);
+    m_pendingValues.insert(name, value);
+}
+
+/** Notifies about all values changed since the last flush at once */
+void QHalGroup::flushValues()
+{
+    if (m_pendingValues.isEmpty())
+    {
+        return;
+    }
+
+    m_changedValues = m_pendingValues;
+    m_pendingValues = QJsonObject();
+    emit valuesChanged(m_values);
+}
+
 void QHalGroup::halgroupMessageReceived(const QList<QByteArray> &messageList)
 {
     QByteArray topic;
@@ -247,7 +299,7 @@ void QHalGroup::halgroupMessageReceived(const QList<QByteArray> &messageList)
     {
         for (int i = 0; i < m_rx.signal_size(); ++i)
         {
-            pb::Signal remoteSignal = m_rx.signal(i);
+            const pb::Signal &remoteSignal = m_rx.signal(i);
             QHalSignal *localSignal = m_signalsByHandle.value(remoteSignal.handle(), NULL);
             if (localSignal != NULL) // in case we received a wrong signal handle
             {
@@ -255,6 +307,7 @@ void QHalGroup::halgroupMessageReceived(const QList<QByteArray> &messageList)
             }
         }
 
+        flushValues();
         refreshHalgroupHeartbeat();
 
         return;
@@ -263,13 +316,13 @@ void QHalGroup::halgroupMessageReceived(const QList<QByteArray> &messageList)
     {
         for (int i = 0; i < m_rx.group_size(); ++i)
         {
-            pb::Group group = m_rx.group(i);
+            const pb::Group &group = m_rx.group(i);
             for (int j = 0; j < group.member_size(); ++j)
             {
-                pb::Member member = group.member(j);
+                const pb::Member &member = group.member(j);
                 if (member.has_signal())
                 {
-                    pb::Signal remoteSignal = member.signal();
+                    const pb::Signal &remoteSignal = member.signal();
                     QString name = QString::fromStdString(remoteSignal.name());
                     int dotIndex = name.indexOf(".");
                     if (dotIndex != -1) // strip comp prefix
@@ -277,6 +330,10 @@ void QHalGroup::halgroupMessageReceived(const QList<QByteArray> &messageList)
                         name = name.mid(dotIndex + 1);
                     }
                     QHalSignal *localSignal = m_signalsByName.value(name, NULL);
+                    if ((localSignal == NULL) && m_declaredSignalsOnly)  // not declared, skip the member
+                    {
+                        continue;
+                    }
                     if (localSignal == NULL)
                     {
                         localSignal = new QHalSignal(this); // create a local signal
@@ -289,12 +346,14 @@ void QHalGroup::halgroupMessageReceived(const QList<QByteArray> &messageList)
                     signalUpdate(remoteSignal, localSignal);
                 }
             }
+        }
 
-            if (m_halgroupSocketState != Up) // will be executed only once
-            {
-                m_halgroupSocketState = Up;
-                updateState(Connected);
-            }
+        flushValues();  // once per message, like incremental updates
+
+        if ((m_rx.group_size() > 0) && (m_halgroupSocketState != Up)) // will be executed only once
+        {
+            m_halgroupSocketState = Up;
+            updateState(Connected);
         }
 
         if (m_rx.has_pparams())
@@ -395,11 +454,9 @@ void QHalGroup::removeSignals()
     qDeleteAll(m_localSignals.begin(), m_localSignals.end());
     m_localSignals.clear();
 
-    QStringList keyList = m_values.keys();
-    for (int i = 0; i < keyList.size(); ++i)
-    {
-        m_values.remove(keyList.at(i));
-    }
+    m_values = QJsonObject();
+    m_changedValues = QJsonObject();
+    m_pendingValues = QJsonObject();
     emit valuesChanged(m_values);
 }
 
@@ -51,6 +51,8 @@ class QHalGroup : public AbstractServiceImplementation
     Q_PROPERTY(QString errorString READ errorString NOTIFY errorStringChanged)
     Q_PROPERTY(QObject *containerItem READ containerItem WRITE setContainerItem NOTIFY containerItemChanged)
     Q_PROPERTY(QJsonObject values READ values NOTIFY valuesChanged)
+    Q_PROPERTY(QJsonObject changedValues READ changedValues NOTIFY valuesChanged)
+    Q_PROPERTY(bool declaredSignalsOnly READ declaredSignalsOnly WRITE setDeclaredSignalsOnly NOTIFY declaredSignalsOnlyChanged)
     Q_ENUMS(State ConnectionError)
 
 public:
@@ -111,11 +113,21 @@ public:
         return m_values;
     }
 
+    QJsonObject changedValues() const
+    {
+        return m_changedValues;
+    }
+
     bool isConnected() const
     {
         return m_connected;
     }
 
+    bool declaredSignalsOnly() const
+    {
+        return m_declaredSignalsOnly;
+    }
+
 public slots:
 
     void setHalgroupUri(QString arg)
@@ -142,16 +154,27 @@ public slots:
         }
     }
 
+    void setDeclaredSignalsOnly(bool arg)
+    {
+        if (m_declaredSignalsOnly != arg) {
+            m_declaredSignalsOnly = arg;
+            emit declaredSignalsOnlyChanged(arg);
+        }
+    }
+
 private:
     QString     m_halgroupUri;
     QString     m_name;
     bool        m_connected;
+    bool        m_declaredSignalsOnly;
     SocketState m_halgroupSocketState;
     State       m_connectionState;
     ConnectionError m_error;
     QString     m_errorString;
     QObject     *m_containerItem;
     QJsonObject m_values;
+    QJsonObject m_changedValues;
+    QJsonObject m_pendingValues;
 
     PollingZMQContext *m_context;
     ZMQSocket   *m_halgroupSocket;
@@ -173,6 +196,8 @@ private:
     void updateState(State state);
     void updateState(State state, ConnectionError error, const QString &errorString);
     void updateError(ConnectionError error, const QString &errorString);
+    void updateValue(const QString &name, const QJsonValue &value);
+    void flushValues();
 
 private slots:
     void signalUpdate(const pb::Signal &remoteSignal, QHalSignal *localSignal);
@@ -198,6 +223,7 @@ signals:
     void containerItemChanged(QObject * arg);
     void valuesChanged(QJsonObject arg);
     void connectedChanged(bool arg);
+    void declaredSignalsOnlyChanged(bool arg);
 };
 
 #endif // QHALGROUP_H
@@ -122,6 +122,29 @@
     to \c true when the echo from the \l HalRemoteComponent is received.
 */
 
+/*! \qmlproperty real HalPin::deadband
+
+    This property holds the minimum difference a value must have to the last
+    transmitted value before it is sent to the remote component. Changes
+    received from the remote component that are smaller than the deadband are
+    not forwarded to \l value immediately. Suppressed values are flushed once
+    the value has settled, so the last value is always transmitted. The
+    deadband is ignored for \c Bit pins.
+
+    The default value is \c{0.0}.
+*/
+
+/*! \qmlproperty int HalPin::minimumInterval
+
+    This property holds the minimum time in ms between two value updates
+    sent to or received from the remote component. Values changing faster
+    are coalesced and the last value is sent when the interval has elapsed.
+
+    The default value is \c{0}.
+*/
+
+static const int settleTime = 100;  // time in ms after which deadband filtered values are flushed
+
 QHalPin::QHalPin(QObject *parent) :
     QObject(parent),
     m_name("default"),
@@ -131,8 +154,19 @@ QHalPin::QHalPin(QObject *parent) :
     m_syncValue(false),
     m_handle(0),
     m_enabled(true),
-    m_synced(false)
+    m_synced(false),
+    m_deadband(0.0),
+    m_minimumInterval(0),
+    m_sendTimer(new QTimer(this)),
+    m_receiveTimer(new QTimer(this))
 {
+    m_sendTimer->setSingleShot(true);
+    m_receiveTimer->setSingleShot(true);
+
+    connect(m_sendTimer, SIGNAL(timeout()),
+            this, SLOT(sendTimerTimeout()));
+    connect(m_receiveTimer, SIGNAL(timeout()),
+            this, SLOT(receiveTimerTimeout()));
 }
 
 void QHalPin::setType(QHalPin::ValueType arg)
@@ -177,8 +211,34 @@ void QHalPin::setDirection(QHalPin::HalPinDirection arg)
 
 void QHalPin::setValue(QVariant arg, bool synced)
 {
+    bool changed = false;
+    bool remote = synced;   // synced may be forced below, forwarding depends on the origin only
+
+    if (remote) {   // value from the remote component
+        m_sentValue = arg;  // the remote side has this value now
+
+        if (m_sendTimer->isActive()) {  // a newer local value is waiting to be sent
+            m_syncValue = arg;
+            return;
+        }
+
+        bool deadbandFiltered = withinDeadband(arg, m_value);
+        if (deadbandFiltered || withinMinimumInterval(m_receivedTimer)) {
+            m_syncValue = arg;
+            m_pendingRemoteValue = arg;
+            scheduleFlush(deadbandFiltered, m_receivedTimer, m_receiveTimer);
+            setSynced(true);
+            return;
+        }
+
+        m_pendingRemoteValue = QVariant();
+        m_receiveTimer->stop();
+        m_receivedTimer.start();
+    }
+
     if ((m_value != arg) || (m_value.type() != arg.type())) {
         m_value = arg;
+        changed = true;
         emit valueChanged(arg);
     }
 
@@ -192,6 +252,19 @@ void QHalPin::setValue(QVariant arg, bool synced)
         m_synced = synced;
         emit syncedChanged(synced);
     }
+
+    if (!remote && changed) {  // local change, forward to the remote component
+        m_pendingRemoteValue = QVariant();
+        m_receiveTimer->stop();
+
+        bool deadbandFiltered = withinDeadband(m_value, m_sentValue);
+        if (deadbandFiltered || withinMinimumInterval(m_sentTimer)) {
+            scheduleFlush(deadbandFiltered, m_sentTimer, m_sendTimer);
+        }
+        else {
+            sendValue();
+        }
+    }
 }
 
 void QHalPin::setHandle(int arg)
@@ -217,3 +290,78 @@ void QHalPin::setSynced(bool arg)
         emit syncedChanged(arg);
     }
 }
+
+void QHalPin::setDeadband(double arg)
+{
+    if (m_deadband != arg) {
+        m_deadband = arg;
+        emit deadbandChanged(arg);
+    }
+}
+
+void QHalPin::setMinimumInterval(int arg)
+{
+    if (m_minimumInterval != arg) {
+        m_minimumInterval = arg;
+        emit minimumIntervalChanged(arg);
+    }
+}
+
+bool QHalPin::withinDeadband(const QVariant &value, const QVariant &reference) const
+{
+    if ((m_deadband <= 0.0) || (m_type == Bit) || !reference.isValid()) {
+        return false;
+    }
+
+    return qAbs(value.toDouble() - reference.toDouble()) < m_deadband;
+}
+
+bool QHalPin::withinMinimumInterval(const QElapsedTimer &elapsedTimer) const
+{
+    return (m_minimumInterval > 0) && elapsedTimer.isValid() && (elapsedTimer.elapsed() < m_minimumInterval);
+}
+
+/** Interval filtered values are flushed when the interval elapses,
+ *  deadband filtered values once the value did not change for the settle time
+ */
+void QHalPin::scheduleFlush(bool deadbandFiltered, const QElapsedTimer &elapsedTimer, QTimer *timer)
+{
+    if (deadbandFiltered) {
+        timer->start(qMax(m_minimumInterval, settleTime));
+    }
+    else if (!timer->isActive()) {
+        timer->start(qMax(1, m_minimumInterval - (int)elapsedTimer.elapsed()));
+    }
+}
+
+void QHalPin::sendValue()
+{
+    m_sendTimer->stop();
+    m_sentValue = m_value;
+    m_sentTimer.start();
+    emit outgoingValueChanged(m_value);
+}
+
+void QHalPin::sendTimerTimeout()
+{
+    if (m_value != m_sentValue) {
+        sendValue();
+    }
+}
+
+void QHalPin::receiveTimerTimeout()
+{
+    QVariant value = m_pendingRemoteValue;
+
+    if (!value.isValid()) {
+        return;
+    }
+
+    m_pendingRemoteValue = QVariant();
+    m_receivedTimer.start();
+
+    if ((m_value != value) || (m_value.type() != value.type())) {
+        m_value = value;
+        emit valueChanged(value);
+    }
+}
@@ -24,6 +24,8 @@
 
 #include <QObject>
 #include <QVariant>
+#include <QTimer>
+#include <QElapsedTimer>
 #include "message.pb.h"
 
 class QHalPin : public QObject
@@ -36,6 +38,8 @@ class QHalPin : public QObject
     Q_PROPERTY(int handle READ handle NOTIFY handleChanged)
     Q_PROPERTY(bool enabled READ enabled WRITE setEnabled NOTIFY enabledChanged)
     Q_PROPERTY(bool synced READ synced NOTIFY syncedChanged)
+    Q_PROPERTY(double deadband READ deadband WRITE setDeadband NOTIFY deadbandChanged)
+    Q_PROPERTY(int minimumInterval READ minimumInterval WRITE setMinimumInterval NOTIFY minimumIntervalChanged)
     Q_ENUMS(ValueType)
     Q_ENUMS(HalPinDirection)
 
@@ -90,6 +94,16 @@ public:
         return m_synced;
     }
 
+    double deadband() const
+    {
+        return m_deadband;
+    }
+
+    int minimumInterval() const
+    {
+        return m_minimumInterval;
+    }
+
 signals:
 
     void nameChanged(QString arg);
@@ -99,6 +113,9 @@ signals:
     void handleChanged(int arg);
     void enabledChanged(bool arg);
     void syncedChanged(bool arg);
+    void deadbandChanged(double arg);
+    void minimumIntervalChanged(int arg);
+    void outgoingValueChanged(QVariant arg);
 
 public slots:
 
@@ -109,6 +126,8 @@ void setValue(QVariant arg, bool synced = false);
 void setHandle(int arg);
 void setEnabled(bool arg);
 void setSynced(bool arg);
+void setDeadband(double arg);
+void setMinimumInterval(int arg);
 
 private:
     QString         m_name;
@@ -119,6 +138,23 @@ private:
     int             m_handle;
     bool            m_enabled;
     bool            m_synced;
+    double          m_deadband;
+    int             m_minimumInterval;
+    QVariant        m_sentValue;
+    QVariant        m_pendingRemoteValue;
+    QElapsedTimer   m_sentTimer;
+    QElapsedTimer   m_receivedTimer;
+    QTimer          *m_sendTimer;
+    QTimer          *m_receiveTimer;
+
+    bool withinDeadband(const QVariant &value, const QVariant &reference) const;
+    bool withinMinimumInterval(const QElapsedTimer &elapsedTimer) const;
+    void scheduleFlush(bool deadbandFiltered, const QElapsedTimer &elapsedTimer, QTimer *timer);
+    void sendValue();
+
+private slots:
+    void sendTimerTimeout();
+    void receiveTimerTimeout();
 };
 
 
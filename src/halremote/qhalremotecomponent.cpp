@@ -43,6 +43,15 @@
     and its children for \l{HalPin}s when \l ready is set
     to \c true.
 
+    If both \l halrcmdUri and \l halrcompUri use the \c shm:// scheme, e.g.
+    \c{shm://halrcmd}, the component exchanges its messages through a
+    lock-free shared memory ring buffer instead of TCP. The bind, full
+    update and incremental update semantics stay the same. The segment has
+    to be created by a server on the same host. Haltalk does not offer this
+    transport, it is meant for local servers implementing the layout
+    documented in QHalSharedMemorySocket. Local \c ipc:// endpoints are
+    handled by 0MQ directly.
+
     The following example creates a HAL remote component
     \c myComponent with one pin \c myPin. The resulting
     name for the pin inside HAL is \c myComponent.myPin.
@@ -181,6 +190,8 @@ QHalRemoteComponent::QHalRemoteComponent(QObject *parent) :
     m_context(NULL),
     m_halrcompSocket(NULL),
     m_halrcmdSocket(NULL),
+    m_halrcompShmSocket(NULL),
+    m_halrcmdShmSocket(NULL),
     m_halrcmdHeartbeatTimer(new QTimer(this)),
     m_halrcompHeartbeatTimer(new QTimer(this)),
     m_halrcmdPingOutstanding(false)
@@ -212,7 +223,7 @@ void QHalRemoteComponent::addPins()
             continue;
         }
         m_pinsByName[pin->name()] = pin;
-        connect(pin, SIGNAL(valueChanged(QVariant)),
+        connect(pin, SIGNAL(outgoingValueChanged(QVariant)),
                 this, SLOT(pinChange(QVariant)));
 #ifdef QT_DEBUG
         DEBUG_TAG(1, m_name, "pin added: " << pin->name())
@@ -225,7 +236,7 @@ void QHalRemoteComponent::removePins()
 {
     foreach (QHalPin *pin, m_pinsByName)
     {
-        disconnect(pin, SIGNAL(valueChanged(QVariant)),
+        disconnect(pin, SIGNAL(outgoingValueChanged(QVariant)),
                 this, SLOT(pinChange(QVariant)));
     }
 
@@ -246,6 +257,12 @@ void QHalRemoteComponent::unsyncPins()
 /** Connects the 0MQ sockets */
 bool QHalRemoteComponent::connectSockets()
 {
+    if (QHalSharedMemorySocket::isSharedMemoryUri(m_halrcmdUri)
+        && QHalSharedMemorySocket::isSharedMemoryUri(m_halrcompUri))
+    {
+        return connectSharedMemorySockets();
+    }
+
     m_context = new PollingZMQContext(this, 1);
     connect(m_context, SIGNAL(pollError(int,QString)),
             this, SLOT(pollError(int,QString)));
@@ -282,12 +299,60 @@ bool QHalRemoteComponent::connectSockets()
     return true;
 }
 
+/** Connects the shared memory sockets of a local server */
+bool QHalRemoteComponent::connectSharedMemorySockets()
+{
+    m_halrcmdShmSocket = new QHalSharedMemorySocket(this);
+    m_halrcompShmSocket = new QHalSharedMemorySocket(this);
+
+    if (!m_halrcmdShmSocket->connectTo(m_halrcmdUri))
+    {
+        updateState(Error, SocketError, m_halrcmdShmSocket->errorString());
+        return false;
+    }
+
+    if (!m_halrcompShmSocket->connectTo(m_halrcompUri))
+    {
+        updateState(Error, SocketError, m_halrcompShmSocket->errorString());
+        return false;
+    }
+
+    connect(m_halrcompShmSocket, SIGNAL(messageReceived(QList<QByteArray>)),
+            this, SLOT(halrcompMessageReceived(QList<QByteArray>)));
+    connect(m_halrcmdShmSocket, SIGNAL(messageReceived(QList<QByteArray>)),
+            this, SLOT(halrcmdMessageReceived(QList<QByteArray>)));
+    connect(m_halrcompShmSocket, SIGNAL(socketError(QString)),
+            this, SLOT(sharedMemoryError(QString)));
+    connect(m_halrcmdShmSocket, SIGNAL(socketError(QString)),
+            this, SLOT(sharedMemoryError(QString)));
+
+#ifdef QT_DEBUG
+    DEBUG_TAG(1, m_name, "shared memory connected" << m_halrcompUri << m_halrcmdUri)
+#endif
+
+    return true;
+}
+
 /** Disconnects the 0MQ sockets */
 void QHalRemoteComponent::disconnectSockets()
 {
     m_halrcmdSocketState = Down;
     m_halrcompSocketState = Down;
 
+    if (m_halrcmdShmSocket != NULL)
+    {
+        m_halrcmdShmSocket->close();
+        m_halrcmdShmSocket->deleteLater();
+        m_halrcmdShmSocket = NULL;
+    }
+
+    if (m_halrcompShmSocket != NULL)
+    {
+        m_halrcompShmSocket->close();
+        m_halrcompShmSocket->deleteLater();
+        m_halrcompShmSocket = NULL;
+    }
+
     if (m_halrcmdSocket != NULL)
     {
         m_halrcmdSocket->close();
@@ -355,12 +420,22 @@ void QHalRemoteComponent::bind()
 void QHalRemoteComponent::subscribe()
 {
     m_halrcompSocketState = Trying;
+    if (m_halrcompShmSocket != NULL)
+    {
+        m_halrcompShmSocket->subscribeTo(m_name.toLocal8Bit());
+        return;
+    }
     m_halrcompSocket->subscribeTo(m_name.toLocal8Bit());
 }
 
 void QHalRemoteComponent::unsubscribe()
 {
     m_halrcompSocketState = Down;
+    if (m_halrcompShmSocket != NULL)
+    {
+        m_halrcompShmSocket->unsubscribeFrom(m_name.toLocal8Bit());
+        return;
+    }
     m_halrcompSocket->unsubscribeFrom(m_name.toLocal8Bit());
 }
 
@@ -585,6 +660,12 @@ void QHalRemoteComponent::pollError(int errorNum, const QString &errorMsg)
     updateState(Error, SocketError, errorString);
 }
 
+/** The shared memory socket closed itself after reading a corrupt frame */
+void QHalRemoteComponent::sharedMemoryError(const QString &errorString)
+{
+    updateState(Error, SocketError, errorString);
+}
+
 /** Recurses through a list of objects */
 QObjectList QHalRemoteComponent::recurseObjects(const QObjectList &list)
 {
@@ -795,6 +876,18 @@ void QHalRemoteComponent::halrcmdMessageReceived(QList<QByteArray> messageList)
 
 void QHalRemoteComponent::sendHalrcmdMessage(pb::ContainerType type)
 {
+    if (m_halrcmdShmSocket != NULL)
+    {
+        m_tx.set_type(type);
+        bool sent = m_halrcmdShmSocket->sendMessage(QByteArray(m_tx.SerializeAsString().c_str(), m_tx.ByteSize()));
+        m_tx.Clear();
+        if (!sent)
+        {
+            updateState(Error, SocketError, m_halrcmdShmSocket->errorString());
+        }
+        return;
+    }
+
     if (m_halrcmdSocket == NULL) {  // disallow sending messages when not connected
         return;
     }
@@ -28,6 +28,7 @@
 #include <QTimer>
 #include <QUuid>
 #include "qhalpin.h"
+#include "qhalsharedmemorysocket.h"
 #include <nzmqt/nzmqt.hpp>
 #include "message.pb.h"
 #include <google/protobuf/text_format.h>
@@ -205,6 +206,8 @@ private:
     PollingZMQContext *m_context;
     ZMQSocket  *m_halrcompSocket;
     ZMQSocket  *m_halrcmdSocket;
+    QHalSharedMemorySocket *m_halrcompShmSocket;
+    QHalSharedMemorySocket *m_halrcmdShmSocket;
     QTimer     *m_halrcmdHeartbeatTimer;
     QTimer     *m_halrcompHeartbeatTimer;
     bool        m_halrcmdPingOutstanding;
@@ -236,6 +239,7 @@ private slots:
     void halrcompMessageReceived(QList<QByteArray> messageList);
     void halrcmdMessageReceived(QList<QByteArray> messageList);
     void pollError(int errorNum, const QString& errorMsg);
+    void sharedMemoryError(const QString &errorString);
     void halrcmdHeartbeatTimerTick();
     void halrcompHeartbeatTimerTick();
 
@@ -243,6 +247,7 @@ private slots:
     void removePins();
     void unsyncPins();
     bool connectSockets();
+    bool connectSharedMemorySockets();
     void disconnectSockets();
     void bind();
     void subscribe();
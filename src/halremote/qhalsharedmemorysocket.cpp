@@ -0,0 +1,496 @@
+/****************************************************************************
+**
+** Copyright (C) 2015 Alexander Rössler
+** License: LGPL version 2.1
+**
+** This file is part of QtQuickVcp.
+**
+** All rights reserved. This program and the accompanying materials
+** are made available under the terms of the GNU Lesser General Public License
+** (LGPL) version 2.1 which accompanies this distribution, and is available at
+** http://www.gnu.org/licenses/lgpl-2.1.html
+**
+** This library is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+** Lesser General Public License for more details.
+**
+** Contributors:
+** Alexander Rössler @ The Cool Tool GmbH <mail DOT aroessler AT gmail DOT com>
+**
+****************************************************************************/
+
+#include "qhalsharedmemorysocket.h"
+#include <string.h>
+#include "debughelper.h"
+
+static const quint32 segmentMagic = 0x4d4b5348;    // MKSH
+static const int headerSize = 64;                   // keeps the rings cache line aligned
+
+QHalSharedMemoryNotifier::QHalSharedMemoryNotifier(const QString &key, QObject *parent) :
+    QThread(parent),
+    m_semaphore(key, 0, QSystemSemaphore::Open),
+    m_pending(0),
+    m_stopped(0)
+{
+}
+
+void QHalSharedMemoryNotifier::run()
+{
+    forever
+    {
+        if (!m_semaphore.acquire())     // removed by the bound side
+        {
+            return;
+        }
+
+        if (m_stopped.load() == 1)
+        {
+            return;
+        }
+
+        if (m_pending.testAndSetOrdered(0, 1))
+        {
+            emit activated();
+        }
+    }
+}
+
+QHalSharedMemorySocket::QHalSharedMemorySocket(QObject *parent) :
+    QObject(parent),
+    m_sharedMemory(NULL),
+    m_header(NULL),
+    m_capacity(0),
+    m_rxRing(1),
+    m_txRing(0),
+    m_rxSemaphore(NULL),
+    m_txSemaphore(NULL),
+    m_notifier(NULL),
+    m_claimed(false),
+    m_errorString("")
+{
+    Q_STATIC_ASSERT(sizeof(SegmentHeader) <= headerSize);
+
+    m_rings[0] = NULL;
+    m_rings[1] = NULL;
+}
+
+QHalSharedMemorySocket::~QHalSharedMemorySocket()
+{
+    close();
+}
+
+/** Returns true if the uri refers to a shared memory endpoint, e.g. shm://halrcmd */
+bool QHalSharedMemorySocket::isSharedMemoryUri(const QString &uri)
+{
+    return uri.startsWith("shm://");
+}
+
+/** Creates the shared memory segment, capacity is rounded up to a power of two */
+bool QHalSharedMemorySocket::bindTo(const QString &uri, int capacity)
+{
+    quint32 ringCapacity;
+
+    close();
+
+    ringCapacity = 1024;
+    while (ringCapacity < (quint32)capacity)
+    {
+        ringCapacity <<= 1;
+    }
+
+    m_sharedMemory = new QSharedMemory(uri.mid(6), this);
+    if (!m_sharedMemory->create(headerSize + 2 * ringCapacity))
+    {
+        if (m_sharedMemory->error() == QSharedMemory::AlreadyExists)   // left over from a crashed process
+        {
+            m_sharedMemory->attach();
+            m_sharedMemory->detach();
+        }
+
+        if (!m_sharedMemory->create(headerSize + 2 * ringCapacity))
+        {
+            m_errorString = m_sharedMemory->errorString();
+            close();
+            return false;
+        }
+    }
+
+    memset(m_sharedMemory->data(), 0, m_sharedMemory->size());
+    m_header = static_cast<SegmentHeader*>(m_sharedMemory->data());
+    m_header->capacity = ringCapacity;
+    m_header->magic = segmentMagic;
+
+    if (!setup(uri.mid(6), true))
+    {
+        close();
+        return false;
+    }
+
+    return true;
+}
+
+/** Attaches to a shared memory segment created by the other side */
+bool QHalSharedMemorySocket::connectTo(const QString &uri)
+{
+    close();
+
+    m_sharedMemory = new QSharedMemory(uri.mid(6), this);
+    if (!m_sharedMemory->attach())
+    {
+        m_errorString = m_sharedMemory->errorString();
+        close();
+        return false;
+    }
+
+    m_header = static_cast<SegmentHeader*>(m_sharedMemory->data());
+    if ((m_sharedMemory->size() < headerSize)
+        || (m_header->magic != segmentMagic)
+        || !isValidCapacity(m_header->capacity)
+        || ((qint64)m_sharedMemory->size() < ((qint64)headerSize + 2 * (qint64)m_header->capacity)))
+    {
+        m_errorString = QString("%1: invalid shared memory segment").arg(uri);
+        close();
+        return false;
+    }
+
+    if (!claimSegment())
+    {
+        m_errorString = QString("%1: shared memory segment already in use").arg(uri);
+        close();
+        return false;
+    }
+
+    if (!setup(uri.mid(6), false))
+    {
+        close();
+        return false;
+    }
+
+    return true;
+}
+
+/** Only one client may consume the rings of a segment */
+bool QHalSharedMemorySocket::claimSegment()
+{
+    if (!m_sharedMemory->lock())
+    {
+        return false;
+    }
+    m_claimed = m_header->connected.testAndSetOrdered(0, 1);
+    m_sharedMemory->unlock();
+
+    return m_claimed;
+}
+
+void QHalSharedMemorySocket::releaseSegment()
+{
+    if (!m_claimed)
+    {
+        return;
+    }
+
+    m_sharedMemory->lock();
+    m_header->connected.storeRelease(0);
+    m_sharedMemory->unlock();
+    m_claimed = false;
+}
+
+/** Ring indices wrap around, so the capacity must be a power of two */
+bool QHalSharedMemorySocket::isValidCapacity(quint32 capacity)
+{
+    return (capacity >= 1024) && ((capacity & (capacity - 1)) == 0);
+}
+
+/** Maps the rings and starts waiting for frames
+ *  The bound side creates the semaphores, so it has to be set up first.
+ */
+bool QHalSharedMemorySocket::setup(const QString &name, bool bound)
+{
+    char *data;
+    QSystemSemaphore::AccessMode mode;
+    QString rxKey;
+    QString txKey;
+
+    m_capacity = m_header->capacity;
+    data = static_cast<char*>(m_sharedMemory->data()) + headerSize;
+    m_rings[0] = data;
+    m_rings[1] = data + m_capacity;
+    m_rxRing = bound ? 0 : 1;
+    m_txRing = bound ? 1 : 0;
+    m_errorString = "";
+
+    mode = bound ? QSystemSemaphore::Create : QSystemSemaphore::Open;
+    rxKey = QString("%1.ring%2").arg(name).arg(m_rxRing);
+    txKey = QString("%1.ring%2").arg(name).arg(m_txRing);
+    m_rxSemaphore = new QSystemSemaphore(rxKey, 0, mode);
+    m_txSemaphore = new QSystemSemaphore(txKey, 0, mode);
+    if (m_rxSemaphore->error() != QSystemSemaphore::NoError)
+    {
+        m_errorString = m_rxSemaphore->errorString();
+        return false;
+    }
+    if (m_txSemaphore->error() != QSystemSemaphore::NoError)
+    {
+        m_errorString = m_txSemaphore->errorString();
+        return false;
+    }
+
+    m_notifier = new QHalSharedMemoryNotifier(rxKey, this);
+    if (!m_notifier->isValid())
+    {
+        m_errorString = QString("%1: cannot open semaphore").arg(rxKey);
+        return false;
+    }
+    connect(m_notifier, SIGNAL(activated()),
+            this, SLOT(poll()));
+    m_notifier->start();
+
+    QMetaObject::invokeMethod(this, "poll", Qt::QueuedConnection); // frames sent before we were waiting
+
+    return true;
+}
+
+void QHalSharedMemorySocket::close()
+{
+    if (m_notifier != NULL)
+    {
+        m_notifier->stop();
+        m_rxSemaphore->release();   // wakes up the notifier
+        m_notifier->wait();
+        delete m_notifier;
+        m_notifier = NULL;
+    }
+
+    if (m_rxSemaphore != NULL)
+    {
+        delete m_rxSemaphore;
+        m_rxSemaphore = NULL;
+    }
+
+    if (m_txSemaphore != NULL)
+    {
+        delete m_txSemaphore;
+        m_txSemaphore = NULL;
+    }
+
+    if (m_sharedMemory != NULL)
+    {
+        releaseSegment();   // the next client may connect
+        m_sharedMemory->detach();
+        m_sharedMemory->deleteLater();
+        m_sharedMemory = NULL;
+    }
+
+    m_header = NULL;
+    m_capacity = 0;
+    m_rings[0] = NULL;
+    m_rings[1] = NULL;
+}
+
+void QHalSharedMemorySocket::copyToRing(int ring, quint32 index, const char *data, quint32 size)
+{
+    quint32 mask = m_capacity - 1;
+    quint32 offset = index & mask;
+    quint32 first = qMin(size, m_capacity - offset);
+
+    memcpy(m_rings[ring] + offset, data, first);
+    memcpy(m_rings[ring], data + first, size - first);
+}
+
+void QHalSharedMemorySocket::copyFromRing(int ring, quint32 index, char *data, quint32 size) const
+{
+    quint32 mask = m_capacity - 1;
+    quint32 offset = index & mask;
+    quint32 first = qMin(size, m_capacity - offset);
+
+    memcpy(data, m_rings[ring] + offset, first);
+    memcpy(data + first, m_rings[ring], size - first);
+}
+
+bool QHalSharedMemorySocket::sendMessage(const QByteArray &message)
+{
+    return sendMessage(QList<QByteArray>() << message);
+}
+
+/** Writes a multipart message to the transmit ring, fails if the ring is full */
+bool QHalSharedMemorySocket::sendMessage(const QList<QByteArray> &message)
+{
+    quint32 frameSize;
+    quint32 head;
+    quint32 tail;
+    quint32 partCount;
+
+    if (m_header == NULL)
+    {
+        m_errorString = "socket not connected";
+        return false;
+    }
+
+    frameSize = sizeof(quint32);
+    foreach (const QByteArray &part, message)
+    {
+        frameSize += sizeof(quint32) + part.size();
+    }
+
+    head = (quint32)m_header->head[m_txRing].load();      // only written by us
+    tail = (quint32)m_header->tail[m_txRing].loadAcquire();
+    if ((head - tail) > m_capacity)
+    {
+        m_errorString = "corrupt shared memory ring buffer";
+        return false;
+    }
+    if ((m_capacity - (head - tail)) < (frameSize + sizeof(quint32)))
+    {
+        m_errorString = "shared memory ring buffer full";
+        return false;
+    }
+
+    copyToRing(m_txRing, head, reinterpret_cast<const char*>(&frameSize), sizeof(quint32));
+    head += sizeof(quint32);
+    partCount = message.size();
+    copyToRing(m_txRing, head, reinterpret_cast<const char*>(&partCount), sizeof(quint32));
+    head += sizeof(quint32);
+    foreach (const QByteArray &part, message)
+    {
+        quint32 partSize = part.size();
+        copyToRing(m_txRing, head, reinterpret_cast<const char*>(&partSize), sizeof(quint32));
+        head += sizeof(quint32);
+        copyToRing(m_txRing, head, part.constData(), partSize);
+        head += partSize;
+    }
+
+    m_header->head[m_txRing].storeRelease((int)head);   // publish the frame
+    if (m_header->waiting[m_txRing].fetchAndStoreOrdered(0) == 1)
+    {
+        m_txSemaphore->release();   // the consumer has drained the ring
+    }
+
+    return true;
+}
+
+bool QHalSharedMemorySocket::subscribeTo(const QByteArray &topic)
+{
+    return sendMessage(QByteArray(1, '\x01') + topic);
+}
+
+bool QHalSharedMemorySocket::unsubscribeFrom(const QByteArray &topic)
+{
+    return sendMessage(QByteArray(1, '\x00') + topic);
+}
+
+/** Reads one message from the receive ring
+ *  All sizes are taken from memory shared with another process, so they
+ *  are checked against the published part of the ring before any copy.
+ */
+QHalSharedMemorySocket::ReadResult QHalSharedMemorySocket::readMessage(QList<QByteArray> &message)
+{
+    quint32 head;
+    quint32 tail;
+    quint32 available;
+    quint32 frameSize;
+    quint32 partCount;
+    quint32 remaining;
+    quint32 index;
+
+    head = (quint32)m_header->head[m_rxRing].loadAcquire();
+    tail = (quint32)m_header->tail[m_rxRing].load();       // only written by us
+    if (head == tail)
+    {
+        return ReadEmpty;
+    }
+
+    available = head - tail;
+    if ((available > m_capacity) || (available < (2 * sizeof(quint32))))
+    {
+        return ReadCorrupt;
+    }
+
+    copyFromRing(m_rxRing, tail, reinterpret_cast<char*>(&frameSize), sizeof(quint32));
+    if ((frameSize < sizeof(quint32)) || (frameSize > (available - sizeof(quint32))))
+    {
+        return ReadCorrupt;
+    }
+
+    copyFromRing(m_rxRing, tail + sizeof(quint32), reinterpret_cast<char*>(&partCount), sizeof(quint32));
+    remaining = frameSize - sizeof(quint32);
+    if (partCount > (remaining / sizeof(quint32)))
+    {
+        return ReadCorrupt;
+    }
+
+    index = tail + 2 * sizeof(quint32);
+    for (quint32 i = 0; i < partCount; ++i)
+    {
+        quint32 partSize;
+
+        if (remaining < sizeof(quint32))
+        {
+            return ReadCorrupt;
+        }
+        copyFromRing(m_rxRing, index, reinterpret_cast<char*>(&partSize), sizeof(quint32));
+        index += sizeof(quint32);
+        remaining -= sizeof(quint32);
+
+        if (partSize > remaining)
+        {
+            return ReadCorrupt;
+        }
+        QByteArray part(partSize, Qt::Uninitialized);
+        copyFromRing(m_rxRing, index, part.data(), partSize);
+        index += partSize;
+        remaining -= partSize;
+        message.append(part);
+    }
+
+    if (remaining != 0)
+    {
+        return ReadCorrupt;
+    }
+
+    m_header->tail[m_rxRing].storeRelease((int)(tail + sizeof(quint32) + frameSize)); // release the frame
+
+    return ReadMessage;
+}
+
+/** Drains the receive ring
+ *  Before returning the waiting flag is set and the ring is checked once
+ *  more, a frame published in between is read instead of being missed.
+ */
+void QHalSharedMemorySocket::poll()
+{
+    QList<QByteArray> message;
+    bool waiting = false;
+
+    if (m_notifier != NULL)
+    {
+        m_notifier->reset();
+    }
+
+    while (m_header != NULL)   // the receiver may close the socket
+    {
+        ReadResult result = readMessage(message);
+
+        if (result == ReadEmpty)
+        {
+            if (waiting)
+            {
+                return;
+            }
+            m_header->waiting[m_rxRing].fetchAndStoreOrdered(1);
+            waiting = true;
+            continue;
+        }
+
+        if (result == ReadCorrupt)
+        {
+            close();
+            m_errorString = "corrupt frame in shared memory ring buffer";
+            emit socketError(m_errorString);
+            return;
+        }
+
+        emit messageReceived(message);
+        message.clear();
+    }
+}
@@ -0,0 +1,165 @@
+/****************************************************************************
+**
+** Copyright (C) 2015 Alexander Rössler
+** License: LGPL version 2.1
+**
+** This file is part of QtQuickVcp.
+**
+** All rights reserved. This program and the accompanying materials
+** are made available under the terms of the GNU Lesser General Public License
+** (LGPL) version 2.1 which accompanies this distribution, and is available at
+** http://www.gnu.org/licenses/lgpl-2.1.html
+**
+** This library is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+** Lesser General Public License for more details.
+**
+** Contributors:
+** Alexander Rössler @ The Cool Tool GmbH <mail DOT aroessler AT gmail DOT com>
+**
+****************************************************************************/
+
+#ifndef QHALSHAREDMEMORYSOCKET_H
+#define QHALSHAREDMEMORYSOCKET_H
+
+#include <QObject>
+#include <QList>
+#include <QByteArray>
+#include <QSharedMemory>
+#include <QAtomicInt>
+#include <QSystemSemaphore>
+#include <QThread>
+
+/** Waits on the semaphore of a ring buffer on a worker thread
+ *
+ *  activated is emitted once per wake-up. Further wake-ups are folded
+ *  into it until the receiver calls reset.
+ */
+class QHalSharedMemoryNotifier : public QThread
+{
+    Q_OBJECT
+public:
+    explicit QHalSharedMemoryNotifier(const QString &key, QObject *parent = 0);
+
+    bool isValid() const
+    {
+        return m_semaphore.error() == QSystemSemaphore::NoError;
+    }
+
+    void reset()
+    {
+        m_pending.fetchAndStoreOrdered(0);
+    }
+
+    void stop()
+    {
+        m_stopped.fetchAndStoreOrdered(1);
+    }
+
+protected:
+    void run();
+
+private:
+    QSystemSemaphore m_semaphore;
+    QAtomicInt      m_pending;
+    QAtomicInt      m_stopped;
+
+signals:
+    void activated();
+};
+
+/** Duplex message socket on top of a shared memory segment
+ *
+ *  The segment contains two lock-free single-producer/single-consumer ring
+ *  buffers. The bound side (local server) reads ring 0 and writes ring 1,
+ *  the connected side (client) does the opposite. Multipart messages are
+ *  stored as length prefixed frames. Subscriptions are sent the same way as
+ *  on a 0MQ XPUB socket: a single frame starting with \x01 (subscribe) or
+ *  \x00 (unsubscribe) followed by the topic.
+ *
+ *  Each ring has a system semaphore named after the segment with the
+ *  suffix .ring0 or .ring1, created by the bound side. A consumer that
+ *  has drained its ring sets the waiting flag of the ring in the segment
+ *  header. A producer that publishes a frame clears the flag and releases
+ *  the semaphore if the flag was set. So an idle socket does not poll,
+ *  and a busy one releases the semaphore about once per drained batch.
+ *
+ *  Both rings are single consumer, so only one client may be connected.
+ *  The client claims the connected flag of the header with a
+ *  compare-and-swap while holding the segment lock and clears it on
+ *  close. A further connectTo fails until then. The flag of a crashed
+ *  client is cleared when the bound side creates the segment again.
+ *
+ *  Haltalk does not provide this transport. A server that wants to offer
+ *  it has to implement the layout above, the FakeHalServer of the
+ *  HalRemoteBenchmark test is a reference implementation.
+ */
+class QHalSharedMemorySocket : public QObject
+{
+    Q_OBJECT
+public:
+    explicit QHalSharedMemorySocket(QObject *parent = 0);
+    ~QHalSharedMemorySocket();
+
+    static bool isSharedMemoryUri(const QString &uri);
+
+    bool bindTo(const QString &uri, int capacity = 1 << 20);
+    bool connectTo(const QString &uri);
+    void close();
+
+    bool sendMessage(const QByteArray &message);
+    bool sendMessage(const QList<QByteArray> &message);
+    bool subscribeTo(const QByteArray &topic);
+    bool unsubscribeFrom(const QByteArray &topic);
+
+    QString errorString() const
+    {
+        return m_errorString;
+    }
+
+private:
+    struct SegmentHeader {
+        quint32 magic;
+        quint32 capacity;
+        QBasicAtomicInt head[2];    // written by the producer of the ring
+        QBasicAtomicInt tail[2];    // written by the consumer of the ring
+        QBasicAtomicInt waiting[2]; // set by the consumer, cleared by the producer
+        QBasicAtomicInt connected;  // claimed by the connected side
+    };
+
+    enum ReadResult {
+        ReadEmpty,
+        ReadMessage,
+        ReadCorrupt
+    };
+
+    QSharedMemory  *m_sharedMemory;
+    SegmentHeader  *m_header;
+    quint32         m_capacity;     // validated copy, the header may be changed by the peer
+    char           *m_rings[2];
+    int             m_rxRing;
+    int             m_txRing;
+    QSystemSemaphore *m_rxSemaphore;
+    QSystemSemaphore *m_txSemaphore;
+    QHalSharedMemoryNotifier *m_notifier;
+    bool            m_claimed;      // we own the connected flag of the segment
+    QString         m_errorString;
+
+    static bool isValidCapacity(quint32 capacity);
+    bool claimSegment();
+    void releaseSegment();
+    bool setup(const QString &name, bool bound);
+    void copyToRing(int ring, quint32 index, const char *data, quint32 size);
+    void copyFromRing(int ring, quint32 index, char *data, quint32 size) const;
+    ReadResult readMessage(QList<QByteArray> &message);
+
+private slots:
+    void poll();
+
+signals:
+    void messageReceived(const QList<QByteArray> &messageList);
+    void socketError(const QString &errorString);
+};
+
+#endif // QHALSHAREDMEMORYSOCKET_H
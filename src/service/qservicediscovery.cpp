@@ -21,6 +21,13 @@
 ****************************************************************************/
 #include "qservicediscovery.h"
 #include "debughelper.h"
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QStandardPaths>
 
 #if defined(Q_OS_ANDROID)
 #include <QtAndroidExtras/QAndroidJniObject>
@@ -183,11 +190,31 @@
 /*! \qmlproperty int ServiceDiscovery::unicastLookupInterval
 
     This property holds the interval for looking up services in unicast DNS mode
-    in milliseconds.
+    in milliseconds. Every lookup only queries the service instances, the records
+    of a known instance are queried again once they are about to expire.
 
     The default value is \c{5000}.
 */
 
+/*! \qmlproperty bool ServiceDiscovery::cacheEnabled
+
+    This property holds whether resolved services are persisted to the
+    \l cacheFilePath. On the next start cached services are used
+    immediately and revalidated by the running lookup in the background.
+    Cached entries are removed once their DNS TTL expires without being
+    confirmed. See ServiceDiscoveryItem::cached.
+
+    The default value is \c{false}.
+*/
+
+/*! \qmlproperty string ServiceDiscovery::cacheFilePath
+
+    This property holds the path of the service discovery cache file.
+
+    The default value is \c{servicediscovery.json} in the application
+    cache directory.
+*/
+
 /*! \qmlmethod void ServiceDiscovery::updateServices()
 
     Updates the \l{serviceLists}. Needs to be executed after modifying
@@ -236,7 +263,11 @@ QServiceDiscovery::QServiceDiscovery(QObject *parent) :
     m_networkConfigManager(NULL),
     m_networkConfigTimer(new QTimer(this)),
     m_jdns(NULL),
-    m_unicastLookupTimer(new QTimer(this))
+    m_unicastLookupTimer(new QTimer(this)),
+    m_cacheEnabled(false),
+    m_cacheFilePath(""),
+    m_cacheSaveTimer(new QTimer(this)),
+    m_cacheEvictionTimer(new QTimer(this))
 {
     m_networkConfigTimer->setInterval(3000);
     connect(m_networkConfigTimer, SIGNAL(timeout()),
@@ -248,6 +279,31 @@ QServiceDiscovery::QServiceDiscovery(QObject *parent) :
 
     connect(this, SIGNAL(nameServersChanged(QQmlListProperty<QNameServer>)),
             this, SLOT(updateNameServers()));
+
+    m_cacheSaveTimer->setInterval(1000);
+    m_cacheSaveTimer->setSingleShot(true);
+    connect(m_cacheSaveTimer, SIGNAL(timeout()),
+            this, SLOT(saveCache()));
+
+    m_cacheEvictionTimer->setInterval(5000);
+    connect(m_cacheEvictionTimer, SIGNAL(timeout()),
+            this, SLOT(evictCachedItems()));
+
+    QString basePath;
+#ifndef PORTABLE
+    basePath = QStandardPaths::writableLocation(QStandardPaths::CacheLocation);
+#else
+    basePath = QDir::currentPath();
+#endif
+    m_cacheFilePath = QDir(basePath).filePath("servicediscovery.json");
+}
+
+QServiceDiscovery::~QServiceDiscovery()
+{
+    if (m_cacheSaveTimer->isActive())   // write pending changes
+    {
+        saveCache();
+    }
 }
 
 /** componentComplete is executed when the QML component is fully loaded */
@@ -255,6 +311,11 @@ void QServiceDiscovery::componentComplete()
 {
     m_componentCompleted = true;
 
+    if (m_cacheEnabled)
+    {
+        loadCache();
+    }
+
     initializeNetworkSession();
 }
 
@@ -367,6 +428,10 @@ void QServiceDiscovery::deinitializeMdns()
         m_queryIdItemMap.clear();
         m_queryIdServiceMap.clear();
         m_queryIdTypeMap.clear();
+        m_hostQueryIdMap.clear();
+        m_queryIdHostMap.clear();
+        m_hostItemsMap.clear();
+        m_outstandingQueryIds.clear();
     }
 
     m_jdns->deleteLater();
@@ -468,6 +533,40 @@ void QServiceDiscovery::clearNameServers()
     emit nameServersChanged(nameServers());
 }
 
+void QServiceDiscovery::setCacheEnabled(bool arg)
+{
+    if (m_cacheEnabled == arg)
+        return;
+
+    m_cacheEnabled = arg;
+    emit cacheEnabledChanged(arg);
+
+    if (!m_componentCompleted)
+    {
+        return;
+    }
+
+    if (m_cacheEnabled)
+    {
+        loadCache();
+    }
+    else
+    {
+        m_cacheEvictionTimer->stop();
+        m_cacheSaveTimer->stop();
+        m_cacheEntriesMap.clear();
+    }
+}
+
+void QServiceDiscovery::setCacheFilePath(QString arg)
+{
+    if (m_cacheFilePath == arg)
+        return;
+
+    m_cacheFilePath = arg;
+    emit cacheFilePathChanged(arg);
+}
+
 void QServiceDiscovery::setUnicastErrorThreshold(int unicastErrorThreshold)
 {
     if (m_unicastErrorThreshold == unicastErrorThreshold)
@@ -483,6 +582,13 @@ void QServiceDiscovery::setRunning(bool arg)
         m_running = arg;
         emit runningChanged(arg);
 
+        if (m_running) {
+            foreach (const QString &serviceType, m_serviceItemsMap.keys())
+            {
+                restoreCachedItems(serviceType);    // usable before the network is ready
+            }
+        }
+
         if (!m_networkReady) {
             return;
         }
@@ -690,6 +796,10 @@ void QServiceDiscovery::startQuery(QString serviceType)
     queryId = m_jdns->queryStart(serviceType.toLocal8Bit(), queryType);
     m_queryIdTypeMap.insert(queryId, queryType);
     m_queryIdServiceMap.insert(queryId, serviceType);
+    if (m_lookupMode == UnicastDNS)
+    {
+        m_outstandingQueryIds.insert(queryId);
+    }
 
 #ifdef QT_DEBUG
     DEBUG_TAG(1, "SD", "Started query" << queryId << serviceType << queryType);
@@ -721,6 +831,7 @@ void QServiceDiscovery::stopQuery(QString serviceType)
     m_jdns->queryCancel(queryId);
     m_queryIdTypeMap.remove(queryId);
     m_queryIdServiceMap.remove(queryId);
+    m_outstandingQueryIds.remove(queryId);
     clearItems(serviceType);
 
 #ifdef QT_DEBUG
@@ -750,17 +861,21 @@ void QServiceDiscovery::refreshQuery(QString serviceType)
         return;
     }
 
+    if (m_outstandingQueryIds.contains(queryId))    // last lookup not answered yet, do not restart it
+    {
+        return;
+    }
+
     QJDns::Type queryType = m_serviceTypeMap.value(serviceType);
 
-    m_jdns->queryCancel(queryId);                                       // stop old query
+    m_jdns->queryCancel(queryId);                                       // release the answered query
     m_queryIdTypeMap.remove(queryId);
     m_queryIdServiceMap.remove(queryId);
 
-    purgeItems(serviceType);                                                   // purge outdated items
-
     queryId = m_jdns->queryStart(serviceType.toLocal8Bit(), queryType);       // start a new query
     m_queryIdTypeMap.insert(queryId, queryType);
     m_queryIdServiceMap.insert(queryId, serviceType);
+    m_outstandingQueryIds.insert(queryId);
 
 #ifdef QT_DEBUG
     DEBUG_TAG(2, "SD", "Refreshed query" << queryId << serviceType);
@@ -783,6 +898,20 @@ void QServiceDiscovery::stopItemQueries(QServiceDiscoveryItem *item)
             m_queryIdTypeMap.remove(queryId);
         }
     }
+
+    QMutableMapIterator<QString, QList<QServiceDiscoveryItem*> > j(m_hostItemsMap);
+    while (j.hasNext()) {
+        j.next();
+        j.value().removeAll(item);
+        if (j.value().isEmpty())    // nobody waits for the host anymore
+        {
+            int hostQueryId = m_hostQueryIdMap.take(j.key());
+            m_jdns->queryCancel(hostQueryId);
+            m_queryIdHostMap.remove(hostQueryId);
+            m_queryIdTypeMap.remove(hostQueryId);
+            j.remove();
+        }
+    }
 }
 
 void QServiceDiscovery::addServiceType(QString serviceType, QJDns::Type queryType)
@@ -796,6 +925,8 @@ void QServiceDiscovery::addServiceType(QString serviceType, QJDns::Type queryTyp
 
     m_serviceItemsMap.insert(serviceType, serviceDiscoveryItems);
     m_serviceTypeMap.insert(serviceType, queryType);
+
+    restoreCachedItems(serviceType);
 }
 
 void QServiceDiscovery::removeServiceType(QString serviceType)
@@ -967,7 +1098,19 @@ QServiceDiscoveryItem *QServiceDiscovery::getItem(QString name, QString type)
 void QServiceDiscovery::updateItem(QString name, QString type)
 {
     Q_UNUSED(name)
-    updateServiceType(type);
+    m_pendingServiceTypes.insert(type);
+}
+
+/** Publishes the service types of all items resolved by one answered query */
+void QServiceDiscovery::updatePendingServiceTypes()
+{
+    QSet<QString> serviceTypes = m_pendingServiceTypes;
+
+    m_pendingServiceTypes.clear();
+    foreach (const QString &serviceType, serviceTypes)
+    {
+        updateServiceType(serviceType);
+    }
 }
 
 void QServiceDiscovery::removeItem(QString name, QString type)
@@ -1014,6 +1157,10 @@ void QServiceDiscovery::clearItems(QString type)
     {
         QServiceDiscoveryItem *item;
         item = serviceDiscoveryItems.takeAt(i);
+        if (m_cacheEnabled && isCacheable(item, QDateTime::currentDateTimeUtc()))
+        {
+            m_cacheEntriesMap[type].append(cacheEntry(item));   // keep the item for the next start
+        }
         stopItemQueries(item);
         item->deleteLater();
     }
@@ -1022,8 +1169,10 @@ void QServiceDiscovery::clearItems(QString type)
     updateServiceType(type);
 }
 
-/** Removes items that have not been updated and flags other items with not updated **/
-void QServiceDiscovery::purgeItems(QString serviceType)
+/** Updates the items of a service type in place with the names of a unicast answer,
+ *  items missing in more answers than tolerated by the error threshold are removed
+ **/
+void QServiceDiscovery::refreshItems(QString serviceType, const QSet<QString> &names)
 {
     QList<QServiceDiscoveryItem*> serviceDiscoveryItems;
     bool modified;
@@ -1042,8 +1191,14 @@ void QServiceDiscovery::purgeItems(QString serviceType)
     {
         QServiceDiscoveryItem *serviceDiscoveryItem = serviceDiscoveryItems[i];
 
-        if (!serviceDiscoveryItem->updated())    // remove old items
+        if (names.contains(serviceDiscoveryItem->name()))
         {
+            serviceDiscoveryItem->setUpdated(true);
+            serviceDiscoveryItem->resetErrorCount();
+        }
+        else
+        {
+            serviceDiscoveryItem->setUpdated(false);
             serviceDiscoveryItem->increaseErrorCount();
             if (serviceDiscoveryItem->errorCount() > m_unicastErrorThreshold ) // if threshold is reached we cleanup
             {
@@ -1053,10 +1208,6 @@ void QServiceDiscovery::purgeItems(QString serviceType)
                 modified = true;
             }
         }
-        else
-        {
-            serviceDiscoveryItem->setUpdated(false);
-        }
     }
 
     if (modified)
@@ -1066,11 +1217,311 @@ void QServiceDiscovery::purgeItems(QString serviceType)
     }
 }
 
+/** Returns true if the records of an item are about to expire and should be queried again,
+ *  the margin covers the next two lookup intervals
+ **/
+bool QServiceDiscovery::isRefreshDue(QServiceDiscoveryItem *item, const QDateTime &now) const
+{
+    if (item->cached() || !item->expires().isValid())
+    {
+        return true;
+    }
+
+    int margin = qMax(1, (2 * m_unicastLookupInterval) / 1000);
+    return (now.secsTo(item->expires()) <= margin);
+}
+
+void QServiceDiscovery::itemResolved(QServiceDiscoveryItem *item)
+{
+    item->setExpires(QDateTime::currentDateTimeUtc().addSecs(item->ttl()));
+    item->setCached(false);     // confirmed by the lookup
+    updateItem(item->name(), item->type());
+    item->setUpdated(true);
+    item->resetErrorCount();
+
+    if (m_cacheEnabled)
+    {
+        m_cacheSaveTimer->start();
+    }
+}
+
+QString QServiceDiscovery::normalizeHostname(const QString &hostname)
+{
+    QString normalized = hostname.toLower();
+
+    if (normalized.endsWith('.'))
+    {
+        normalized.chop(1);
+    }
+
+    return normalized;
+}
+
+/** Resolves the address of a host for an item, returns true if the address was known.
+ *  Items of the same host share one A query, resolved addresses are reused by all
+ *  service types until their TTL expires.
+ */
+bool QServiceDiscovery::isItemResolving(QServiceDiscoveryItem *item) const
+{
+    if (m_queryIdItemMap.values().contains(item))
+    {
+        return true;
+    }
+
+    foreach (const QList<QServiceDiscoveryItem*> &items, m_hostItemsMap)
+    {
+        if (items.contains(item))
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+bool QServiceDiscovery::resolveHost(const QString &hostname, QServiceDiscoveryItem *item)
+{
+    QString host = normalizeHostname(hostname);
+
+    if (m_hostAddressMap.contains(host))
+    {
+        const HostAddressEntry &entry = m_hostAddressMap[host];
+        if (entry.expires > QDateTime::currentDateTimeUtc())
+        {
+            item->setHostAddress(entry.address);
+            item->setTtl(qMin(item->ttl(), (int)QDateTime::currentDateTimeUtc().secsTo(entry.expires)));
+            return true;
+        }
+        m_hostAddressMap.remove(host);
+    }
+
+    if (!m_hostItemsMap[host].contains(item))
+    {
+        m_hostItemsMap[host].append(item);
+    }
+
+    if (!m_hostQueryIdMap.contains(host))   // no query for the host running
+    {
+        int queryId = m_jdns->queryStart(hostname.toLocal8Bit(), QJDns::A);
+        m_queryIdTypeMap.insert(queryId, QJDns::A);
+        m_queryIdHostMap.insert(queryId, host);
+        m_hostQueryIdMap.insert(host, queryId);
+    }
+
+    return false;
+}
+
+void QServiceDiscovery::updateHostAddress(const QString &hostname, const QHostAddress &address, int ttl)
+{
+    QString host = normalizeHostname(hostname);
+
+    if (ttl <= 0)
+    {
+        m_hostAddressMap.remove(host);
+        return;
+    }
+
+    HostAddressEntry entry;
+    entry.address = address;
+    entry.expires = QDateTime::currentDateTimeUtc().addSecs(ttl);
+    m_hostAddressMap.insert(host, entry);
+}
+
+/** Loads the cache file, entries are restored once their service type is queried */
+void QServiceDiscovery::loadCache()
+{
+    QFile file(m_cacheFilePath);
+    QDateTime now = QDateTime::currentDateTimeUtc();
+
+    m_cacheEntriesMap.clear();
+
+    if (file.exists() && file.open(QIODevice::ReadOnly))
+    {
+        QJsonArray entries = QJsonDocument::fromJson(file.readAll()).object().value("items").toArray();
+        file.close();
+
+        foreach (const QJsonValue &value, entries)
+        {
+            QJsonObject entry = value.toObject();
+            QDateTime expires = QDateTime::fromMSecsSinceEpoch((qint64)entry.value("expires").toDouble(), Qt::UTC);
+
+            if (expires > now)
+            {
+                m_cacheEntriesMap[entry.value("type").toString()].append(entry);
+            }
+        }
+    }
+
+#ifdef QT_DEBUG
+    DEBUG_TAG(1, "SD", "Loaded cache" << m_cacheFilePath << m_cacheEntriesMap.keys());
+#endif
+
+    foreach (const QString &serviceType, m_serviceItemsMap.keys())
+    {
+        restoreCachedItems(serviceType);
+    }
+
+    m_cacheEvictionTimer->start();
+}
+
+/** Creates items from cache entries, the items are used until confirmed or expired */
+void QServiceDiscovery::restoreCachedItems(QString serviceType)
+{
+    QList<QJsonObject> entries;
+    QDateTime now = QDateTime::currentDateTimeUtc();
+
+    if (!m_cacheEnabled || !m_running || !m_cacheEntriesMap.contains(serviceType))
+    {
+        return;
+    }
+
+    entries = m_cacheEntriesMap.take(serviceType);
+    foreach (const QJsonObject &entry, entries)
+    {
+        QDateTime expires = QDateTime::fromMSecsSinceEpoch((qint64)entry.value("expires").toDouble(), Qt::UTC);
+        QStringList txtRecords;
+
+        if (expires <= now)
+        {
+            continue;
+        }
+
+        QServiceDiscoveryItem *item = addItem(entry.value("name").toString(), serviceType);
+        if (item == NULL)
+        {
+            continue;
+        }
+
+        if (item->outstandingRequests() > 0)    // already being resolved by a lookup
+        {
+            continue;
+        }
+
+        foreach (const QJsonValue &txtRecord, entry.value("txtRecords").toArray())
+        {
+            txtRecords.append(txtRecord.toString());
+        }
+
+        item->setTxtRecords(txtRecords);
+        item->setPort(entry.value("port").toInt());
+        item->setHostAddress(QHostAddress(entry.value("hostAddress").toString()));
+        item->setTtl(qMax((qint64)0, now.secsTo(expires)));
+        item->setExpires(expires);
+        item->setCached(true);
+        item->setUpdated(true);
+    }
+
+    updateServiceType(serviceType);
+}
+
+bool QServiceDiscovery::isCacheable(QServiceDiscoveryItem *item, const QDateTime &now)
+{
+    return (item->outstandingRequests() <= 0) && item->expires().isValid() && (item->expires() > now);
+}
+
+QJsonObject QServiceDiscovery::cacheEntry(QServiceDiscoveryItem *item)
+{
+    QJsonObject entry;
+
+    entry["name"] = item->name();
+    entry["type"] = item->type();
+    entry["hostAddress"] = item->hostAddress().toString();
+    entry["port"] = item->port();
+    entry["txtRecords"] = QJsonArray::fromStringList(item->txtRecords());
+    entry["expires"] = (double)item->expires().toMSecsSinceEpoch();
+
+    return entry;
+}
+
+/** Writes all resolved items and unused cache entries to the cache file */
+void QServiceDiscovery::saveCache()
+{
+    QJsonArray entries;
+    QDateTime now = QDateTime::currentDateTimeUtc();
+
+    m_cacheSaveTimer->stop();
+
+    QMapIterator<QString, QList<QServiceDiscoveryItem*> > i(m_serviceItemsMap);
+    while (i.hasNext())
+    {
+        i.next();
+        foreach (QServiceDiscoveryItem *item, i.value())
+        {
+            if (isCacheable(item, now))
+            {
+                entries.append(cacheEntry(item));
+            }
+        }
+    }
+
+    QMapIterator<QString, QList<QJsonObject> > j(m_cacheEntriesMap);
+    while (j.hasNext())
+    {
+        j.next();
+        foreach (const QJsonObject &entry, j.value())
+        {
+            entries.append(entry);
+        }
+    }
+
+    QJsonObject cache;
+    cache["items"] = entries;
+
+    QFileInfo fileInfo(m_cacheFilePath);
+    if (!QDir().mkpath(fileInfo.path()))
+    {
+        return;
+    }
+
+    QSaveFile file(m_cacheFilePath);
+    if (file.open(QIODevice::WriteOnly))
+    {
+        file.write(QJsonDocument(cache).toJson(QJsonDocument::Compact));
+        file.commit();
+    }
+}
+
+/** Removes cached items that expired without being confirmed by a lookup */
+void QServiceDiscovery::evictCachedItems()
+{
+    QDateTime now = QDateTime::currentDateTimeUtc();
+    QList<QPair<QString, QString> > expiredItems;
+
+    QMapIterator<QString, QList<QServiceDiscoveryItem*> > i(m_serviceItemsMap);
+    while (i.hasNext())
+    {
+        i.next();
+        foreach (QServiceDiscoveryItem *item, i.value())
+        {
+            if (item->cached() && (item->expires() <= now))
+            {
+                expiredItems.append(qMakePair(item->name(), item->type()));
+            }
+        }
+    }
+
+    for (int j = 0; j < expiredItems.size(); ++j)
+    {
+#ifdef QT_DEBUG
+        DEBUG_TAG(1, "SD", "Cached item expired" << expiredItems.at(j).second << expiredItems.at(j).first);
+#endif
+        removeItem(expiredItems.at(j).first, expiredItems.at(j).second);
+    }
+
+    if (!expiredItems.isEmpty())
+    {
+        m_cacheSaveTimer->start();
+    }
+}
+
 void QServiceDiscovery::resultsReady(int id, const QJDns::Response &results)
 {
     QJDns::Type type;
+    QSet<QString> answeredNames;
+    QDateTime now;
 
     type = m_queryIdTypeMap.value(id);
+    now = QDateTime::currentDateTimeUtc();
 
     foreach(QJDns::Record r, results.answerRecords)
     {
@@ -1090,8 +1541,21 @@ void QServiceDiscovery::resultsReady(int id, const QJDns::Response &results)
 
             if (r.ttl > 0)
             {
+                answeredNames.insert(name);
+
+                item = getItem(name, serviceType);
+                if ((m_lookupMode == UnicastDNS) && (item != NULL) && !isRefreshDue(item, now))
+                {
+                    continue;   // records still valid, no need to resolve the item again
+                }
+
                 item = addItem(name, serviceType);
+                if (isItemResolving(item))  // repeated answer, the queries are already running
+                {
+                    continue;
+                }
                 item->setOutstandingRequests(3);     // We have to do 3 requests before the item is fully resolved
+                item->setTtl(r.ttl);
                 newId = m_jdns->queryStart(r.name, QJDns::Txt);
                 m_queryIdTypeMap.insert(newId, QJDns::Txt);
                 m_queryIdItemMap.insert(newId, item);
@@ -1119,6 +1583,7 @@ void QServiceDiscovery::resultsReady(int id, const QJDns::Response &results)
             }
 
             item->setTxtRecords(txtRecords);
+            item->setTtl(qMin(item->ttl(), r.ttl));
 
 #ifdef QT_DEBUG
             DEBUG_TAG(2, "SD", "Txt DNS record" << item->type() << item->name() << "Texts:" << r.texts);
@@ -1131,11 +1596,13 @@ void QServiceDiscovery::resultsReady(int id, const QJDns::Response &results)
             m_queryIdTypeMap.remove(id);
             m_queryIdItemMap.remove(id);
 
-            newId = m_jdns->queryStart(r.name, QJDns::A);
-            m_queryIdTypeMap.insert(newId, QJDns::A);
-            m_queryIdItemMap.insert(newId, item);
-
             item->setPort(r.port);
+            item->setTtl(qMin(item->ttl(), r.ttl));
+
+            if (resolveHost(QString::fromLocal8Bit(r.name), item))  // address already known
+            {
+                item->setOutstandingRequests(item->outstandingRequests() - 1);
+            }
 
 #ifdef QT_DEBUG
             DEBUG_TAG(2, "SD", "Srv DNS record" << item->type() << item->name() << "Port:" << r.port);
@@ -1145,21 +1612,40 @@ void QServiceDiscovery::resultsReady(int id, const QJDns::Response &results)
         {
             QString serviceType = m_queryIdServiceMap.value(id, QString());
 
-            if (serviceType.isEmpty()) // this request was started by another service
+            if (serviceType.isEmpty()) // this request was started for the host of one or more items
             {
-                item = m_queryIdItemMap.value(id);
+                QString host = m_queryIdHostMap.take(id);
                 m_jdns->queryCancel(id);    // we have our results
                 m_queryIdTypeMap.remove(id);
-                m_queryIdItemMap.remove(id);
-                item->setHostAddress(r.address);
+                m_hostQueryIdMap.remove(host);
+                updateHostAddress(host, r.address, r.ttl);
+
+                foreach (QServiceDiscoveryItem *hostItem, m_hostItemsMap.take(host))
+                {
+                    hostItem->setHostAddress(r.address);
+                    hostItem->setTtl(qMin(hostItem->ttl(), r.ttl));
+                    hostItem->setOutstandingRequests(hostItem->outstandingRequests() - 1);
+                    if (hostItem->outstandingRequests() <= 0)
+                    {
+                        itemResolved(hostItem);
+                    }
+#ifdef QT_DEBUG
+                    DEBUG_TAG(2, "SD", "A DNS record" << hostItem->type() << hostItem->name() << "Address:" << r.address.toString());
+#endif
+                }
+                break;  // the query is finished
             }
             else
             {
+                updateHostAddress(serviceType, r.address, r.ttl);
+
                 if (r.ttl > 0)
                 {
+                    answeredNames.insert(serviceType);
                     item = addItem(serviceType, serviceType);
                     item->setOutstandingRequests(1);     // With this request the item is resolved
                     item->setHostAddress(r.address);
+                    item->setTtl(r.ttl);
                 }
                 else
                 {
@@ -1179,11 +1665,15 @@ void QServiceDiscovery::resultsReady(int id, const QJDns::Response &results)
 
             if (!serviceType.isEmpty())
             {
-                if (r.ttl != 0)
+                updateHostAddress(serviceType, r.address, r.ttl);
+
+                if (r.ttl > 0)
                 {
+                    answeredNames.insert(serviceType);
                     item = addItem(serviceType, serviceType);
                     item->setOutstandingRequests(1);     // With this request the item is resolved
                     item->setHostAddress(r.address);
+                    item->setTtl(r.ttl);
                 }
                 else
                 {
@@ -1203,12 +1693,17 @@ void QServiceDiscovery::resultsReady(int id, const QJDns::Response &results)
             item->setOutstandingRequests(item->outstandingRequests() - 1);
             if (item->outstandingRequests() <= 0)   // item is fully resolved
             {
-                updateItem(item->name(), item->type());
-                item->setUpdated(true);
-                item->resetErrorCount();
+                itemResolved(item);
             }
         }
     }
+
+    if (m_outstandingQueryIds.remove(id))   // answer to a unicast lookup
+    {
+        refreshItems(m_queryIdServiceMap.value(id), answeredNames);
+    }
+
+    updatePendingServiceTypes();
 }
 
 void QServiceDiscovery::error(int id, QJDns::Error e)
@@ -1223,6 +1718,25 @@ void QServiceDiscovery::error(int id, QJDns::Error e)
     else if(e == QJDns::ErrorConflict)
         errorString = "Conflict";
 
+    if (m_outstandingQueryIds.remove(id))   // unicast lookup failed, count it for all items
+    {
+        refreshItems(m_queryIdServiceMap.value(id), QSet<QString>());
+    }
+    else if (m_queryIdItemMap.contains(id)) // resolving the item failed, the next answer retries
+    {
+        m_jdns->queryCancel(id);
+        m_queryIdItemMap.remove(id);
+        m_queryIdTypeMap.remove(id);
+    }
+    else if (m_queryIdHostMap.contains(id))
+    {
+        QString host = m_queryIdHostMap.take(id);
+        m_jdns->queryCancel(id);
+        m_queryIdTypeMap.remove(id);
+        m_hostQueryIdMap.remove(host);
+        m_hostItemsMap.remove(host);
+    }
+
 #ifdef QT_DEBUG
     WARNING_TAG(1, "SD",  "==================== error ====================");
     WARNING_TAG(1, "SD",  "id:" << id << errorString);
@@ -24,6 +24,8 @@
 
 #include <QObject>
 #include <QQmlParserStatus>
+#include <QJsonObject>
+#include <QSet>
 #include <qjdns.h>
 #include <qjdnsshared.h>
 #include "qservicediscoveryitem.h"
@@ -45,6 +47,8 @@ class QServiceDiscovery : public QObject, public QQmlParserStatus
     Q_PROPERTY(int unicastLookupInterval READ unicastLookupInterval WRITE setUnicastLookupInterval NOTIFY unicastLookupIntervalChanged)
     Q_PROPERTY(int unicastErrorThreshold READ unicastErrorThreshold WRITE setUnicastErrorThreshold NOTIFY unicastErrorThresholdChanged)
     Q_PROPERTY(QQmlListProperty<QNameServer> nameServers READ nameServers NOTIFY nameServersChanged)
+    Q_PROPERTY(bool cacheEnabled READ isCacheEnabled WRITE setCacheEnabled NOTIFY cacheEnabledChanged)
+    Q_PROPERTY(QString cacheFilePath READ cacheFilePath WRITE setCacheFilePath NOTIFY cacheFilePathChanged)
 
     Q_ENUMS(LookupMode)
 
@@ -55,6 +59,7 @@ public:
     };
 
     explicit QServiceDiscovery(QObject *parent = 0);
+    ~QServiceDiscovery();
 
     void classBegin() {}
     void componentComplete();
@@ -102,6 +107,16 @@ public:
         return m_unicastErrorThreshold;
     }
 
+    bool isCacheEnabled() const
+    {
+        return m_cacheEnabled;
+    }
+
+    QString cacheFilePath() const
+    {
+        return m_cacheFilePath;
+    }
+
 public slots:
     void setRunning(bool arg);
     void setFilter(QServiceDiscoveryFilter *arg);
@@ -114,6 +129,8 @@ public slots:
     void addNameServer(QNameServer *nameServer);
     void removeNameServer(int index);
     void clearNameServers();
+    void setCacheEnabled(bool arg);
+    void setCacheFilePath(QString arg);
 
 signals:
     void runningChanged(bool arg);
@@ -124,6 +141,8 @@ signals:
     void unicastLookupIntervalChanged(int arg);
     void unicastErrorThresholdChanged(int unicastErrorThreshold);
     void nameServersChanged(QQmlListProperty<QNameServer> arg);
+    void cacheEnabledChanged(bool arg);
+    void cacheFilePathChanged(QString arg);
 
 private:
     bool m_componentCompleted;
@@ -131,7 +150,7 @@ private:
     bool m_networkReady;
     bool m_lookupReady;
     LookupMode m_lookupMode;
-    int m_unicastLookupInterval;    // interval for unicast lookups, queries are stop when retriggered
+    int m_unicastLookupInterval;    // interval for unicast lookups, records close to expiry are queried again
     int m_unicastErrorThreshold;    // amount of unicast lookup timeouts to tolerate
     QServiceDiscoveryFilter *m_filter;
     QList<QServiceList*> m_serviceLists;
@@ -148,7 +167,24 @@ private:
     QMap<QString, QList<QServiceDiscoveryItem*> > m_serviceItemsMap; // serviceType > items
     QMap<QString, QJDns::Type> m_serviceTypeMap; // serviceType > queryType
 
+    struct HostAddressEntry {
+        QHostAddress address;
+        QDateTime expires;
+    };
+    QMap<QString, int> m_hostQueryIdMap; // hostname > running A queryId, shared by all items of the host
+    QMap<int, QString> m_queryIdHostMap; // queryId > hostname
+    QMap<QString, QList<QServiceDiscoveryItem*> > m_hostItemsMap; // hostname > items waiting for the address
+    QMap<QString, HostAddressEntry> m_hostAddressMap; // hostname > resolved address, shared across service types
+    QSet<QString> m_pendingServiceTypes; // service types with items resolved by the current answer
+
     QTimer *m_unicastLookupTimer;
+    QSet<int> m_outstandingQueryIds;    // unicast lookups waiting for an answer
+
+    bool m_cacheEnabled;
+    QString m_cacheFilePath;
+    QMap<QString, QList<QJsonObject> > m_cacheEntriesMap; // serviceType > cached items not yet restored
+    QTimer *m_cacheSaveTimer;       // delays writing the cache file
+    QTimer *m_cacheEvictionTimer;   // removes expired cached items
 
     void initializeNetworkSession();
     void startQueries();
@@ -167,9 +203,20 @@ private:
     QServiceDiscoveryItem *addItem(QString name, QString type);
     QServiceDiscoveryItem *getItem(QString name, QString type);
     void updateItem(QString name, QString type);
+    void updatePendingServiceTypes();
     void removeItem(QString name, QString type);
     void clearItems(QString type);
-    void purgeItems(QString serviceType);
+    void refreshItems(QString serviceType, const QSet<QString> &names);
+    bool isRefreshDue(QServiceDiscoveryItem *item, const QDateTime &now) const;
+    void itemResolved(QServiceDiscoveryItem *item);
+    bool isItemResolving(QServiceDiscoveryItem *item) const;
+    bool resolveHost(const QString &hostname, QServiceDiscoveryItem *item);
+    void updateHostAddress(const QString &hostname, const QHostAddress &address, int ttl);
+    static QString normalizeHostname(const QString &hostname);
+    void loadCache();
+    void restoreCachedItems(QString serviceType);
+    static bool isCacheable(QServiceDiscoveryItem *item, const QDateTime &now);
+    static QJsonObject cacheEntry(QServiceDiscoveryItem *item);
 
 private slots:
     void resultsReady(int id, const QJDns::Response &results);
@@ -182,6 +229,8 @@ private slots:
     void networkSessionClosed();
     void networkSessionError(QNetworkSession::SessionError error);
     void unicastLookup();
+    void saveCache();
+    void evictCachedItems();
 };
 
 #endif // QAPPDISCOVERY_H
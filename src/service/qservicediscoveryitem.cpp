@@ -78,6 +78,12 @@
     This property holds the TXT records of the service.
 */
 
+/*! \qmlproperty bool ServiceDiscoveryItem::cached
+
+    This property holds whether the item was restored from the service
+    discovery cache and has not yet been confirmed by a fresh lookup.
+*/
+
 QServiceDiscoveryItem::QServiceDiscoveryItem(QObject *parent) :
     QObject(parent),
     m_name(""),
@@ -90,7 +96,10 @@ QServiceDiscoveryItem::QServiceDiscoveryItem(QObject *parent) :
     m_txtRecords(QStringList()),
     m_outstandingRequests(0),
     m_updated(false),
-    m_errorCount(0)
+    m_errorCount(0),
+    m_cached(false),
+    m_ttl(0),
+    m_expires(QDateTime())
 {
 }
 
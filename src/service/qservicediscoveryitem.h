@@ -38,6 +38,7 @@ class QServiceDiscoveryItem : public QObject
     Q_PROPERTY(QHostAddress hostAddress READ hostAddress NOTIFY hostAddressChanged)
     Q_PROPERTY(QStringList txtRecords READ txtRecords NOTIFY txtRecordsChanged)
     Q_PROPERTY(bool updated READ updated WRITE setUpdated NOTIFY updatedChanged)
+    Q_PROPERTY(bool cached READ cached NOTIFY cachedChanged)
 
 public:
     explicit QServiceDiscoveryItem(QObject *parent = 0);
@@ -98,6 +99,21 @@ public:
         return m_errorCount;
     }
 
+    bool cached() const
+    {
+        return m_cached;
+    }
+
+    int ttl() const
+    {
+        return m_ttl;
+    }
+
+    QDateTime expires() const
+    {
+        return m_expires;
+    }
+
 public slots:
 
     void setUri(QString arg)
@@ -187,6 +203,24 @@ public slots:
         m_errorCount += 1;
     }
 
+    void setCached(bool arg)
+    {
+        if (m_cached != arg) {
+            m_cached = arg;
+            emit cachedChanged(arg);
+        }
+    }
+
+    void setTtl(int arg)
+    {
+        m_ttl = arg;
+    }
+
+    void setExpires(const QDateTime &arg)
+    {
+        m_expires = arg;
+    }
+
 private:
     QString m_name;
     QString m_type;
@@ -199,6 +233,9 @@ private:
     int m_outstandingRequests;
     bool m_updated;
     int m_errorCount;
+    bool m_cached;
+    int m_ttl;
+    QDateTime m_expires;
 
 signals:
     void uriChanged(QString arg);
@@ -210,6 +247,7 @@ signals:
     void uuidChanged(QString arg);
     void versionChanged(int arg);
     void updatedChanged(bool arg);
+    void cachedChanged(bool arg);
 };
 
 #endif // QAPPDISCOVERYITEM_H
@@ -0,0 +1,100 @@
+/****************************************************************************
+**
+** Copyright (C) 2015 Alexander Rössler
+** License: LGPL version 2.1
+**
+** This file is part of QtQuickVcp.
+**
+** All rights reserved. This program and the accompanying materials
+** are made available under the terms of the GNU Lesser General Public License
+** (LGPL) version 2.1 which accompanies this distribution, and is available at
+** http://www.gnu.org/licenses/lgpl-2.1.html
+**
+** This library is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+** Lesser General Public License for more details.
+**
+** Contributors:
+** Alexander Rössler @ The Cool Tool GmbH <mail DOT aroessler AT gmail DOT com>
+**
+****************************************************************************/
+
+#include "mjpegframedecoder.h"
+#include <QBuffer>
+#include <QImageReader>
+#include <QElapsedTimer>
+
+MjpegFrameDecoder::MjpegFrameDecoder(QObject *receiver, const QList<QByteArray> &frames) :
+    m_receiver(receiver),
+    m_frames(frames)
+{
+}
+
+/** Empty sizes, like the size of an invisible item, are ignored */
+void MjpegFrameDecoder::addTargetSize(const QSize &size, Qt::AspectRatioMode aspectRatioMode)
+{
+    if (size.isEmpty())
+    {
+        return;
+    }
+
+    m_targetSizes.append(qMakePair(size, aspectRatioMode));
+}
+
+void MjpegFrameDecoder::run()
+{
+    QList<QImage> images;
+    QElapsedTimer elapsedTimer;
+
+    elapsedTimer.start();
+    for (int i = 0; i < m_frames.size(); ++i)
+    {
+        images.append(decode(m_frames.at(i)));
+    }
+
+    if (!m_receiver.isNull())
+    {
+        QMetaObject::invokeMethod(m_receiver.data(), "framesDecoded", Qt::QueuedConnection,
+                                  Q_ARG(QList<QImage>, images),
+                                  Q_ARG(qint64, elapsedTimer.nsecsElapsed() / 1000));
+    }
+}
+
+QImage MjpegFrameDecoder::decode(const QByteArray &data) const
+{
+    QBuffer buffer;
+    QImage image;
+
+    buffer.setData(data);
+    buffer.open(QIODevice::ReadOnly);
+    QImageReader reader(&buffer, "JPG");
+
+    if (!m_targetSizes.isEmpty())
+    {
+        QSize size = reader.size();     // reads the header only
+
+        if (size.isValid())
+        {
+            QSize scaledSize(0, 0);
+
+            for (int i = 0; i < m_targetSizes.size(); ++i)
+            {
+                scaledSize = scaledSize.expandedTo(size.scaled(m_targetSizes.at(i).first, m_targetSizes.at(i).second));
+            }
+            scaledSize = size.scaled(scaledSize, Qt::KeepAspectRatioByExpanding);
+
+            if ((scaledSize.width() < size.width()) && (scaledSize.height() < size.height()))
+            {
+                reader.setScaledSize(scaledSize);
+            }
+        }
+    }
+
+    if (!reader.read(&image))
+    {
+        return QImage();
+    }
+
+    return image;
+}
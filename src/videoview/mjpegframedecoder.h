@@ -0,0 +1,61 @@
+/****************************************************************************
+**
+** Copyright (C) 2015 Alexander Rössler
+** License: LGPL version 2.1
+**
+** This file is part of QtQuickVcp.
+**
+** All rights reserved. This program and the accompanying materials
+** are made available under the terms of the GNU Lesser General Public License
+** (LGPL) version 2.1 which accompanies this distribution, and is available at
+** http://www.gnu.org/licenses/lgpl-2.1.html
+**
+** This library is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+** Lesser General Public License for more details.
+**
+** Contributors:
+** Alexander Rössler @ The Cool Tool GmbH <mail DOT aroessler AT gmail DOT com>
+**
+****************************************************************************/
+
+#ifndef MJPEGFRAMEDECODER_H
+#define MJPEGFRAMEDECODER_H
+
+#include <QObject>
+#include <QPointer>
+#include <QRunnable>
+#include <QByteArray>
+#include <QImage>
+#include <QList>
+#include <QPair>
+#include <QSize>
+
+/** Decodes the JPEG frames of a video package on a worker thread
+ *
+ *  With target sizes set, frames larger than all targets are decoded
+ *  directly at the largest display size. The JPEG image plugin scales in
+ *  the DCT domain, which is much cheaper than decoding at full size and
+ *  scaling afterwards. When finished the framesDecoded slot of the receiver is
+ *  invoked through a queued connection with the decoded images and the
+ *  decoding time in microseconds.
+ */
+class MjpegFrameDecoder : public QRunnable
+{
+public:
+    MjpegFrameDecoder(QObject *receiver, const QList<QByteArray> &frames);
+
+    void addTargetSize(const QSize &size, Qt::AspectRatioMode aspectRatioMode);
+
+    void run();
+
+private:
+    QPointer<QObject> m_receiver;
+    QList<QByteArray> m_frames;
+    QList<QPair<QSize, Qt::AspectRatioMode> > m_targetSizes;
+
+    QImage decode(const QByteArray &data) const;
+};
+
+#endif // MJPEGFRAMEDECODER_H
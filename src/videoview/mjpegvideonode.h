@@ -0,0 +1,44 @@
+/****************************************************************************
+**
+** Copyright (C) 2015 Alexander Rössler
+** License: LGPL version 2.1
+**
+** This file is part of QtQuickVcp.
+**
+** All rights reserved. This program and the accompanying materials
+** are made available under the terms of the GNU Lesser General Public License
+** (LGPL) version 2.1 which accompanies this distribution, and is available at
+** http://www.gnu.org/licenses/lgpl-2.1.html
+**
+** This library is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+** Lesser General Public License for more details.
+**
+** Contributors:
+** Alexander Rössler @ The Cool Tool GmbH <mail DOT aroessler AT gmail DOT com>
+**
+****************************************************************************/
+
+#ifndef MJPEGVIDEONODE_H
+#define MJPEGVIDEONODE_H
+
+#include <QSGSimpleTextureNode>
+#include <QQuickWindow>
+#include <QImage>
+
+/** Scene graph node displaying the current video frame
+ *
+ *  The frame is uploaded as texture once when it changes, scaling to the
+ *  item size is done by the GPU. The node owns its texture.
+ */
+class MjpegVideoNode : public QSGSimpleTextureNode
+{
+public:
+    MjpegVideoNode();
+    ~MjpegVideoNode();
+
+    void setImage(QQuickWindow *window, const QImage &image);
+};
+
+#endif // MJPEGVIDEONODE_H
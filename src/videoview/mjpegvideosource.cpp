@@ -0,0 +1,249 @@
+/****************************************************************************
+**
+** Copyright (C) 2015 Alexander Rössler
+** License: LGPL version 2.1
+**
+** This file is part of QtQuickVcp.
+**
+** All rights reserved. This program and the accompanying materials
+** are made available under the terms of the GNU Lesser General Public License
+** (LGPL) version 2.1 which accompanies this distribution, and is available at
+** http://www.gnu.org/licenses/lgpl-2.1.html
+**
+** This library is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+** Lesser General Public License for more details.
+**
+** Contributors:
+** Alexander Rössler @ The Cool Tool GmbH <mail DOT aroessler AT gmail DOT com>
+**
+****************************************************************************/
+
+#include "mjpegvideosource.h"
+#include "mjpegframedecoder.h"
+#include <QDateTime>
+#ifdef QT_DEBUG
+#include <QDebug>
+#endif
+
+static QHash<QString, MjpegVideoSource*> videoSources;
+
+MjpegVideoSource::MjpegVideoSource(const QString &videoUri, QObject *parent) :
+    QObject(parent),
+    m_videoUri(videoUri),
+    m_refCount(0),
+    m_context(NULL),
+    m_updateSocket(NULL),
+    m_decoderPool(new QThreadPool(this)),
+    m_decoding(false),
+    m_droppedFrames(0)
+{
+    qRegisterMetaType<QList<QImage> >("QList<QImage>");
+    m_decoderPool->setMaxThreadCount(1);
+
+    connectSocket();
+}
+
+MjpegVideoSource::~MjpegVideoSource()
+{
+    disconnectSocket();
+    m_decoderPool->clear();
+    m_decoderPool->waitForDone();
+}
+
+/** Returns the source for the uri, created on first use */
+MjpegVideoSource *MjpegVideoSource::acquire(const QString &videoUri)
+{
+    MjpegVideoSource *source = videoSources.value(videoUri, NULL);
+
+    if (source == NULL)
+    {
+        source = new MjpegVideoSource(videoUri);
+        videoSources.insert(videoUri, source);
+    }
+    source->m_refCount++;
+
+    return source;
+}
+
+/** Releases the source, the last view closes the subscription */
+void MjpegVideoSource::release(QObject *view)
+{
+    m_targetSizes.remove(view);
+    m_refCount--;
+
+    if (m_refCount > 0)
+    {
+        return;
+    }
+
+    if (videoSources.value(m_videoUri, NULL) == this)
+    {
+        videoSources.remove(m_videoUri);
+    }
+    disconnectSocket();
+    deleteLater();  // release may be called while framesReady is emitted
+}
+
+/** An invalid size requests full resolution frames */
+void MjpegVideoSource::setTargetSize(QObject *view, const QSize &size, Qt::AspectRatioMode aspectRatioMode)
+{
+    m_targetSizes.insert(view, qMakePair(size, aspectRatioMode));
+}
+
+void MjpegVideoSource::connectSocket()
+{
+    m_context = createDefaultContext(this, 1);
+    m_context->start();
+
+    m_updateSocket = m_context->createSocket(ZMQSocket::TYP_SUB, this);
+    m_updateSocket->setLinger(0);
+    m_updateSocket->connectTo(m_videoUri);
+    m_updateSocket->subscribeTo("frames");
+
+    connect(m_updateSocket, SIGNAL(messageReceived(QList<QByteArray>)),
+         this, SLOT(updateMessageReceived(QList<QByteArray>)));
+}
+
+void MjpegVideoSource::disconnectSocket()
+{
+    if (m_updateSocket != NULL)
+    {
+        m_updateSocket->close();
+        m_updateSocket->deleteLater();
+        m_updateSocket = NULL;
+    }
+
+    if (m_context != NULL)
+    {
+        m_context->stop();
+        m_context->deleteLater();
+        m_context = NULL;
+    }
+}
+
+/** Parses a package and hands its frames to the decoder
+ *  Only one package is decoded at a time, a package received meanwhile
+ *  replaces the one waiting for decoding.
+ */
+void MjpegVideoSource::updateMessageReceived(QList<QByteArray> messageList)
+{
+    QByteArray topic;
+    QList<MjpegStreamBufferItem> items;
+    QList<QByteArray> frames;
+
+    topic = messageList.at(0);
+    m_rx.ParseFromArray(messageList.at(1).data(), messageList.at(1).size());
+
+    for (int i = 0; i < m_rx.frame_size(); ++i)
+    {
+        QDateTime dateTime;
+        QTime time;
+        MjpegStreamBufferItem streamBufferItem;
+        const pb::Package_Frame &frame = m_rx.frame(i);
+
+#ifdef QT_DEBUG
+        qDebug() << "received frame" << topic;
+        qDebug() << "timestamp: " << frame.timestamp_unix() << frame.timestamp_s() << frame.timestamp_us();
+#endif
+
+        streamBufferItem.timestamp = (double)frame.timestamp_s()*1000 +  (double)frame.timestamp_us() / 1000.0;
+
+        dateTime.setMSecsSinceEpoch((quint64)frame.timestamp_unix()*(quint64)1000);
+        dateTime = dateTime.toLocalTime();
+        time = dateTime.time();
+        streamBufferItem.time = time.addMSecs(frame.timestamp_us()/1000.0);
+        streamBufferItem.unixTimestamp = (qint64)frame.timestamp_unix()*(qint64)1000 + frame.timestamp_us()/1000;
+        streamBufferItem.displayTime = 0.0;
+
+#ifdef QT_DEBUG
+        qDebug() << "time: " << streamBufferItem.time;
+#endif
+
+        items.append(streamBufferItem);
+        frames.append(QByteArray(frame.blob().data(), frame.blob().size()));
+    }
+
+    if (items.isEmpty())
+    {
+        return;
+    }
+
+    if (m_decoding)
+    {
+        m_droppedFrames += m_pendingItems.size();   // replaced before being decoded
+        m_pendingItems = items;
+        m_pendingFrames = frames;
+        return;
+    }
+
+    startDecoding(items, frames);
+}
+
+/** Decodes at the largest size requested, full size if a view needs it */
+void MjpegVideoSource::startDecoding(const QList<MjpegStreamBufferItem> &items, const QList<QByteArray> &frames)
+{
+    MjpegFrameDecoder *decoder;
+    QList<QPair<QSize, Qt::AspectRatioMode> > targetSizes = m_targetSizes.values();
+    bool fullSize = false;
+
+    m_decoding = true;
+    m_decodingItems = items;
+
+    decoder = new MjpegFrameDecoder(this, frames);
+    for (int i = 0; i < targetSizes.size(); ++i)
+    {
+        if (!targetSizes.at(i).first.isValid())
+        {
+            fullSize = true;
+        }
+    }
+    if (!fullSize)
+    {
+        for (int i = 0; i < targetSizes.size(); ++i)
+        {
+            decoder->addTargetSize(targetSizes.at(i).first, targetSizes.at(i).second);
+        }
+    }
+    m_decoderPool->start(decoder);
+}
+
+void MjpegVideoSource::framesDecoded(const QList<QImage> &images, qint64 decodeTime)
+{
+    QList<MjpegStreamBufferItem> items = m_decodingItems;
+    QList<MjpegStreamBufferItem> decodedItems;
+    int droppedFrames;
+
+    m_decoding = false;
+    m_decodingItems.clear();
+
+    if (m_updateSocket == NULL)     // released
+    {
+        return;
+    }
+
+    if (!m_pendingItems.isEmpty())
+    {
+        startDecoding(m_pendingItems, m_pendingFrames);
+        m_pendingItems.clear();
+        m_pendingFrames.clear();
+    }
+
+    for (int i = 0; (i < items.size()) && (i < images.size()); ++i)
+    {
+        if (images.at(i).isNull())
+        {
+            m_droppedFrames++;
+            continue;
+        }
+
+        items[i].image = images.at(i);
+        decodedItems.append(items.at(i));
+    }
+
+    droppedFrames = m_droppedFrames;
+    m_droppedFrames = 0;
+
+    emit framesReady(decodedItems, decodeTime, droppedFrames);
+}
@@ -0,0 +1,105 @@
+/****************************************************************************
+**
+** Copyright (C) 2015 Alexander Rössler
+** License: LGPL version 2.1
+**
+** This file is part of QtQuickVcp.
+**
+** All rights reserved. This program and the accompanying materials
+** are made available under the terms of the GNU Lesser General Public License
+** (LGPL) version 2.1 which accompanies this distribution, and is available at
+** http://www.gnu.org/licenses/lgpl-2.1.html
+**
+** This library is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+** Lesser General Public License for more details.
+**
+** Contributors:
+** Alexander Rössler @ The Cool Tool GmbH <mail DOT aroessler AT gmail DOT com>
+**
+****************************************************************************/
+
+#ifndef MJPEGVIDEOSOURCE_H
+#define MJPEGVIDEOSOURCE_H
+
+#include <QObject>
+#include <QHash>
+#include <QImage>
+#include <QList>
+#include <QPair>
+#include <QSize>
+#include <QThreadPool>
+#include <QTime>
+#include <nzmqt/nzmqt.hpp>
+#include "package.pb.h"
+#include <google/protobuf/text_format.h>
+
+#if defined(Q_OS_IOS)
+namespace gpb = google_public::protobuf;
+#else
+namespace gpb = google::protobuf;
+#endif
+
+using namespace nzmqt;
+
+typedef struct {
+    QImage image;
+    double timestamp;
+    QTime  time;
+    qint64 unixTimestamp;   // ms since epoch, for the latency
+    double displayTime;     // ms on the stream clock of the view
+} MjpegStreamBufferItem;
+
+/** Subscription and decoder for one video service, shared by all views
+ *
+ *  Views showing the same videoUri acquire the same source, so every
+ *  frame is received and decoded once. The decoded images are implicitly
+ *  shared between the views. Each view registers its target size, frames
+ *  are decoded at the largest size any view needs. The subscription is
+ *  closed when the last view releases the source.
+ */
+class MjpegVideoSource : public QObject
+{
+    Q_OBJECT
+public:
+    static MjpegVideoSource *acquire(const QString &videoUri);
+    void release(QObject *view);
+
+    void setTargetSize(QObject *view, const QSize &size, Qt::AspectRatioMode aspectRatioMode);
+
+    QString videoUri() const
+    {
+        return m_videoUri;
+    }
+
+private:
+    explicit MjpegVideoSource(const QString &videoUri, QObject *parent = 0);
+    ~MjpegVideoSource();
+
+    QString     m_videoUri;
+    int         m_refCount;
+    ZMQContext *m_context;
+    ZMQSocket  *m_updateSocket;
+    pb::Package m_rx; // more efficient to reuse a protobuf Message
+    QThreadPool *m_decoderPool;
+    bool        m_decoding;
+    int         m_droppedFrames;    // since the last framesReady
+    QList<MjpegStreamBufferItem> m_decodingItems;
+    QList<MjpegStreamBufferItem> m_pendingItems;   // newest package received while decoding
+    QList<QByteArray> m_pendingFrames;
+    QHash<QObject*, QPair<QSize, Qt::AspectRatioMode> > m_targetSizes;
+
+    void connectSocket();
+    void disconnectSocket();
+    void startDecoding(const QList<MjpegStreamBufferItem> &items, const QList<QByteArray> &frames);
+
+private slots:
+    void updateMessageReceived(QList<QByteArray> messageList);
+    void framesDecoded(const QList<QImage> &images, qint64 decodeTime);
+
+signals:
+    void framesReady(const QList<MjpegStreamBufferItem> &items, qint64 decodeTime, int droppedFrames);
+};
+
+#endif // MJPEGVIDEOSOURCE_H
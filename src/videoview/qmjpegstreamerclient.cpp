@@ -20,6 +20,7 @@
 **
 ****************************************************************************/
 #include "qmjpegstreamerclient.h"
+#include "mjpegvideonode.h"
 
 /*!
     \qmltype MjpegStreamerClient
@@ -94,25 +95,81 @@
  *  The default value is \c{Qt::KeepAspectRatio}
  */
 
-QMjpegStreamerClient::QMjpegStreamerClient(QQuickPaintedItem *parent) :
-    QQuickPaintedItem(parent),
+/*! \qmlproperty bool MjpegStreamerClient::scaledDecoding
+
+    This property holds whether video frames larger than the item are
+    decoded directly at the displayed size. The size is in device pixels,
+    frames stay sharp on high DPI screens. Frames are always decoded on a
+    worker thread, when decoding cannot keep up older frames are dropped.
+
+    The default value is \c{true}.
+*/
+
+/*! \qmlproperty enumeration MjpegStreamerClient::framePolicy
+
+    This property holds how received frames are scheduled for display.
+
+    \list
+    \li MjpegStreamerClient.LatestFrame - the newest frame is shown right
+    away, older frames are dropped. Lowest latency.
+    \li MjpegStreamerClient.FixedDelay - frames are shown at their capture
+    time plus \l bufferDelay, smoothing out network jitter.
+    \li MjpegStreamerClient.AdaptiveDelay - like FixedDelay, but the delay
+    follows the measured jitter and is at most \l bufferDelay.
+    \endlist
+
+    The default value is \c{MjpegStreamerClient.AdaptiveDelay}.
+*/
+
+/*! \qmlproperty int MjpegStreamerClient::bufferDelay
+
+    This property holds the jitter buffer delay in ms, the maximum delay
+    for the adaptive policy.
+
+    The default value is \c{100}.
+*/
+
+/*! \qmlproperty int MjpegStreamerClient::decodedFrames
+
+    This property holds the number of frames decoded since the component
+    was set ready. \l displayedFrames and \l droppedFrames hold the number
+    of frames shown and discarded without being shown. Together with
+    \l decodeTime (average per frame in ms), \l latency (capture to display
+    in ms, requires synchronized clocks), \l jitter and \l currentDelay
+    (both in ms) these values are updated once per second.
+*/
+
+QMjpegStreamerClient::QMjpegStreamerClient(QQuickItem *parent) :
+    QQuickItem(parent),
     m_componentCompleted(false),
+    m_frameChanged(false),
     m_framerateTimer(new QTimer(this)),
     m_streamBufferTimer(new QTimer(this)),
-    m_context(NULL),
-    m_updateSocket(NULL),
+    m_source(NULL),
+    m_transitValid(false),
+    m_minTransit(0.0),
+    m_lastTransit(0.0),
+    m_decodeTimeSum(0),
+    m_decodeTimeCount(0),
     m_videoUri(""),
     m_running(false),
     m_fps(0.0),
     m_frameCount(0),
     m_timestamp(0.0),
     m_time(QTime()),
-    m_aspectRatioMode(Qt::KeepAspectRatio)
+    m_aspectRatioMode(Qt::KeepAspectRatio),
+    m_scaledDecoding(true),
+    m_framePolicy(AdaptiveDelay),
+    m_bufferDelay(100),
+    m_currentDelay(0.0),
+    m_jitter(0.0),
+    m_decodedFrames(0),
+    m_displayedFrames(0),
+    m_droppedFrames(0),
+    m_decodeTime(0.0),
+    m_latency(0.0)
 {
-    this->setRenderTarget(QQuickPaintedItem::FramebufferObject);
-    this->setPerformanceHint(QQuickPaintedItem::FastFBOResizing, true);
-    this->setAntialiasing(false);
-    this->setOpaquePainting(true);
+    this->setFlag(QQuickItem::ItemHasContents, true);
 
     connect(m_framerateTimer, SIGNAL(timeout()),
             this, SLOT(updateFramerate()));
@@ -125,7 +182,10 @@ QMjpegStreamerClient::QMjpegStreamerClient(QQuickPaintedItem *parent) :
 
 QMjpegStreamerClient::~QMjpegStreamerClient()
 {
-    disconnectSocket();
+    if (m_source != NULL)
+    {
+        m_source->release(this);
+    }
 }
 
 /** componentComplete is executed when the QML component is fully loaded */
@@ -138,20 +198,97 @@ void QMjpegStreamerClient::componentComplete()
         start();
     }
 
-    QQuickPaintedItem::componentComplete();
+    QQuickItem::componentComplete();
 }
 
-void QMjpegStreamerClient::paint(QPainter *painter)
+/** Uploads a new frame as texture, the GPU scales it to the item size
+ *  Runs on the render thread while the GUI thread is blocked.
+ */
+QSGNode *QMjpegStreamerClient::updatePaintNode(QSGNode *oldNode, UpdatePaintNodeData *updatePaintNodeData)
 {
+    Q_UNUSED(updatePaintNodeData)
+    MjpegVideoNode *node = static_cast<MjpegVideoNode*>(oldNode);
     QRect boundingRect = this->boundingRect().toRect();
 
-    // Show view finder
-    if(!m_frameImg.isNull())
+    if (m_frameImg.isNull() || boundingRect.isEmpty())
+    {
+        delete node;
+        m_frameChanged = true;  // upload again once there is a node
+        return NULL;
+    }
+
+    if (node == NULL)
+    {
+        node = new MjpegVideoNode();
+        m_frameChanged = true;
+    }
+
+    if (m_frameChanged)
+    {
+        node->setImage(window(), m_frameImg);
+        m_frameChanged = false;
+    }
+
+    QRect drawRect(QPoint(0, 0), m_frameImg.size().scaled(boundingRect.size(), m_aspectRatioMode));
+    drawRect.moveCenter(boundingRect.center());
+    node->setRect(drawRect);
+
+    return node;
+}
+
+void QMjpegStreamerClient::geometryChanged(const QRectF &newGeometry, const QRectF &oldGeometry)
+{
+    QQuickItem::geometryChanged(newGeometry, oldGeometry);
+    updateSourceTargetSize();
+    update();
+}
+
+/** Follows the window of the item, moving the window to a screen with
+ *  another pixel ratio changes the size frames are decoded at
+ */
+void QMjpegStreamerClient::itemChange(ItemChange change, const ItemChangeData &value)
+{
+    if (change == ItemSceneChange)
+    {
+        if (!m_window.isNull())
+        {
+            disconnect(m_window.data(), SIGNAL(screenChanged(QScreen*)),
+                       this, SLOT(updateSourceTargetSize()));
+        }
+
+        m_window = value.window;
+
+        if (!m_window.isNull())
+        {
+            connect(m_window.data(), SIGNAL(screenChanged(QScreen*)),
+                    this, SLOT(updateSourceTargetSize()));
+        }
+
+        updateSourceTargetSize();
+    }
+
+    QQuickItem::itemChange(change, value);
+}
+
+/** The target size is in device pixels, the item size in logical pixels */
+void QMjpegStreamerClient::updateSourceTargetSize()
+{
+    qreal pixelRatio;
+
+    if (m_source == NULL)
+    {
+        return;
+    }
+
+    pixelRatio = (window() != NULL) ? window()->devicePixelRatio() : 1.0;
+
+    if (m_scaledDecoding)
+    {
+        m_source->setTargetSize(this, QSize(qRound(width() * pixelRatio), qRound(height() * pixelRatio)), m_aspectRatioMode);
+    }
+    else
     {
-        QImage scaledImage = m_frameImg.scaled(boundingRect.size(), m_aspectRatioMode);
-        QRect drawRect(scaledImage.rect());
-        drawRect.moveCenter(boundingRect.center());
-        painter->drawImage(drawRect, scaledImage, scaledImage.rect());
+        m_source->setTargetSize(this, QSize(), m_aspectRatioMode);
     }
 }
 
@@ -182,88 +319,137 @@ void QMjpegStreamerClient::setReady(bool arg)
 
 void QMjpegStreamerClient::start()
 {
+    resetStatistics();
+    m_streamClock.start();
     m_framerateTimer->start();
-    connectSocket();
+
+    m_source = MjpegVideoSource::acquire(m_videoUri);
+    connect(m_source, SIGNAL(framesReady(QList<MjpegStreamBufferItem>,qint64,int)),
+            this, SLOT(framesReady(QList<MjpegStreamBufferItem>,qint64,int)));
+    updateSourceTargetSize();
 }
 
 void QMjpegStreamerClient::stop()
 {
     m_framerateTimer->stop();
-    disconnectSocket();
+
+    if (m_source != NULL)
+    {
+        disconnect(m_source, 0, this, 0);
+        m_source->release(this);
+        m_source = NULL;
+    }
+
+    m_streamBuffer.clear();
+    m_streamBufferTimer->stop();
 }
 
-void QMjpegStreamerClient::connectSocket()
+void QMjpegStreamerClient::resetStatistics()
 {
-    m_context = createDefaultContext(this, 1);
-    m_context->start();
+    m_transitValid = false;
+    m_minTransit = 0.0;
+    m_lastTransit = 0.0;
+    m_decodeTimeSum = 0;
+    m_decodeTimeCount = 0;
+    m_currentDelay = 0.0;
+    m_jitter = 0.0;
+    m_decodedFrames = 0;
+    m_displayedFrames = 0;
+    m_droppedFrames = 0;
+    m_decodeTime = 0.0;
+    m_latency = 0.0;
+    emit statisticsChanged();
+}
 
-    m_updateSocket = m_context->createSocket(ZMQSocket::TYP_SUB, this);
-    m_updateSocket->setLinger(0);
-    m_updateSocket->connectTo(m_videoUri);
-    m_updateSocket->subscribeTo("frames");
+void QMjpegStreamerClient::framesReady(const QList<MjpegStreamBufferItem> &items, qint64 decodeTime, int droppedFrames)
+{
+    m_droppedFrames += droppedFrames;
+    m_decodeTimeSum += decodeTime;
+    m_decodeTimeCount += qMax(1, items.size());
+    m_decodedFrames += items.size();
 
-    connect(m_updateSocket, SIGNAL(messageReceived(QList<QByteArray>)),
-         this, SLOT(updateMessageReceived(QList<QByteArray>)));
+    bufferFrames(items);
 }
 
-void QMjpegStreamerClient::disconnectSocket()
+/** Schedules decoded frames according to the frame policy
+ *
+ *  The transit time is the difference between arrival on the local stream
+ *  clock and the capture timestamp. Its minimum is the base delay of the
+ *  network, variations above it are jitter (estimated as in RFC 3550).
+ *  A frame is due at its capture timestamp plus the minimum transit plus
+ *  the buffer delay.
+ */
+void QMjpegStreamerClient::bufferFrames(const QList<StreamBufferItem> &items)
 {
-    if (m_updateSocket != NULL)
+    const int maxBufferedFrames = 100;
+    double now = (double)m_streamClock.elapsed();
+
+    if (items.isEmpty())
     {
-        m_updateSocket->close();
-        m_updateSocket->deleteLater();
-        m_updateSocket = NULL;
+        return;
     }
 
-    if (m_context != NULL)
+    if (!m_streamBuffer.isEmpty() && (items.first().timestamp <= m_streamBuffer.last().timestamp))
     {
-        m_context->stop();
-        m_context->deleteLater();
-        m_context = NULL;
+        m_droppedFrames += m_streamBuffer.size();   // the stream was restarted
+        m_streamBuffer.clear();
+        m_transitValid = false;
     }
-}
 
-void QMjpegStreamerClient::updateMessageReceived(QList<QByteArray> messageList)
-{
-    QByteArray topic;
-
-    topic = messageList.at(0);
-    m_rx.ParseFromArray(messageList.at(1).data(), messageList.at(1).size());
-
-    m_streamBuffer.clear();
-    m_streamBufferTimer->stop();
-    m_currentStreamBufferItem.timestamp = 0;
-    for (int i = 0; i < m_rx.frame_size(); ++i)
+    for (int i = 0; i < items.size(); ++i)
     {
-        pb::Package_Frame frame;
-        QByteArray data;
-        QDateTime dateTime;
-        QTime time;
-        StreamBufferItem streamBufferItem;
+        double transit = now - items.at(i).timestamp;
 
-        frame = m_rx.frame(i);
-        data = QByteArray(frame.blob().data(), frame.blob().size());
+        if (!m_transitValid)
+        {
+            m_minTransit = transit;
+            m_lastTransit = transit;
+            m_transitValid = true;
+        }
+        m_jitter += (qAbs(transit - m_lastTransit) - m_jitter) / 16.0;
+        m_lastTransit = transit;
+        m_minTransit = qMin(m_minTransit, transit);
+    }
 
-#ifdef QT_DEBUG
-        qDebug() << "received frame" << topic;
-        qDebug() << "timestamp: " << frame.timestamp_unix() << frame.timestamp_s() << frame.timestamp_us();
-#endif
+    switch (m_framePolicy)
+    {
+    case LatestFrame:
+        m_currentDelay = 0.0;
+        break;
+    case FixedDelay:
+        m_currentDelay = (double)m_bufferDelay;
+        break;
+    case AdaptiveDelay:
+        m_currentDelay = qMin((double)m_bufferDelay, 3.0 * m_jitter);
+        break;
+    }
 
-        streamBufferItem.image = QImage::fromData(data, "JPG");
-        streamBufferItem.timestamp = (double)frame.timestamp_s()*1000 +  (double)frame.timestamp_us() / 1000.0;
+    if (m_framePolicy == LatestFrame)
+    {
+        StreamBufferItem item = items.last();
 
-        dateTime.setMSecsSinceEpoch((quint64)frame.timestamp_unix()*(quint64)1000);
-        dateTime = dateTime.toLocalTime();
-        time = dateTime.time();
-        streamBufferItem.time = time.addMSecs(frame.timestamp_us()/1000.0);
+        m_droppedFrames += m_streamBuffer.size() + items.size() - 1;
+        m_streamBuffer.clear();
+        item.displayTime = now;
+        m_streamBuffer.enqueue(item);
+    }
+    else
+    {
+        for (int i = 0; i < items.size(); ++i)
+        {
+            StreamBufferItem item = items.at(i);
 
-#ifdef QT_DEBUG
-        qDebug() << "time: " << streamBufferItem.time;
-#endif
+            item.displayTime = item.timestamp + m_minTransit + m_currentDelay;
+            m_streamBuffer.enqueue(item);
+        }
 
-        m_streamBuffer.enqueue(streamBufferItem);
+        while (m_streamBuffer.size() > maxBufferedFrames)
+        {
+            m_streamBuffer.dequeue();
+            m_droppedFrames++;
+        }
     }
-    m_currentStreamBufferItem = m_streamBuffer.dequeue();
+
     updateStreamBuffer();
 }
 
@@ -273,33 +459,55 @@ void QMjpegStreamerClient::updateFramerate()
     m_frameCount = 0;
     emit fpsChanged(m_fps);
 
+    if (m_decodeTimeCount > 0)
+    {
+        m_decodeTime = (double)m_decodeTimeSum / m_decodeTimeCount / 1000.0;
+        m_decodeTimeSum = 0;
+        m_decodeTimeCount = 0;
+    }
+    emit statisticsChanged();
+
 #ifdef QT_DEBUG
     qDebug() << "fps: " << m_fps;
 #endif
 }
 
+/** Shows the newest due frame, older due frames are dropped */
 void QMjpegStreamerClient::updateStreamBuffer()
 {
-    updateStreamBufferItem();
+    double now = (double)m_streamClock.elapsed();
+    bool display = false;
 
-    if (!m_streamBuffer.isEmpty())
-    {
-        double timestamp;
-        double interval;
+    m_streamBufferTimer->stop();
 
-        timestamp = m_currentStreamBufferItem.timestamp;
+    while (!m_streamBuffer.isEmpty() && (m_streamBuffer.head().displayTime <= now))
+    {
+        if (display)
+        {
+            m_droppedFrames++;
+        }
         m_currentStreamBufferItem = m_streamBuffer.dequeue();
-        interval = m_currentStreamBufferItem.timestamp - timestamp;
+        display = true;
+    }
 
-        m_streamBufferTimer->start(qMax((int)interval, 0));
+    if (display)
+    {
+        updateStreamBufferItem();
     }
 
+    if (!m_streamBuffer.isEmpty())
+    {
+        m_streamBufferTimer->start(qMax((int)(m_streamBuffer.head().displayTime - now), 0));
+    }
 }
 
 void QMjpegStreamerClient::updateStreamBufferItem()
 {
     m_frameCount++;
+    m_displayedFrames++;
+    m_latency = (double)(QDateTime::currentMSecsSinceEpoch() - m_currentStreamBufferItem.unixTimestamp);
     m_frameImg = m_currentStreamBufferItem.image;
+    m_frameChanged = true;
     m_timestamp = m_currentStreamBufferItem.timestamp;
     m_time = m_currentStreamBufferItem.time;
 
@@ -22,27 +22,21 @@
 #ifndef MJPEGSTREAMER2_H
 #define MJPEGSTREAMER2_H
 
-#include <QQuickPaintedItem>
-#include <QPainter>
+#include <QQuickItem>
+#include <QQuickWindow>
+#include <QPointer>
+#include <QSGNode>
+#include <QImage>
 #include <QNetworkAccessManager>
 #include <QTimer>
 #include <QNetworkReply>
 #include <QElapsedTimer>
 #include <QQueue>
 #include <QTime>
-#include <nzmqt/nzmqt.hpp>
-#include "package.pb.h"
-#include <google/protobuf/text_format.h>
+#include <QDateTime>
+#include "mjpegvideosource.h"
 
-#if defined(Q_OS_IOS)
-namespace gpb = google_public::protobuf;
-#else
-namespace gpb = google::protobuf;
-#endif
-
-using namespace nzmqt;
-
-class QMjpegStreamerClient : public QQuickPaintedItem
+class QMjpegStreamerClient : public QQuickItem
 {
     Q_OBJECT
     Q_PROPERTY(QString videoUri READ videoUri WRITE setVideoUri NOTIFY videoUriChanged)
@@ -51,18 +45,30 @@ class QMjpegStreamerClient : public QQuickPaintedItem
     Q_PROPERTY(double timestamp READ timestamp NOTIFY timestampChanged)
     Q_PROPERTY(QTime time READ time NOTIFY timeChanged)
     Q_PROPERTY(Qt::AspectRatioMode aspectRatioMode READ aspectRatioMode WRITE setAspectRatioMode NOTIFY aspectRatioModeChanged)
+    Q_PROPERTY(bool scaledDecoding READ scaledDecoding WRITE setScaledDecoding NOTIFY scaledDecodingChanged)
+    Q_PROPERTY(FramePolicy framePolicy READ framePolicy WRITE setFramePolicy NOTIFY framePolicyChanged)
+    Q_PROPERTY(int bufferDelay READ bufferDelay WRITE setBufferDelay NOTIFY bufferDelayChanged)
+    Q_PROPERTY(double currentDelay READ currentDelay NOTIFY statisticsChanged)
+    Q_PROPERTY(double jitter READ jitter NOTIFY statisticsChanged)
+    Q_PROPERTY(int decodedFrames READ decodedFrames NOTIFY statisticsChanged)
+    Q_PROPERTY(int displayedFrames READ displayedFrames NOTIFY statisticsChanged)
+    Q_PROPERTY(int droppedFrames READ droppedFrames NOTIFY statisticsChanged)
+    Q_PROPERTY(double decodeTime READ decodeTime NOTIFY statisticsChanged)
+    Q_PROPERTY(double latency READ latency NOTIFY statisticsChanged)
+    Q_ENUMS(FramePolicy)
 
 public:
-    typedef struct {
-        QImage image;
-        double timestamp;
-        QTime  time;
-    } StreamBufferItem;
+    typedef MjpegStreamBufferItem StreamBufferItem;
 
-    explicit QMjpegStreamerClient(QQuickPaintedItem *parent = 0);
+    enum FramePolicy {
+        LatestFrame = 0,    // lowest latency, shows the newest frame right away
+        FixedDelay = 1,     // jitter buffer delaying every frame by bufferDelay
+        AdaptiveDelay = 2   // jitter buffer sized from the measured jitter, at most bufferDelay
+    };
+
+    explicit QMjpegStreamerClient(QQuickItem *parent = 0);
     ~QMjpegStreamerClient();
     virtual void componentComplete();
-    void paint(QPainter* painter);
 
     QString videoUri() const
     {
@@ -94,6 +100,56 @@ public:
         return m_aspectRatioMode;
     }
 
+    bool scaledDecoding() const
+    {
+        return m_scaledDecoding;
+    }
+
+    FramePolicy framePolicy() const
+    {
+        return m_framePolicy;
+    }
+
+    int bufferDelay() const
+    {
+        return m_bufferDelay;
+    }
+
+    double currentDelay() const
+    {
+        return m_currentDelay;
+    }
+
+    double jitter() const
+    {
+        return m_jitter;
+    }
+
+    int decodedFrames() const
+    {
+        return m_decodedFrames;
+    }
+
+    int displayedFrames() const
+    {
+        return m_displayedFrames;
+    }
+
+    int droppedFrames() const
+    {
+        return m_droppedFrames;
+    }
+
+    double decodeTime() const
+    {
+        return m_decodeTime;
+    }
+
+    double latency() const
+    {
+        return m_latency;
+    }
+
 signals:
     void videoUriChanged(QString arg);
     void readyChanged(bool arg);
@@ -102,6 +158,10 @@ signals:
     void timeChanged(QTime arg);
 
     void aspectRatioModeChanged(Qt::AspectRatioMode arg);
+    void scaledDecodingChanged(bool arg);
+    void framePolicyChanged(FramePolicy arg);
+    void bufferDelayChanged(int arg);
+    void statisticsChanged();
 
 public slots:
 
@@ -122,18 +182,60 @@ void setAspectRatioMode(Qt::AspectRatioMode arg)
 
     m_aspectRatioMode = arg;
     emit aspectRatioModeChanged(arg);
+    setClip(arg == Qt::KeepAspectRatioByExpanding);    // the frame is larger than the item
+    updateSourceTargetSize();
+    update();
+}
+
+void setScaledDecoding(bool arg)
+{
+    if (m_scaledDecoding == arg)
+        return;
+
+    m_scaledDecoding = arg;
+    emit scaledDecodingChanged(arg);
+    updateSourceTargetSize();
 }
 
+void setFramePolicy(FramePolicy arg)
+{
+    if (m_framePolicy == arg)
+        return;
+
+    m_framePolicy = arg;
+    emit framePolicyChanged(arg);
+}
+
+void setBufferDelay(int arg)
+{
+    if (m_bufferDelay == arg)
+        return;
+
+    m_bufferDelay = arg;
+    emit bufferDelayChanged(arg);
+}
+
+protected:
+    QSGNode *updatePaintNode(QSGNode *oldNode, UpdatePaintNodeData *updatePaintNodeData);
+    void geometryChanged(const QRectF &newGeometry, const QRectF &oldGeometry);
+    void itemChange(ItemChange change, const ItemChangeData &value);
+
 private:
     bool        m_componentCompleted;
+    bool        m_frameChanged;     // the texture needs to be updated
     StreamBufferItem m_currentStreamBufferItem;
     QQueue<StreamBufferItem> m_streamBuffer;
     QImage      m_frameImg;
     QTimer     *m_framerateTimer;
     QTimer     *m_streamBufferTimer;
-    ZMQContext *m_context;
-    ZMQSocket  *m_updateSocket;
-    pb::Package m_rx; // more efficient to reuse a protobuf Message
+    MjpegVideoSource *m_source;
+    QPointer<QQuickWindow> m_window; // window whose screen determines the pixel ratio
+    QElapsedTimer m_streamClock;
+    bool        m_transitValid;
+    double      m_minTransit;       // smallest difference between arrival and frame timestamp
+    double      m_lastTransit;
+    qint64      m_decodeTimeSum;    // us, since the last statistics update
+    int         m_decodeTimeCount;
 
 
     QString m_videoUri;
@@ -143,17 +245,29 @@ private:
     double  m_timestamp;
     QTime   m_time;
     Qt::AspectRatioMode m_aspectRatioMode;
+    bool    m_scaledDecoding;
+    FramePolicy m_framePolicy;
+    int     m_bufferDelay;
+    double  m_currentDelay;
+    double  m_jitter;
+    int     m_decodedFrames;
+    int     m_displayedFrames;
+    int     m_droppedFrames;
+    double  m_decodeTime;
+    double  m_latency;
+
+    void bufferFrames(const QList<StreamBufferItem> &items);
+    void resetStatistics();
 
 private slots:
     void start();
     void stop();
-    void connectSocket();
-    void disconnectSocket();
-    void updateMessageReceived(QList<QByteArray> messageList);
+    void framesReady(const QList<MjpegStreamBufferItem> &items, qint64 decodeTime, int droppedFrames);
 
     void updateFramerate();
     void updateStreamBuffer();
     void updateStreamBufferItem();
+    void updateSourceTargetSize();
 };
 
 #endif // MJPEGSTREAMER2_H
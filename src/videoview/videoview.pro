@@ -14,11 +14,17 @@ include(../protobuf.pri)
 # Input
 SOURCES += \
     plugin.cpp \
-    qmjpegstreamerclient.cpp
+    qmjpegstreamerclient.cpp \
+    mjpegframedecoder.cpp \
+    mjpegvideonode.cpp \
+    mjpegvideosource.cpp
 
 HEADERS += \
     plugin.h \
-    qmjpegstreamerclient.h
+    qmjpegstreamerclient.h \
+    mjpegframedecoder.h \
+    mjpegvideonode.h \
+    mjpegvideosource.h
 
 QML_INFRA_FILES = \
     qmldir
@@ -0,0 +1,14 @@
+TEMPLATE = app
+TARGET = applicationconfigbenchmark
+
+include(../common/benchmark.pri)
+include(../common/application.pri)
+
+SOURCES += \
+    main.cpp \
+    fakeconfigserver.cpp \
+    applicationconfigbenchmark.cpp
+
+HEADERS += \
+    fakeconfigserver.h \
+    applicationconfigbenchmark.h
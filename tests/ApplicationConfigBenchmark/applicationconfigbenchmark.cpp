@@ -0,0 +1,227 @@
+/****************************************************************************
+**
+** Copyright (C) 2015 Alexander Rössler
+** License: LGPL version 2.1
+**
+** This file is part of QtQuickVcp.
+**
+** All rights reserved. This program and the accompanying materials
+** are made available under the terms of the GNU Lesser General Public License
+** (LGPL) version 2.1 which accompanies this distribution, and is available at
+** http://www.gnu.org/licenses/lgpl-2.1.html
+**
+** This library is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+** Lesser General Public License for more details.
+**
+** Contributors:
+** Alexander Rössler @ The Cool Tool GmbH <mail DOT aroessler AT gmail DOT com>
+**
+****************************************************************************/
+
+#include "applicationconfigbenchmark.h"
+#include <QDir>
+#include <QTimer>
+
+static const char *applicationName = "benchmark";
+
+ApplicationConfigBenchmark::ApplicationConfigBenchmark(QObject *parent) :
+    AbstractBenchmark(parent),
+    m_files(50),
+    m_fileSize(20000),
+    m_server(new FakeConfigServer(this)),
+    m_config(NULL),
+    m_phase(Connecting),
+    m_writeTime(0),
+    m_reuseTime(0),
+    m_extractedFiles(0),
+    m_writePassed(false),
+    m_reusePassed(false),
+    m_corruptPassed(false)
+{
+}
+
+ApplicationConfigBenchmark::~ApplicationConfigBenchmark()
+{
+    delete m_config;    // removes the files of the selected application
+}
+
+bool ApplicationConfigBenchmark::start()
+{
+    QString configUri = "tcp://127.0.0.1:5631";
+
+    if (!m_cacheDir.isValid())
+    {
+        m_errorString = "not able to create the cache directory";
+        return false;
+    }
+
+    m_server->setApplication(applicationName, m_files, m_fileSize);
+    if (!m_server->start(configUri))
+    {
+        m_errorString = m_server->errorString();
+        return false;
+    }
+
+    m_config = new QApplicationConfig();
+    m_config->setConfigUri(configUri);
+    m_config->setCacheEnabled(true);
+    m_config->setCachePath(m_cacheDir.path());
+    connect(m_config, SIGNAL(connectedChanged(bool)),
+            this, SLOT(connectedChanged(bool)));
+    connect(m_config->selectedConfig(), SIGNAL(loadedChanged(bool)),
+            this, SLOT(loadedChanged(bool)));
+    connect(m_config->selectedConfig(), SIGNAL(loadingChanged(bool)),
+            this, SLOT(loadingChanged(bool)));
+    connect(m_config->selectedConfig(), SIGNAL(progressChanged(double)),
+            this, SLOT(progressChanged(double)));
+
+    m_config->componentComplete();
+    m_config->setReady(true);
+    QTimer::singleShot(10000, this, SLOT(timeout()));
+
+    return true;
+}
+
+bool ApplicationConfigBenchmark::passed() const
+{
+    return m_errorString.isEmpty() && m_writePassed && m_reusePassed && m_corruptPassed;
+}
+
+int ApplicationConfigBenchmark::bundleCount() const
+{
+    QDir bundleDir(QDir(m_cacheDir.path()).filePath("bundles"));
+
+    return bundleDir.entryList(QDir::Dirs | QDir::NoDotAndDotDot).size();
+}
+
+int ApplicationConfigBenchmark::stagingCount() const
+{
+    QDir bundleDir(QDir(m_cacheDir.path()).filePath("bundles"));
+
+    return bundleDir.entryList(QStringList() << ".staging-*", QDir::Dirs | QDir::Hidden).size();
+}
+
+void ApplicationConfigBenchmark::connectedChanged(bool connected)
+{
+    if (!connected || (m_phase != Connecting))
+    {
+        return;
+    }
+
+    m_phase = Write;
+    selectNext();
+}
+
+/** The next selection is started from the event loop, the config is still
+ *  updating the selected item when loaded changes
+ */
+void ApplicationConfigBenchmark::loadedChanged(bool loaded)
+{
+    if (!loaded)
+    {
+        return;
+    }
+
+    if (m_phase == Write)
+    {
+        m_writeTime = m_elapsedTimer.elapsed();
+        m_writtenFiles = m_config->selectedConfig()->files();
+        m_writePassed = (m_writtenFiles.size() == (m_files + 2)) && (m_extractedFiles > 0)
+                        && (bundleCount() == 1) && (stagingCount() == 0);
+        m_phase = Reuse;
+        QTimer::singleShot(0, this, SLOT(selectNext()));
+    }
+    else if (m_phase == Reuse)  // same files received, nothing may be extracted
+    {
+        m_reuseTime = m_elapsedTimer.elapsed();
+        m_reusePassed = (m_config->selectedConfig()->files() == m_writtenFiles) && (m_extractedFiles == 0)
+                        && (bundleCount() == 1) && (stagingCount() == 0);
+        m_phase = Corrupt;
+        m_server->setCorrupt(true);
+        QTimer::singleShot(0, this, SLOT(selectNext()));
+    }
+    else if (m_phase == Corrupt)    // an incomplete application must not load
+    {
+        m_corruptPassed = false;
+        finish();
+    }
+}
+
+void ApplicationConfigBenchmark::loadingChanged(bool loading)
+{
+    if (loading || (m_phase != Corrupt) || m_config->selectedConfig()->isLoaded())
+    {
+        return;
+    }
+
+    m_corruptPassed = (bundleCount() == 1) && (stagingCount() == 0);
+    finish();
+}
+
+/** Every extracted file except the last one reports a partial progress */
+void ApplicationConfigBenchmark::progressChanged(double progress)
+{
+    if ((progress > 0.0) && (progress < 1.0))
+    {
+        m_extractedFiles++;
+    }
+}
+
+void ApplicationConfigBenchmark::selectNext()
+{
+    m_extractedFiles = 0;
+    m_elapsedTimer.start();
+    m_config->selectConfig(applicationName);
+}
+
+void ApplicationConfigBenchmark::timeout()
+{
+    if (m_phase != Done)
+    {
+        m_errorString = "timeout while loading the application";
+        finish();
+    }
+}
+
+void ApplicationConfigBenchmark::finish()
+{
+    if (m_phase == Done)
+    {
+        return;
+    }
+    m_phase = Done;
+
+    m_config->unselectConfig();
+    m_config->setReady(false);
+    m_server->stop();
+
+    emit finished();
+}
+
+QJsonObject ApplicationConfigBenchmark::results() const
+{
+    QJsonObject results;
+
+    results["files"] = m_files;
+    results["file_size"] = m_fileSize;
+    results["write_ms"] = (double)m_writeTime;
+    results["reuse_ms"] = (double)m_reuseTime;
+    results["write_passed"] = m_writePassed;
+    results["reuse_passed"] = m_reusePassed;
+    results["corrupt_passed"] = m_corruptPassed;
+    results["passed"] = passed();
+
+    return results;
+}
+
+QStringList ApplicationConfigBenchmark::resultKeys() const
+{
+    QStringList keys;
+
+    keys << "files" << "file_size" << "write_ms" << "reuse_ms" << "write_passed"
+         << "reuse_passed" << "corrupt_passed" << "passed";
+
+    return keys;
+}
@@ -0,0 +1,103 @@
+/****************************************************************************
+**
+** Copyright (C) 2015 Alexander Rössler
+** License: LGPL version 2.1
+**
+** This file is part of QtQuickVcp.
+**
+** All rights reserved. This program and the accompanying materials
+** are made available under the terms of the GNU Lesser General Public License
+** (LGPL) version 2.1 which accompanies this distribution, and is available at
+** http://www.gnu.org/licenses/lgpl-2.1.html
+**
+** This library is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+** Lesser General Public License for more details.
+**
+** Contributors:
+** Alexander Rössler @ The Cool Tool GmbH <mail DOT aroessler AT gmail DOT com>
+**
+****************************************************************************/
+
+#ifndef APPLICATIONCONFIGBENCHMARK_H
+#define APPLICATIONCONFIGBENCHMARK_H
+
+#include "abstractbenchmark.h"
+#include <QElapsedTimer>
+#include <QTemporaryDir>
+#include <QStringList>
+#include <QJsonObject>
+#include "qapplicationconfig.h"
+#include "fakeconfigserver.h"
+
+/** Loads an application through a QApplicationConfig with cache enabled
+ *
+ *  The application is selected three times: into an empty cache, again
+ *  with unchanged files and once more with a corrupt file. The server
+ *  transfers all files every time. The second load has to reuse the
+ *  bundle of the first one without extracting a single file, the failed
+ *  load must not leave a staging directory behind. The load times of the
+ *  first two selections show what skipping the local rewrite saves.
+ */
+class ApplicationConfigBenchmark : public AbstractBenchmark
+{
+    Q_OBJECT
+public:
+    explicit ApplicationConfigBenchmark(QObject *parent = 0);
+    ~ApplicationConfigBenchmark();
+
+    void setFiles(int files)
+    {
+        m_files = files;
+    }
+
+    void setFileSize(int fileSize)
+    {
+        m_fileSize = fileSize;
+    }
+
+    bool start();
+    bool passed() const;
+
+    QJsonObject results() const;
+    QStringList resultKeys() const;
+
+private:
+    enum Phase {
+        Connecting,
+        Write,
+        Reuse,
+        Corrupt,
+        Done
+    };
+
+    int         m_files;
+    int         m_fileSize;
+    FakeConfigServer    *m_server;
+    QApplicationConfig  *m_config;
+    QTemporaryDir       m_cacheDir;
+    Phase               m_phase;
+    QElapsedTimer       m_elapsedTimer;
+    QStringList         m_writtenFiles;
+    qint64              m_writeTime;
+    qint64              m_reuseTime;
+    int                 m_extractedFiles;   // files extracted during the current selection
+    bool                m_writePassed;
+    bool                m_reusePassed;
+    bool                m_corruptPassed;
+
+    int bundleCount() const;
+    int stagingCount() const;
+
+private slots:
+    void connectedChanged(bool connected);
+    void loadedChanged(bool loaded);
+    void loadingChanged(bool loading);
+    void progressChanged(double progress);
+    void selectNext();
+    void timeout();
+    void finish();
+};
+
+#endif // APPLICATIONCONFIGBENCHMARK_H
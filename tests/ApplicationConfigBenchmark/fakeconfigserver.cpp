@@ -0,0 +1,116 @@
+/****************************************************************************
+**
+** Copyright (C) 2015 Alexander Rössler
+** License: LGPL version 2.1
+**
+** This file is part of QtQuickVcp.
+**
+** All rights reserved. This program and the accompanying materials
+** are made available under the terms of the GNU Lesser General Public License
+** (LGPL) version 2.1 which accompanies this distribution, and is available at
+** http://www.gnu.org/licenses/lgpl-2.1.html
+**
+** This library is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+** Lesser General Public License for more details.
+**
+** Contributors:
+** Alexander Rössler @ The Cool Tool GmbH <mail DOT aroessler AT gmail DOT com>
+**
+****************************************************************************/
+
+#include "fakeconfigserver.h"
+
+FakeConfigServer::FakeConfigServer(QObject *parent) :
+    AbstractFakeServer(parent),
+    m_socket(NULL),
+    m_name("benchmark"),
+    m_files(50),
+    m_fileSize(20000),
+    m_corrupt(false)
+{
+}
+
+FakeConfigServer::~FakeConfigServer()
+{
+    stop();
+}
+
+bool FakeConfigServer::start(const QString &uri)
+{
+    stop();
+
+    m_socket = bindSocket(ZMQSocket::TYP_ROUTER, uri, SLOT(messageReceived(QList<QByteArray>)));
+    if (m_socket == NULL)
+    {
+        stop();
+        return false;
+    }
+
+    return true;
+}
+
+void FakeConfigServer::stop()
+{
+    closeSockets();
+    m_socket = NULL;
+}
+
+void FakeConfigServer::addFile(pb::Application *app, const QString &name, const QByteArray &content)
+{
+    pb::File *file = app->add_file();
+    QByteArray blob = qCompress(content);
+
+    file->set_name(name.toStdString());
+    file->set_encoding(pb::ZLIB);
+    file->set_blob(blob.constData(), blob.size());
+}
+
+/** Router sockets prepend the peer identity */
+void FakeConfigServer::messageReceived(const QList<QByteArray> &messageList)
+{
+    QByteArray identity = messageList.at(0);
+    pb::Application *app;
+
+    m_rx.ParseFromArray(messageList.last().data(), messageList.last().size());
+
+    if (m_rx.type() == pb::MT_LIST_APPLICATIONS)
+    {
+        app = m_tx.add_app();
+        app->set_name(m_name.toStdString());
+        app->set_description("benchmark application");
+        app->set_type(pb::QT5_QML);
+        sendContainer(m_socket, QList<QByteArray>() << identity, pb::MT_DESCRIBE_APPLICATION);
+    }
+    else if (m_rx.type() == pb::MT_RETRIEVE_APPLICATION)
+    {
+        app = m_tx.add_app();
+        app->set_name(m_name.toStdString());
+        app->set_description("benchmark application");
+        app->set_type(pb::QT5_QML);
+
+        addFile(app, "description.ini", QString("[Default]\nname=%1\ndescription=benchmark application\n")
+                                        .arg(m_name).toUtf8());
+        addFile(app, "main.qml", QByteArray("import QtQuick 2.0\nItem {}\n"));
+        for (int i = 0; i < m_files; ++i)
+        {
+            QByteArray content = QString("// file %1\n").arg(i).toUtf8();
+            content.append(QByteArray(qMax(0, m_fileSize - content.size()), 'x'));
+            addFile(app, QString("file%1.js").arg(i), content);
+        }
+
+        if (m_corrupt)  // keep the size header, break the zlib stream
+        {
+            pb::File *file = app->mutable_file(app->file_size() - 1);
+            std::string blob = file->blob();
+            for (size_t i = 4; i < blob.size(); ++i)
+            {
+                blob[i] = (char)0xff;
+            }
+            file->set_blob(blob);
+        }
+
+        sendContainer(m_socket, QList<QByteArray>() << identity, pb::MT_APPLICATION_DETAIL);
+    }
+}
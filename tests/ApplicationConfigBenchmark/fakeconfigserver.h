@@ -0,0 +1,69 @@
+/****************************************************************************
+**
+** Copyright (C) 2015 Alexander Rössler
+** License: LGPL version 2.1
+**
+** This file is part of QtQuickVcp.
+**
+** All rights reserved. This program and the accompanying materials
+** are made available under the terms of the GNU Lesser General Public License
+** (LGPL) version 2.1 which accompanies this distribution, and is available at
+** http://www.gnu.org/licenses/lgpl-2.1.html
+**
+** This library is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+** Lesser General Public License for more details.
+**
+** Contributors:
+** Alexander Rössler @ The Cool Tool GmbH <mail DOT aroessler AT gmail DOT com>
+**
+****************************************************************************/
+
+#ifndef FAKECONFIGSERVER_H
+#define FAKECONFIGSERVER_H
+
+#include "abstractfakeserver.h"
+
+/** Local stand-in for the config service of Machinekit
+ *
+ *  Describes a single Qt5 QML application and sends its files on request,
+ *  compressed with zlib like the config server does. With corrupt set,
+ *  one file is sent with a zlib blob that cannot be decompressed.
+ */
+class FakeConfigServer : public AbstractFakeServer
+{
+    Q_OBJECT
+public:
+    explicit FakeConfigServer(QObject *parent = 0);
+    ~FakeConfigServer();
+
+    bool start(const QString &uri);
+    void stop();
+
+    void setApplication(const QString &name, int files, int fileSize)
+    {
+        m_name = name;
+        m_files = files;
+        m_fileSize = fileSize;
+    }
+
+    void setCorrupt(bool corrupt)
+    {
+        m_corrupt = corrupt;
+    }
+
+private:
+    ZMQSocket           *m_socket;
+    QString             m_name;
+    int                 m_files;
+    int                 m_fileSize;
+    bool                m_corrupt;
+
+    void addFile(pb::Application *app, const QString &name, const QByteArray &content);
+
+private slots:
+    void messageReceived(const QList<QByteArray> &messageList);
+};
+
+#endif // FAKECONFIGSERVER_H
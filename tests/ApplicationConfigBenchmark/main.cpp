@@ -0,0 +1,32 @@
+#include <QGuiApplication>
+#include <QCommandLineParser>
+#include "applicationconfigbenchmark.h"
+
+int main(int argc, char *argv[])
+{
+    if (qgetenv("QT_QPA_PLATFORM").isEmpty())   // ApplicationConfig is a QQuickItem, no display is needed
+    {
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    }
+
+    QGuiApplication app(argc, argv);
+    QCoreApplication::setApplicationName("applicationconfigbenchmark");
+
+    GOOGLE_PROTOBUF_VERIFY_VERSION;
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Application config cache benchmark against a local fake config server");
+    parser.addHelpOption();
+    QCommandLineOption filesOption(QStringList() << "n" << "files", "Number of application files.", "files", "50");
+    QCommandLineOption sizeOption(QStringList() << "s" << "size", "Size of each file in bytes.", "bytes", "20000");
+    parser.addOption(filesOption);
+    parser.addOption(sizeOption);
+    AbstractBenchmark::addOutputOptions(parser);
+    parser.process(app);
+
+    ApplicationConfigBenchmark benchmark;
+    benchmark.setFiles(qMax(1, parser.value(filesOption).toInt()));
+    benchmark.setFileSize(qMax(1, parser.value(sizeOption).toInt()));
+
+    return benchmark.exec(app, parser);
+}
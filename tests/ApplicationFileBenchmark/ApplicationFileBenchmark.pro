@@ -0,0 +1,14 @@
+TEMPLATE = app
+TARGET = applicationfilebenchmark
+
+include(../common/benchmark.pri)
+include(../common/application.pri)
+
+SOURCES += \
+    main.cpp \
+    fakeftpserver.cpp \
+    applicationfilebenchmark.cpp
+
+HEADERS += \
+    fakeftpserver.h \
+    applicationfilebenchmark.h
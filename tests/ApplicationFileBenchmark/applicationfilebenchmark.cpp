@@ -0,0 +1,291 @@
+/****************************************************************************
+**
+** Copyright (C) 2015 Alexander Rössler
+** License: LGPL version 2.1
+**
+** This file is part of QtQuickVcp.
+**
+** All rights reserved. This program and the accompanying materials
+** are made available under the terms of the GNU Lesser General Public License
+** (LGPL) version 2.1 which accompanies this distribution, and is available at
+** http://www.gnu.org/licenses/lgpl-2.1.html
+**
+** This library is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+** Lesser General Public License for more details.
+**
+** Contributors:
+** Alexander Rössler @ The Cool Tool GmbH <mail DOT aroessler AT gmail DOT com>
+**
+****************************************************************************/
+
+#include "applicationfilebenchmark.h"
+#include <QDir>
+#include <QFile>
+#include <QUrl>
+#include <QTimer>
+#include <QStandardPaths>
+
+static const char *fileName = "benchmark.ngc";
+static const quint16 serverPort = 5641;
+
+ApplicationFileBenchmark::ApplicationFileBenchmark(QObject *parent) :
+    AbstractBenchmark(parent),
+    m_fileSize(4000000),
+    m_server(new FakeFtpServer(this)),
+    m_file(NULL),
+    m_phase(Fallback),
+    m_fallbackTime(0),
+    m_resumeTime(0),
+    m_compressedTime(0),
+    m_resumedBytes(0),
+    m_compressedBytes(0),
+    m_fallbackPassed(false),
+    m_resumePassed(false),
+    m_compressedPassed(false)
+{
+}
+
+ApplicationFileBenchmark::~ApplicationFileBenchmark()
+{
+    delete m_file;
+}
+
+bool ApplicationFileBenchmark::start()
+{
+    if (!m_localDir.isValid() || !writeLocalFile())
+    {
+        m_errorString = "not able to create the local file";
+        return false;
+    }
+
+    // uploads interrupted by earlier runs must not be resumed
+    QFile::remove(QDir(QStandardPaths::writableLocation(QStandardPaths::CacheLocation)).filePath("interruptedUploads.json"));
+
+    if (!m_server->start(serverPort))
+    {
+        m_errorString = m_server->errorString();
+        return false;
+    }
+
+    if (!createFile())
+    {
+        return false;
+    }
+
+    QTimer::singleShot(30000, this, SLOT(timeout()));
+    startNextPhase();
+
+    return true;
+}
+
+bool ApplicationFileBenchmark::passed() const
+{
+    return m_errorString.isEmpty() && m_fallbackPassed && m_resumePassed && m_compressedPassed;
+}
+
+/** G-code compresses well, like the files uploaded from a user interface */
+bool ApplicationFileBenchmark::writeLocalFile()
+{
+    QFile file(QDir(m_localDir.path()).filePath(fileName));
+    int line = 0;
+
+    m_content.clear();
+    m_content.reserve(m_fileSize + 64);
+    while (m_content.size() < m_fileSize)
+    {
+        m_content.append(QString("G1 X%1 Y%2 F1200\n")
+                         .arg((line % 500) * 0.1, 0, 'f', 1)
+                         .arg((line / 500) * 0.1, 0, 'f', 1).toLatin1());
+        line++;
+    }
+    m_content.truncate(m_fileSize);
+
+    if (!file.open(QIODevice::WriteOnly))
+    {
+        return false;
+    }
+
+    return (file.write(m_content) == m_content.size());
+}
+
+bool ApplicationFileBenchmark::createFile()
+{
+    m_file = new QApplicationFile();
+    m_file->setUri(QString("ftp://127.0.0.1:%1").arg(serverPort));
+    m_file->setLocalFilePath(QUrl::fromLocalFile(QDir(m_localDir.path()).filePath(fileName)).toString());
+    m_file->setRemotePath("file:///");
+    connect(m_file, SIGNAL(uploadFinished()),
+            this, SLOT(uploadFinished()));
+    connect(m_file, SIGNAL(errorStringChanged(QString)),
+            this, SLOT(errorStringChanged(QString)));
+    m_file->setReady(true);
+
+    if (!m_file->networkReady())
+    {
+        m_errorString = "network is not accessible";
+        return false;
+    }
+
+    return true;
+}
+
+void ApplicationFileBenchmark::startUpload()
+{
+    m_elapsedTimer.start();
+    m_file->startUpload();
+}
+
+void ApplicationFileBenchmark::uploadFinished()
+{
+    bool contentPassed = (m_server->file(fileName) == m_content);
+
+    if (m_phase == Fallback)
+    {
+        m_fallbackTime = m_elapsedTimer.elapsed();
+        m_fallbackPassed = contentPassed && (m_server->commandCount("MODE") == 1)
+                           && (m_server->commandCount("XSHA1") == 1);
+        m_phase = FallbackRepeated;
+        QTimer::singleShot(0, this, SLOT(startNextPhase()));
+    }
+    else if (m_phase == FallbackRepeated)   // rejected commands are not sent again
+    {
+        m_fallbackPassed = m_fallbackPassed && contentPassed && (m_server->commandCount("MODE") == 1)
+                           && (m_server->commandCount("XSHA1") == 1);
+        m_phase = Interrupted;
+        QTimer::singleShot(0, this, SLOT(startNextPhase()));
+    }
+    else if (m_phase == Interrupted)    // the server should have cut the upload off
+    {
+        m_resumePassed = false;
+        finish();
+    }
+    else if (m_phase == Resumed)
+    {
+        m_resumeTime = m_elapsedTimer.elapsed();
+        m_resumedBytes = m_server->bytesReceived();
+        m_resumePassed = contentPassed && (m_server->restOffset() == (m_fileSize / 2))
+                         && (m_resumedBytes == (m_fileSize - (m_fileSize / 2)))
+                         && (m_server->commandCount("XSHA1") == 2);
+        m_phase = Compressed;
+        QTimer::singleShot(0, this, SLOT(startNextPhase()));
+    }
+    else if (m_phase == Compressed)
+    {
+        m_compressedTime = m_elapsedTimer.elapsed();
+        m_compressedBytes = m_server->bytesReceived();
+        m_compressedPassed = contentPassed && (m_compressedBytes < m_fileSize);
+        finish();
+    }
+}
+
+void ApplicationFileBenchmark::errorStringChanged(const QString &errorString)
+{
+    if (errorString.isEmpty() || (m_phase == Done))
+    {
+        return;
+    }
+
+    if (m_phase == Interrupted)
+    {
+        m_phase = Resumed;
+        QTimer::singleShot(0, this, SLOT(startNextPhase()));
+        return;
+    }
+
+    m_errorString = "upload failed: " + errorString;
+    finish();
+}
+
+/** The uploads are started from the event loop, QApplicationFile is still
+ *  finishing the previous operation when it reports the result
+ */
+void ApplicationFileBenchmark::startNextPhase()
+{
+    switch (m_phase)
+    {
+    case Fallback:
+        m_server->setChecksumSupported(false);
+        m_server->setCompressionSupported(false);
+        m_file->setCompressUploads(true);
+        startUpload();
+        break;
+    case FallbackRepeated:
+        startUpload();
+        break;
+    case Interrupted:
+        m_server->setChecksumSupported(true);
+        m_server->setCompressionSupported(true);
+        m_server->setInterruptAfter(m_fileSize / 2);
+        m_file->setCompressUploads(false);
+        startUpload();
+        break;
+    case Resumed:   // a new instance only knows the persisted upload state
+        delete m_file;
+        m_file = NULL;
+        if (!createFile())
+        {
+            finish();
+            return;
+        }
+        startUpload();
+        break;
+    case Compressed:
+        m_file->setCompressUploads(true);
+        startUpload();
+        break;
+    default:
+        break;
+    }
+}
+
+void ApplicationFileBenchmark::timeout()
+{
+    if (m_phase != Done)
+    {
+        m_errorString = "timeout while uploading the file";
+        finish();
+    }
+}
+
+void ApplicationFileBenchmark::finish()
+{
+    if (m_phase == Done)
+    {
+        return;
+    }
+    m_phase = Done;
+
+    m_server->stop();
+
+    emit finished();
+}
+
+QJsonObject ApplicationFileBenchmark::results() const
+{
+    QJsonObject results;
+
+    results["file_size"] = m_fileSize;
+    results["fallback_ms"] = (double)m_fallbackTime;
+    results["resume_ms"] = (double)m_resumeTime;
+    results["resumed_bytes"] = (double)m_resumedBytes;
+    results["compressed_ms"] = (double)m_compressedTime;
+    results["compressed_bytes"] = (double)m_compressedBytes;
+    results["fallback_passed"] = m_fallbackPassed;
+    results["resume_passed"] = m_resumePassed;
+    results["compressed_passed"] = m_compressedPassed;
+    results["passed"] = passed();
+
+    return results;
+}
+
+QStringList ApplicationFileBenchmark::resultKeys() const
+{
+    QStringList keys;
+
+    keys << "file_size" << "fallback_ms" << "resume_ms" << "resumed_bytes" << "compressed_ms"
+         << "compressed_bytes" << "fallback_passed" << "resume_passed" << "compressed_passed" << "passed";
+
+    return keys;
+}
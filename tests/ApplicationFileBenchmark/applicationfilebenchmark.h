@@ -0,0 +1,98 @@
+/****************************************************************************
+**
+** Copyright (C) 2015 Alexander Rössler
+** License: LGPL version 2.1
+**
+** This file is part of QtQuickVcp.
+**
+** All rights reserved. This program and the accompanying materials
+** are made available under the terms of the GNU Lesser General Public License
+** (LGPL) version 2.1 which accompanies this distribution, and is available at
+** http://www.gnu.org/licenses/lgpl-2.1.html
+**
+** This library is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+** Lesser General Public License for more details.
+**
+** Contributors:
+** Alexander Rössler @ The Cool Tool GmbH <mail DOT aroessler AT gmail DOT com>
+**
+****************************************************************************/
+
+#ifndef APPLICATIONFILEBENCHMARK_H
+#define APPLICATIONFILEBENCHMARK_H
+
+#include "abstractbenchmark.h"
+#include <QElapsedTimer>
+#include <QTemporaryDir>
+#include <QStringList>
+#include <QJsonObject>
+#include "qapplicationfile.h"
+#include "fakeftpserver.h"
+
+/** Uploads a G-code file through QApplicationFile to a local FTP server
+ *
+ *  The file is uploaded twice to a server without XSHA1 and MODE Z, both
+ *  uploads must succeed and the rejected commands must be sent only once
+ *  per connection. Then an upload is cut off by the server and a new
+ *  QApplicationFile, like after a restart, has to resume it from the
+ *  persisted upload state. At last the file is uploaded compressed.
+ */
+class ApplicationFileBenchmark : public AbstractBenchmark
+{
+    Q_OBJECT
+public:
+    explicit ApplicationFileBenchmark(QObject *parent = 0);
+    ~ApplicationFileBenchmark();
+
+    void setFileSize(int fileSize)
+    {
+        m_fileSize = fileSize;
+    }
+
+    bool start();
+    bool passed() const;
+
+    QJsonObject results() const;
+    QStringList resultKeys() const;
+
+private:
+    enum Phase {
+        Fallback,
+        FallbackRepeated,
+        Interrupted,
+        Resumed,
+        Compressed,
+        Done
+    };
+
+    int         m_fileSize;
+    FakeFtpServer       *m_server;
+    QApplicationFile    *m_file;
+    QTemporaryDir       m_localDir;
+    QByteArray          m_content;
+    Phase               m_phase;
+    QElapsedTimer       m_elapsedTimer;
+    qint64              m_fallbackTime;
+    qint64              m_resumeTime;
+    qint64              m_compressedTime;
+    qint64              m_resumedBytes;
+    qint64              m_compressedBytes;
+    bool                m_fallbackPassed;
+    bool                m_resumePassed;
+    bool                m_compressedPassed;
+
+    bool writeLocalFile();
+    bool createFile();
+    void startUpload();
+
+private slots:
+    void uploadFinished();
+    void errorStringChanged(const QString &errorString);
+    void startNextPhase();
+    void timeout();
+    void finish();
+};
+
+#endif // APPLICATIONFILEBENCHMARK_H
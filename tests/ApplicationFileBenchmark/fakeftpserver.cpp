@@ -0,0 +1,351 @@
+/****************************************************************************
+**
+** Copyright (C) 2015 Alexander Rössler
+** License: LGPL version 2.1
+**
+** This file is part of QtQuickVcp.
+**
+** All rights reserved. This program and the accompanying materials
+** are made available under the terms of the GNU Lesser General Public License
+** (LGPL) version 2.1 which accompanies this distribution, and is available at
+** http://www.gnu.org/licenses/lgpl-2.1.html
+**
+** This library is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+** Lesser General Public License for more details.
+**
+** Contributors:
+** Alexander Rössler @ The Cool Tool GmbH <mail DOT aroessler AT gmail DOT com>
+**
+****************************************************************************/
+
+#include "fakeftpserver.h"
+#include <QCryptographicHash>
+#include <QStringList>
+
+FakeFtpServer::FakeFtpServer(QObject *parent) :
+    QObject(parent),
+    m_controlServer(new QTcpServer(this)),
+    m_dataServer(new QTcpServer(this)),
+    m_controlSocket(NULL),
+    m_dataSocket(NULL),
+    m_errorString(""),
+    m_checksumSupported(true),
+    m_compressionSupported(true),
+    m_compressed(false),
+    m_interruptAfter(0),
+    m_restOffset(0),
+    m_bytesReceived(0),
+    m_pendingRest(0),
+    m_storName(""),
+    m_listPending(false)
+{
+    connect(m_controlServer, SIGNAL(newConnection()),
+            this, SLOT(newControlConnection()));
+    connect(m_dataServer, SIGNAL(newConnection()),
+            this, SLOT(newDataConnection()));
+}
+
+FakeFtpServer::~FakeFtpServer()
+{
+    stop();
+}
+
+bool FakeFtpServer::start(quint16 port)
+{
+    stop();
+
+    if (!m_controlServer->listen(QHostAddress::LocalHost, port))
+    {
+        m_errorString = m_controlServer->errorString();
+        return false;
+    }
+
+    return true;
+}
+
+void FakeFtpServer::stop()
+{
+    closeDataConnection();
+    m_dataServer->close();
+    m_controlServer->close();
+
+    if (m_controlSocket != NULL)
+    {
+        m_controlSocket->disconnect(this);
+        m_controlSocket->abort();
+        m_controlSocket->deleteLater();
+        m_controlSocket = NULL;
+    }
+}
+
+void FakeFtpServer::reply(const QString &line)
+{
+    if (m_controlSocket != NULL)
+    {
+        m_controlSocket->write(line.toLatin1() + "\r\n");
+    }
+}
+
+void FakeFtpServer::processCommand(const QString &line)
+{
+    QString command = line.section(' ', 0, 0).toUpper();
+    QString argument = line.section(' ', 1);
+
+    m_commandCounts[command]++;
+
+    if (command == "USER")
+    {
+        reply("331 Please specify the password");
+    }
+    else if (command == "PASS")
+    {
+        reply("230 Login successful");
+    }
+    else if (command == "TYPE")
+    {
+        reply("200 Switching type");
+    }
+    else if (command == "PASV")
+    {
+        openDataServer();
+    }
+    else if (command == "ALLO")
+    {
+        reply("200 ALLO command ok");
+    }
+    else if (command == "REST")
+    {
+        m_pendingRest = argument.toLongLong();
+        m_restOffset = m_pendingRest;
+        reply(QString("350 Restart position accepted (%1)").arg(m_pendingRest));
+    }
+    else if (command == "SIZE")
+    {
+        if (m_files.contains(argument))
+        {
+            reply(QString("213 %1").arg(m_files.value(argument).size()));
+        }
+        else
+        {
+            reply("550 Could not get file size");
+        }
+    }
+    else if ((command == "MODE") && (argument.toUpper() == "S"))
+    {
+        m_compressed = false;
+        reply("200 Mode set to S");
+    }
+    else if ((command == "MODE") && (argument.toUpper() == "Z") && m_compressionSupported)
+    {
+        m_compressed = true;
+        reply("200 Mode set to Z");
+    }
+    else if (command == "MODE")
+    {
+        reply("504 Bad MODE command");
+    }
+    else if ((command == "XSHA1") && m_checksumSupported)
+    {
+        if (m_files.contains(argument))
+        {
+            reply("250 " + QString::fromLatin1(QCryptographicHash::hash(m_files.value(argument), QCryptographicHash::Sha1).toHex()));
+        }
+        else
+        {
+            reply("550 Could not read file");
+        }
+    }
+    else if (command == "STOR")
+    {
+        m_storName = argument;
+        m_storData = (m_pendingRest > 0) ? m_files.value(argument).left(m_pendingRest) : QByteArray();
+        m_bytesReceived = 0;
+        m_pendingRest = 0;
+        reply("150 Ok to send data");
+        dataReadyRead();
+    }
+    else if (command == "LIST")
+    {
+        reply("150 Here comes the directory listing");
+        if (m_dataSocket != NULL)
+        {
+            sendListing();
+        }
+        else
+        {
+            m_listPending = true;
+        }
+    }
+    else if (command == "QUIT")
+    {
+        reply("221 Goodbye");
+        m_controlSocket->disconnectFromHost();
+    }
+    else
+    {
+        reply("502 Command not implemented");
+    }
+}
+
+void FakeFtpServer::openDataServer()
+{
+    quint16 port;
+
+    closeDataConnection();
+    m_dataServer->close();
+
+    if (!m_dataServer->listen(QHostAddress::LocalHost, 0))
+    {
+        reply("425 Cannot open data connection");
+        return;
+    }
+
+    port = m_dataServer->serverPort();
+    reply(QString("227 Entering Passive Mode (127,0,0,1,%1,%2)").arg(port / 256).arg(port % 256));
+}
+
+void FakeFtpServer::closeDataConnection()
+{
+    if (m_dataSocket == NULL)
+    {
+        return;
+    }
+
+    m_dataSocket->disconnect(this);
+    m_dataSocket->abort();
+    m_dataSocket->deleteLater();
+    m_dataSocket = NULL;
+}
+
+/** The directory listing is always empty, the harness only checks uploads */
+void FakeFtpServer::sendListing()
+{
+    m_listPending = false;
+    m_dataSocket->disconnectFromHost();
+}
+
+/** MODE Z data is a plain zlib stream, qUncompress expects the size in front
+ *  and grows its buffer when the size is too small
+ */
+void FakeFtpServer::finishStor()
+{
+    if (m_compressed)
+    {
+        QByteArray header(4, 0);
+        header[0] = (char)((m_storData.size() >> 24) & 0xff);
+        header[1] = (char)((m_storData.size() >> 16) & 0xff);
+        header[2] = (char)((m_storData.size() >> 8) & 0xff);
+        header[3] = (char)(m_storData.size() & 0xff);
+        m_storData = qUncompress(header + m_storData);
+    }
+
+    m_files.insert(m_storName, m_storData);
+    m_storName.clear();
+    m_storData.clear();
+    closeDataConnection();
+    reply("226 Transfer complete");
+}
+
+void FakeFtpServer::newControlConnection()
+{
+    QTcpSocket *socket = m_controlServer->nextPendingConnection();
+
+    if (m_controlSocket != NULL)    // the client reconnected
+    {
+        m_controlSocket->disconnect(this);
+        m_controlSocket->deleteLater();
+    }
+
+    closeDataConnection();
+    m_controlSocket = socket;
+    m_controlBuffer.clear();
+    m_compressed = false;
+    m_pendingRest = 0;
+    m_storName.clear();
+    m_listPending = false;
+    connect(m_controlSocket, SIGNAL(readyRead()),
+            this, SLOT(controlReadyRead()));
+
+    reply("220 Fake FTP server ready");
+}
+
+void FakeFtpServer::newDataConnection()
+{
+    closeDataConnection();
+    m_dataSocket = m_dataServer->nextPendingConnection();
+    m_dataServer->close();
+    connect(m_dataSocket, SIGNAL(readyRead()),
+            this, SLOT(dataReadyRead()));
+    connect(m_dataSocket, SIGNAL(disconnected()),
+            this, SLOT(dataDisconnected()));
+
+    if (m_listPending)
+    {
+        sendListing();
+    }
+}
+
+void FakeFtpServer::controlReadyRead()
+{
+    int index;
+
+    m_controlBuffer.append(m_controlSocket->readAll());
+    while ((m_controlSocket != NULL) && ((index = m_controlBuffer.indexOf("\r\n")) != -1))
+    {
+        QString line = QString::fromLatin1(m_controlBuffer.left(index)).trimmed();
+        m_controlBuffer.remove(0, index + 2);
+        processCommand(line);
+    }
+}
+
+void FakeFtpServer::dataReadyRead()
+{
+    QByteArray data;
+
+    if ((m_dataSocket == NULL) || m_storName.isEmpty())   // data is read once STOR arrived
+    {
+        return;
+    }
+
+    data = m_dataSocket->readAll();
+    m_storData.append(data);
+    m_bytesReceived += data.size();
+
+    if ((m_interruptAfter > 0) && (m_bytesReceived >= m_interruptAfter))
+    {
+        m_storData.chop(m_bytesReceived - m_interruptAfter);
+        m_bytesReceived = m_interruptAfter;
+        m_interruptAfter = 0;
+        m_files.insert(m_storName, m_storData);
+        m_storName.clear();
+        m_storData.clear();
+        closeDataConnection();
+        reply("426 Connection closed; transfer aborted");
+    }
+}
+
+void FakeFtpServer::dataDisconnected()
+{
+    if (QObject::sender() != m_dataSocket)
+    {
+        return;
+    }
+
+    dataReadyRead();
+    if (m_dataSocket == NULL)   // the transfer was interrupted
+    {
+        return;
+    }
+
+    if (!m_storName.isEmpty())
+    {
+        finishStor();
+    }
+    else
+    {
+        closeDataConnection();
+        reply("226 Directory send OK");
+    }
+}
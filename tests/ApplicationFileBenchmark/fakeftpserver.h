@@ -0,0 +1,125 @@
+/****************************************************************************
+**
+** Copyright (C) 2015 Alexander Rössler
+** License: LGPL version 2.1
+**
+** This file is part of QtQuickVcp.
+**
+** All rights reserved. This program and the accompanying materials
+** are made available under the terms of the GNU Lesser General Public License
+** (LGPL) version 2.1 which accompanies this distribution, and is available at
+** http://www.gnu.org/licenses/lgpl-2.1.html
+**
+** This library is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+** Lesser General Public License for more details.
+**
+** Contributors:
+** Alexander Rössler @ The Cool Tool GmbH <mail DOT aroessler AT gmail DOT com>
+**
+****************************************************************************/
+
+#ifndef FAKEFTPSERVER_H
+#define FAKEFTPSERVER_H
+
+#include <QObject>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QHash>
+#include <QByteArray>
+
+/** Local stand-in for the FTP server of Machinekit
+ *
+ *  Serves one client in passive mode and keeps the uploaded files in
+ *  memory. Checksums (XSHA1) and compressed transfers (MODE Z) can be
+ *  switched off, the server then answers them with 5xx like servers
+ *  without the extension. With interruptAfter set, the next upload is
+ *  cut off after that many bytes and the partial file is kept.
+ */
+class FakeFtpServer : public QObject
+{
+    Q_OBJECT
+public:
+    explicit FakeFtpServer(QObject *parent = 0);
+    ~FakeFtpServer();
+
+    bool start(quint16 port);
+    void stop();
+
+    void setChecksumSupported(bool supported)
+    {
+        m_checksumSupported = supported;
+    }
+
+    void setCompressionSupported(bool supported)
+    {
+        m_compressionSupported = supported;
+    }
+
+    void setInterruptAfter(qint64 bytes)
+    {
+        m_interruptAfter = bytes;
+    }
+
+    QByteArray file(const QString &name) const
+    {
+        return m_files.value(name);
+    }
+
+    int commandCount(const QString &command) const
+    {
+        return m_commandCounts.value(command, 0);
+    }
+
+    qint64 restOffset() const
+    {
+        return m_restOffset;
+    }
+
+    qint64 bytesReceived() const
+    {
+        return m_bytesReceived;
+    }
+
+    QString errorString() const
+    {
+        return m_errorString;
+    }
+
+private:
+    QTcpServer  *m_controlServer;
+    QTcpServer  *m_dataServer;
+    QTcpSocket  *m_controlSocket;
+    QTcpSocket  *m_dataSocket;
+    QString     m_errorString;
+    bool        m_checksumSupported;
+    bool        m_compressionSupported;
+    bool        m_compressed;       // MODE Z is active
+    qint64      m_interruptAfter;
+    qint64      m_restOffset;       // offset of the last REST
+    qint64      m_bytesReceived;    // bytes of the last STOR on the data connection
+    qint64      m_pendingRest;
+    QString     m_storName;         // file of the running STOR
+    bool        m_listPending;      // LIST waits for the data connection
+    QByteArray  m_storData;
+    QByteArray  m_controlBuffer;
+    QHash<QString, QByteArray> m_files;
+    QHash<QString, int> m_commandCounts;
+
+    void reply(const QString &line);
+    void processCommand(const QString &line);
+    void openDataServer();
+    void closeDataConnection();
+    void sendListing();
+    void finishStor();
+
+private slots:
+    void newControlConnection();
+    void newDataConnection();
+    void controlReadyRead();
+    void dataReadyRead();
+    void dataDisconnected();
+};
+
+#endif // FAKEFTPSERVER_H
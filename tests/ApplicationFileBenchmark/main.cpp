@@ -0,0 +1,24 @@
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QStandardPaths>
+#include "applicationfilebenchmark.h"
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("applicationfilebenchmark");
+    QStandardPaths::setTestModeEnabled(true);   // keep the upload state away from the user cache
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Application file upload benchmark against a local fake FTP server");
+    parser.addHelpOption();
+    QCommandLineOption sizeOption(QStringList() << "s" << "size", "Size of the uploaded file in bytes.", "bytes", "4000000");
+    parser.addOption(sizeOption);
+    AbstractBenchmark::addOutputOptions(parser);
+    parser.process(app);
+
+    ApplicationFileBenchmark benchmark;
+    benchmark.setFileSize(qMax(1000, parser.value(sizeOption).toInt()));
+
+    return benchmark.exec(app, parser);
+}
@@ -0,0 +1,14 @@
+TEMPLATE = app
+TARGET = commandpipelinebenchmark
+
+include(../common/benchmark.pri)
+include(../common/application.pri)
+
+SOURCES += \
+    main.cpp \
+    fakecommandserver.cpp \
+    commandpipelinebenchmark.cpp
+
+HEADERS += \
+    fakecommandserver.h \
+    commandpipelinebenchmark.h
@@ -0,0 +1,331 @@
+/****************************************************************************
+**
+** Copyright (C) 2015 Alexander Rössler
+** License: LGPL version 2.1
+**
+** This file is part of QtQuickVcp.
+**
+** All rights reserved. This program and the accompanying materials
+** are made available under the terms of the GNU Lesser General Public License
+** (LGPL) version 2.1 which accompanies this distribution, and is available at
+** http://www.gnu.org/licenses/lgpl-2.1.html
+**
+** This library is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+** Lesser General Public License for more details.
+**
+** Contributors:
+** Alexander Rössler @ The Cool Tool GmbH <mail DOT aroessler AT gmail DOT com>
+**
+****************************************************************************/
+
+#include "commandpipelinebenchmark.h"
+#include <QStringList>
+#include <QTimer>
+#include <algorithm>
+
+CommandPipelineBenchmark::CommandPipelineBenchmark(QObject *parent) :
+    AbstractBenchmark(parent),
+    m_count(1000),
+    m_window(16),
+    m_executionTime(1),
+    m_ticketsEnabled(true),
+    m_server(new FakeCommandServer(this)),
+    m_command(NULL),
+    m_wallTime(0),
+    m_completed(0),
+    m_failed(0),
+    m_acknowledged(0),
+    m_maxInFlight(0),
+    m_supersedeStarted(false),
+    m_reentrantCommandSent(false),
+    m_supersedePassed(false),
+    m_started(false),
+    m_finished(false)
+{
+}
+
+bool CommandPipelineBenchmark::start()
+{
+    QString commandUri = "tcp://127.0.0.1:5612";
+
+    m_server->setExecutionTime(m_executionTime);
+    m_server->setTicketsEnabled(m_ticketsEnabled);
+    if (!m_server->start(commandUri))
+    {
+        m_errorString = m_server->errorString();
+        return false;
+    }
+
+    m_command = new QApplicationCommand(this);
+    m_command->setCommandUri(commandUri);
+    m_command->setMaxPendingCommands(m_window);
+    connect(m_command, SIGNAL(connectedChanged(bool)),
+            this, SLOT(connectedChanged(bool)));
+    connect(m_command, SIGNAL(commandAcknowledged(int)),
+            this, SLOT(commandAcknowledged(int)));
+    connect(m_command, SIGNAL(commandCompleted(int)),
+            this, SLOT(commandCompleted(int)));
+    connect(m_command, SIGNAL(commandFailed(int,QString)),
+            this, SLOT(commandFailed(int,QString)));
+
+    m_command->componentComplete();
+    m_command->setReady(true);
+    QTimer::singleShot(5000, this, SLOT(connectTimeout()));
+
+    return true;
+}
+
+/** Issues the whole sequence at once, as a script without delays would */
+void CommandPipelineBenchmark::connectedChanged(bool connected)
+{
+    if (!connected || m_started)
+    {
+        return;
+    }
+    m_started = true;
+
+    m_sendTimes.reserve(m_count);
+    m_latencies.reserve(m_count);
+    m_elapsedTimer.start();
+
+    for (int i = 0; i < m_count; ++i)
+    {
+        int ticket;
+
+        switch (i % 4)
+        {
+        case 0:
+            ticket = m_command->setTaskMode("execute", QApplicationCommand::TaskModeManual);
+            break;
+        case 1:
+            ticket = m_command->homeAxis(i % 3);
+            break;
+        case 2:
+            ticket = m_command->setTaskMode("execute", QApplicationCommand::TaskModeAuto);
+            break;
+        default:
+            ticket = m_command->runProgram("execute", 0);
+        }
+
+        if (ticket == 0)
+        {
+            m_errorString = QString("command %1 was not sent").arg(i);
+            finish();
+            return;
+        }
+        m_sendTimes.insert(ticket, m_elapsedTimer.nsecsElapsed());
+        m_issuedTickets.append(ticket);
+    }
+}
+
+void CommandPipelineBenchmark::connectTimeout()
+{
+    if (!m_started)
+    {
+        m_errorString = "timeout while connecting to the command server";
+        finish();
+    }
+}
+
+void CommandPipelineBenchmark::commandAcknowledged(int ticket)
+{
+    Q_UNUSED(ticket)
+    int inFlight = (int)m_server->commandsReceived() - m_finishedTickets.size();
+
+    m_acknowledged++;
+    m_maxInFlight = qMax(m_maxInFlight, inFlight);
+}
+
+void CommandPipelineBenchmark::commandCompleted(int ticket)
+{
+    if (m_supersedeStarted)
+    {
+        m_outstandingTickets.removeOne(ticket);
+        checkSupersede();
+        return;
+    }
+
+    m_completed++;
+    m_finishedTickets.append(ticket);
+    m_latencies.append((m_elapsedTimer.nsecsElapsed() - m_sendTimes.value(ticket)) / 1000);
+
+    if (m_finishedTickets.size() == m_issuedTickets.size())
+    {
+        startSupersedeCheck();
+    }
+}
+
+void CommandPipelineBenchmark::commandFailed(int ticket, const QString &errorString)
+{
+    Q_UNUSED(errorString)
+
+    if (m_finished)
+    {
+        return;
+    }
+
+    if (m_supersedeStarted)
+    {
+        m_failedTickets.insert(ticket, errorString);
+        m_outstandingTickets.removeOne(ticket);
+        if (!m_reentrantCommandSent)    // like a QML handler, must not corrupt the stop jog
+        {
+            m_reentrantCommandSent = true;
+            m_abortedTickets << m_command->homeAxis(3);
+        }
+        checkSupersede();
+        return;
+    }
+
+    m_failed++;
+    m_finishedTickets.append(ticket);
+
+    if (m_finishedTickets.size() == m_issuedTickets.size())
+    {
+        startSupersedeCheck();
+    }
+}
+
+/** Queues jogs behind a home command in a window of one, then stops the
+ *  jog of axis 0 and aborts. The stop must drop both jogs of axis 0, the
+ *  abort the remaining queued commands. The drops are reported after the
+ *  stop or abort was sent, the first report queues another home command
+ *  that the abort drops. The check completes when the sent commands are
+ *  finished.
+ */
+void CommandPipelineBenchmark::startSupersedeCheck()
+{
+    if (m_supersedeStarted)
+    {
+        return;
+    }
+    m_supersedeStarted = true;
+    m_wallTime = m_elapsedTimer.elapsed();  // the check is not part of the timing
+
+    m_command->setMaxPendingCommands(1);
+
+    m_outstandingTickets << m_command->homeAxis(0);
+    m_supersededTickets << m_command->jog(QApplicationCommand::ContinuousJog, 0, 10.0)
+                        << m_command->jog(QApplicationCommand::IncrementJog, 0, 10.0, 1.0);
+    m_abortedTickets << m_command->jog(QApplicationCommand::IncrementJog, 1, 10.0, 1.0);
+    m_outstandingTickets << m_command->jog(QApplicationCommand::StopJog, 0);
+    m_abortedTickets << m_command->homeAxis(2);
+    m_outstandingTickets << m_command->abort("execute");
+
+    if (m_outstandingTickets.contains(0) || m_supersededTickets.contains(0) || m_abortedTickets.contains(0))
+    {
+        m_errorString = "supersede check command was not sent";
+        finish();
+        return;
+    }
+
+    QTimer::singleShot(10000, this, SLOT(supersedeTimeout()));
+    checkSupersede();
+}
+
+void CommandPipelineBenchmark::checkSupersede()
+{
+    if (!m_outstandingTickets.isEmpty())
+    {
+        return;
+    }
+
+    m_supersedePassed = (m_server->commandsReceived(pb::MT_EMC_AXIS_JOG) == 0)
+                        && (m_server->commandsReceived(pb::MT_EMC_AXIS_INCR_JOG) == 0)
+                        && (m_server->commandsReceived(pb::MT_EMC_AXIS_ABORT) == 1)
+                        && (m_server->lastIndexReceived(pb::MT_EMC_AXIS_ABORT) == 0)
+                        && (m_server->lastIndexReceived(pb::MT_EMC_AXIS_HOME) == 0)
+                        && (m_server->commandsReceived(pb::MT_EMC_TASK_ABORT) == 1);
+    foreach (int ticket, m_supersededTickets)
+    {
+        m_supersedePassed = m_supersedePassed && (m_failedTickets.value(ticket) == "command superseded");
+    }
+    foreach (int ticket, m_abortedTickets)
+    {
+        m_supersedePassed = m_supersedePassed && (m_failedTickets.value(ticket) == "command aborted");
+    }
+    if (m_ticketsEnabled)   // without tickets the sent commands expire
+    {
+        m_supersedePassed = m_supersedePassed
+                            && (m_failedTickets.size() == (m_supersededTickets.size() + m_abortedTickets.size()));
+    }
+
+    finish();
+}
+
+void CommandPipelineBenchmark::supersedeTimeout()
+{
+    if (!m_finished)
+    {
+        m_errorString = "timeout while waiting for the supersede check";
+        finish();
+    }
+}
+
+void CommandPipelineBenchmark::finish()
+{
+    if (m_finished)
+    {
+        return;
+    }
+    m_finished = true;
+
+    if (m_elapsedTimer.isValid() && !m_supersedeStarted)
+    {
+        m_wallTime = m_elapsedTimer.elapsed();
+    }
+    std::sort(m_latencies.begin(), m_latencies.end());
+
+    m_command->setReady(false);
+    m_server->stop();
+
+    emit finished();
+}
+
+/** Every ticket finished once, in issue order and successfully */
+bool CommandPipelineBenchmark::passed() const
+{
+    return m_errorString.isEmpty()
+           && (m_failed == 0)
+           && (m_finishedTickets == m_issuedTickets)
+           && m_supersedePassed;
+}
+
+QJsonObject CommandPipelineBenchmark::results() const
+{
+    QJsonObject results;
+    double seconds = qMax((qint64)1, m_wallTime) / 1000.0;
+
+    results["count"] = m_count;
+    results["window"] = m_window;
+    results["execution_time_ms"] = m_executionTime;
+    results["tickets"] = m_ticketsEnabled;
+    results["commands_received"] = (double)m_server->commandsReceived();
+    results["acknowledged"] = m_acknowledged;
+    results["completed"] = m_completed;
+    results["failed"] = m_failed;
+    results["max_in_flight"] = m_maxInFlight;
+    results["commands_per_second"] = m_completed / seconds;
+    results["latency_p50_us"] = (double)percentile(m_latencies, 0.5);
+    results["latency_p99_us"] = (double)percentile(m_latencies, 0.99);
+    results["latency_max_us"] = (double)(m_latencies.isEmpty() ? 0 : m_latencies.last());
+    results["wall_time_ms"] = (double)m_wallTime;
+    results["supersede_passed"] = m_supersedePassed;
+    results["passed"] = passed();
+
+    return results;
+}
+
+QStringList CommandPipelineBenchmark::resultKeys() const
+{
+    QStringList keys;
+
+    keys << "count" << "window" << "execution_time_ms" << "tickets" << "commands_received"
+         << "acknowledged" << "completed" << "failed" << "max_in_flight" << "commands_per_second"
+         << "latency_p50_us" << "latency_p99_us" << "latency_max_us" << "wall_time_ms"
+         << "supersede_passed" << "passed";
+
+    return keys;
+}
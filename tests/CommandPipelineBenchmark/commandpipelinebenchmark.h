@@ -0,0 +1,116 @@
+/****************************************************************************
+**
+** Copyright (C) 2015 Alexander Rössler
+** License: LGPL version 2.1
+**
+** This file is part of QtQuickVcp.
+**
+** All rights reserved. This program and the accompanying materials
+** are made available under the terms of the GNU Lesser General Public License
+** (LGPL) version 2.1 which accompanies this distribution, and is available at
+** http://www.gnu.org/licenses/lgpl-2.1.html
+**
+** This library is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+** Lesser General Public License for more details.
+**
+** Contributors:
+** Alexander Rössler @ The Cool Tool GmbH <mail DOT aroessler AT gmail DOT com>
+**
+****************************************************************************/
+
+#ifndef COMMANDPIPELINEBENCHMARK_H
+#define COMMANDPIPELINEBENCHMARK_H
+
+#include "abstractbenchmark.h"
+#include <QElapsedTimer>
+#include <QHash>
+#include <QVector>
+#include <QJsonObject>
+#include "qapplicationcommand.h"
+#include "fakecommandserver.h"
+
+/** Sends a scripted command sequence through a QApplicationCommand
+ *
+ *  All commands are issued at once and the command window of the
+ *  QApplicationCommand decides how many are in flight. A window of 1
+ *  corresponds to waiting for each command before sending the next one.
+ *  Besides the timing the benchmark verifies that every ticket completes
+ *  exactly once and in the order the commands were issued. Afterwards it
+ *  checks that stopping a jog and abort drop the queued commands they
+ *  supersede before they reach the server.
+ */
+class CommandPipelineBenchmark : public AbstractBenchmark
+{
+    Q_OBJECT
+public:
+    explicit CommandPipelineBenchmark(QObject *parent = 0);
+
+    void setCount(int count)
+    {
+        m_count = count;
+    }
+
+    void setWindow(int window)
+    {
+        m_window = window;
+    }
+
+    void setExecutionTime(int executionTime)
+    {
+        m_executionTime = executionTime;
+    }
+
+    void setTicketsEnabled(bool enabled)
+    {
+        m_ticketsEnabled = enabled;
+    }
+
+    bool start();
+
+    bool passed() const;
+    QJsonObject results() const;
+    QStringList resultKeys() const;
+
+private:
+    int         m_count;
+    int         m_window;
+    int         m_executionTime;
+    bool        m_ticketsEnabled;
+    FakeCommandServer       *m_server;
+    QApplicationCommand     *m_command;
+    QElapsedTimer           m_elapsedTimer;
+    QHash<int, qint64>      m_sendTimes;        // ticket -> ns since start
+    QVector<qint64>         m_latencies;        // us
+    QList<int>              m_issuedTickets;
+    QList<int>              m_finishedTickets;
+    qint64                  m_wallTime;
+    int                     m_completed;
+    int                     m_failed;
+    int                     m_acknowledged;
+    int                     m_maxInFlight;
+    QList<int>              m_supersededTickets;    // dropped by the stop jog
+    QList<int>              m_abortedTickets;       // dropped by abort
+    QList<int>              m_outstandingTickets;   // sent, must finish
+    QHash<int, QString>     m_failedTickets;        // ticket -> error string
+    bool                    m_supersedeStarted;
+    bool                    m_reentrantCommandSent; // sent from the first commandFailed
+    bool                    m_supersedePassed;
+    bool                    m_started;
+    bool                    m_finished;
+
+    void startSupersedeCheck();
+    void checkSupersede();
+
+private slots:
+    void connectedChanged(bool connected);
+    void connectTimeout();
+    void commandAcknowledged(int ticket);
+    void commandCompleted(int ticket);
+    void commandFailed(int ticket, const QString &errorString);
+    void supersedeTimeout();
+    void finish();
+};
+
+#endif // COMMANDPIPELINEBENCHMARK_H
@@ -0,0 +1,124 @@
+/****************************************************************************
+**
+** Copyright (C) 2015 Alexander Rössler
+** License: LGPL version 2.1
+**
+** This file is part of QtQuickVcp.
+**
+** All rights reserved. This program and the accompanying materials
+** are made available under the terms of the GNU Lesser General Public License
+** (LGPL) version 2.1 which accompanies this distribution, and is available at
+** http://www.gnu.org/licenses/lgpl-2.1.html
+**
+** This library is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+** Lesser General Public License for more details.
+**
+** Contributors:
+** Alexander Rössler @ The Cool Tool GmbH <mail DOT aroessler AT gmail DOT com>
+**
+****************************************************************************/
+
+#include "fakecommandserver.h"
+
+FakeCommandServer::FakeCommandServer(QObject *parent) :
+    AbstractFakeServer(parent),
+    m_socket(NULL),
+    m_executionTimer(new QTimer(this)),
+    m_ticketsEnabled(true),
+    m_commandsReceived(0)
+{
+    m_executionTimer->setSingleShot(true);
+    m_executionTimer->setTimerType(Qt::PreciseTimer);
+    m_executionTimer->setInterval(1);
+    connect(m_executionTimer, SIGNAL(timeout()),
+            this, SLOT(executionTimerTick()));
+}
+
+FakeCommandServer::~FakeCommandServer()
+{
+    stop();
+}
+
+bool FakeCommandServer::start(const QString &uri)
+{
+    stop();
+
+    m_socket = bindSocket(ZMQSocket::TYP_ROUTER, uri, SLOT(messageReceived(QList<QByteArray>)));
+    if (m_socket == NULL)
+    {
+        stop();
+        return false;
+    }
+
+    return true;
+}
+
+void FakeCommandServer::stop()
+{
+    m_executionTimer->stop();
+    m_executionQueue.clear();
+
+    closeSockets();
+    m_socket = NULL;
+}
+
+void FakeCommandServer::sendTicketUpdate(const QByteArray &identity, int ticket, pb::RCS_STATUS status)
+{
+    pb::TicketUpdate *ticketUpdate = m_tx.mutable_ticket_update();
+
+    ticketUpdate->set_cticket(ticket);
+    ticketUpdate->set_status(status);
+
+    sendContainer(m_socket, QList<QByteArray>() << identity, pb::MT_TICKET_UPDATE);
+}
+
+/** Router sockets prepend the peer identity */
+void FakeCommandServer::messageReceived(const QList<QByteArray> &messageList)
+{
+    QByteArray identity = messageList.at(0);
+
+    m_rx.ParseFromArray(messageList.last().data(), messageList.last().size());
+
+    if (m_rx.type() == pb::MT_PING)
+    {
+        sendContainer(m_socket, QList<QByteArray>() << identity, pb::MT_PING_ACKNOWLEDGE);
+        return;
+    }
+
+    m_commandsReceived++;
+    m_typesReceived[(int)m_rx.type()]++;
+    if (m_rx.has_emc_command_params() && m_rx.emc_command_params().has_index())
+    {
+        m_indexesReceived.insert((int)m_rx.type(), m_rx.emc_command_params().index());
+    }
+
+    if (!m_ticketsEnabled || !m_rx.has_ticket())
+    {
+        return;
+    }
+
+    sendTicketUpdate(identity, m_rx.ticket(), pb::RCS_RECEIVED);
+    m_executionQueue.enqueue(qMakePair(identity, (int)m_rx.ticket()));
+    if (!m_executionTimer->isActive())
+    {
+        m_executionTimer->start();
+    }
+}
+
+void FakeCommandServer::executionTimerTick()
+{
+    if (m_executionQueue.isEmpty())
+    {
+        return;
+    }
+
+    QPair<QByteArray, int> command = m_executionQueue.dequeue();
+    sendTicketUpdate(command.first, command.second, pb::RCS_DONE);
+
+    if (!m_executionQueue.isEmpty())
+    {
+        m_executionTimer->start();
+    }
+}
@@ -0,0 +1,90 @@
+/****************************************************************************
+**
+** Copyright (C) 2015 Alexander Rössler
+** License: LGPL version 2.1
+**
+** This file is part of QtQuickVcp.
+**
+** All rights reserved. This program and the accompanying materials
+** are made available under the terms of the GNU Lesser General Public License
+** (LGPL) version 2.1 which accompanies this distribution, and is available at
+** http://www.gnu.org/licenses/lgpl-2.1.html
+**
+** This library is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+** Lesser General Public License for more details.
+**
+** Contributors:
+** Alexander Rössler @ The Cool Tool GmbH <mail DOT aroessler AT gmail DOT com>
+**
+****************************************************************************/
+
+#ifndef FAKECOMMANDSERVER_H
+#define FAKECOMMANDSERVER_H
+
+#include <QQueue>
+#include <QHash>
+#include <QTimer>
+#include "abstractfakeserver.h"
+
+/** Local stand-in for the Machinekit command service
+ *
+ *  Answers pings and reports every command with a ticket as received
+ *  right away and as done after the execution time. Commands are executed
+ *  one after another, the same way task works through its queue. With
+ *  tickets disabled the server behaves like a server without ticket
+ *  support and never reports a command.
+ */
+class FakeCommandServer : public AbstractFakeServer
+{
+    Q_OBJECT
+public:
+    explicit FakeCommandServer(QObject *parent = 0);
+    ~FakeCommandServer();
+
+    bool start(const QString &uri);
+    void stop();
+
+    void setExecutionTime(int executionTime)
+    {
+        m_executionTimer->setInterval(executionTime);
+    }
+
+    void setTicketsEnabled(bool enabled)
+    {
+        m_ticketsEnabled = enabled;
+    }
+
+    quint64 commandsReceived() const
+    {
+        return m_commandsReceived;
+    }
+
+    int commandsReceived(pb::ContainerType type) const
+    {
+        return m_typesReceived.value((int)type, 0);
+    }
+
+    int lastIndexReceived(pb::ContainerType type) const
+    {
+        return m_indexesReceived.value((int)type, -1);
+    }
+
+private:
+    ZMQSocket           *m_socket;
+    QTimer              *m_executionTimer;
+    bool                m_ticketsEnabled;
+    quint64             m_commandsReceived;
+    QHash<int, int>     m_typesReceived;    // container type -> count
+    QHash<int, int>     m_indexesReceived;  // container type -> index of the last command
+    QQueue<QPair<QByteArray, int> > m_executionQueue;  // peer identity and ticket
+
+    void sendTicketUpdate(const QByteArray &identity, int ticket, pb::RCS_STATUS status);
+
+private slots:
+    void messageReceived(const QList<QByteArray> &messageList);
+    void executionTimerTick();
+};
+
+#endif // FAKECOMMANDSERVER_H
@@ -0,0 +1,33 @@
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include "commandpipelinebenchmark.h"
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("commandpipelinebenchmark");
+
+    GOOGLE_PROTOBUF_VERIFY_VERSION;
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Command pipelining benchmark against a local fake command server");
+    parser.addHelpOption();
+    QCommandLineOption countOption(QStringList() << "n" << "count", "Number of commands.", "count", "1000");
+    QCommandLineOption windowOption(QStringList() << "w" << "window", "Maximum pending commands, 0 is unlimited.", "window", "16");
+    QCommandLineOption executionOption(QStringList() << "e" << "execution-time", "Server execution time per command in ms.", "ms", "1");
+    QCommandLineOption noTicketsOption(QStringList() << "no-tickets", "Simulate a server without ticket support.");
+    parser.addOption(countOption);
+    parser.addOption(windowOption);
+    parser.addOption(executionOption);
+    parser.addOption(noTicketsOption);
+    AbstractBenchmark::addOutputOptions(parser);
+    parser.process(app);
+
+    CommandPipelineBenchmark benchmark;
+    benchmark.setCount(qMax(1, parser.value(countOption).toInt()));
+    benchmark.setWindow(qMax(0, parser.value(windowOption).toInt()));
+    benchmark.setExecutionTime(qMax(0, parser.value(executionOption).toInt()));
+    benchmark.setTicketsEnabled(!parser.isSet(noTicketsOption));
+
+    return benchmark.exec(app, parser);
+}
@@ -0,0 +1,14 @@
+TEMPLATE = app
+TARGET = discoverybenchmark
+
+include(../common/benchmark.pri)
+include(../common/service.pri)
+
+SOURCES += \
+    main.cpp \
+    fakednsresponder.cpp \
+    discoverybenchmark.cpp
+
+HEADERS += \
+    fakednsresponder.h \
+    discoverybenchmark.h
@@ -0,0 +1,244 @@
+/****************************************************************************
+**
+** Copyright (C) 2015 Alexander Rössler
+** License: LGPL version 2.1
+**
+** This file is part of QtQuickVcp.
+**
+** All rights reserved. This program and the accompanying materials
+** are made available under the terms of the GNU Lesser General Public License
+** (LGPL) version 2.1 which accompanies this distribution, and is available at
+** http://www.gnu.org/licenses/lgpl-2.1.html
+**
+** This library is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+** Lesser General Public License for more details.
+**
+** Contributors:
+** Alexander Rössler @ The Cool Tool GmbH <mail DOT aroessler AT gmail DOT com>
+**
+****************************************************************************/
+
+#include "discoverybenchmark.h"
+#include <QFile>
+#include <QQmlListProperty>
+
+DiscoveryBenchmark::DiscoveryBenchmark(QObject *parent) :
+    AbstractBenchmark(parent),
+    m_instanceCount(60),
+    m_serviceCount(4),
+    m_lookupInterval(1000),
+    m_ttl(120),
+    m_duration(10),
+    m_timeout(60),
+    m_port(53535),
+    m_responder(new FakeDnsResponder(this)),
+    m_discovery(NULL),
+    m_timeToReady(-1),
+    m_cpuStart(0),
+    m_cpuTimeToReady(0),
+    m_rssStart(-1),
+    m_rssReady(-1),
+    m_rssEnd(-1),
+    m_finished(false)
+{
+    m_counters.readyChanged = 0;
+    m_counters.readyLost = 0;
+    m_counters.queryItemsChanged = 0;
+    m_counters.serviceItemsChanged = 0;
+    m_readyCounters = m_counters;
+}
+
+bool DiscoveryBenchmark::start()
+{
+    QStringList types = serviceTypes(m_serviceCount);
+
+    m_responder->setInstances(m_instanceCount, types, m_ttl);
+    if (!m_responder->start(m_port))
+    {
+        m_errorString = m_responder->errorString();
+        return false;
+    }
+
+    m_rssStart = residentSetSize();
+
+    m_discovery = new QServiceDiscovery(this);
+    m_discovery->setLookupMode(QServiceDiscovery::UnicastDNS);
+    m_discovery->setUnicastLookupInterval(m_lookupInterval);
+
+    QNameServer *nameServer = new QNameServer(m_discovery);
+    nameServer->setHostName("127.0.0.1");
+    nameServer->setPort(m_port);
+    m_discovery->addNameServer(nameServer);
+
+    QQmlListProperty<QServiceList> serviceLists = m_discovery->serviceLists();
+    for (int i = 0; i < m_instanceCount; ++i)
+    {
+        QServiceList *serviceList = new QServiceList(m_discovery);
+        QQmlListProperty<QService> services = serviceList->services();
+
+        foreach (const QString &type, types)
+        {
+            QService *service = new QService(serviceList);
+            service->setType(type);
+            service->filter()->setTxtRecords(QStringList() << QString("uuid=%1").arg(FakeDnsResponder::instanceUuid(i)));
+            connect(service, SIGNAL(readyChanged(bool)),
+                    this, SLOT(serviceReadyChanged(bool)));
+            connect(service, SIGNAL(itemsChanged(QQmlListProperty<QServiceDiscoveryItem>)),
+                    this, SLOT(serviceItemsChanged()));
+            for (int j = 0; j < service->queriesCount(); ++j)
+            {
+                connect(service->query(j), SIGNAL(itemsChanged(QQmlListProperty<QServiceDiscoveryItem>)),
+                        this, SLOT(queryItemsChanged()));
+            }
+            services.append(&services, service);
+            m_services.append(service);
+        }
+
+        serviceLists.append(&serviceLists, serviceList);
+    }
+
+    m_cpuStart = cpuTime();
+    m_elapsedTimer.start();
+    m_discovery->componentComplete();
+    m_discovery->setRunning(true);
+    QTimer::singleShot(m_timeout * 1000, this, SLOT(readyTimeout()));
+
+    return true;
+}
+
+void DiscoveryBenchmark::serviceReadyChanged(bool ready)
+{
+    QObject *service = QObject::sender();
+
+    m_counters.readyChanged++;
+
+    if (ready)
+    {
+        m_readyServices.insert(service);
+    }
+    else if (m_readyServices.remove(service))
+    {
+        m_counters.readyLost++;     // flicker, a ready service went away again
+    }
+
+    if ((m_timeToReady == -1) && (m_readyServices.size() == m_services.size()))
+    {
+        m_timeToReady = m_elapsedTimer.elapsed();
+        m_cpuTimeToReady = cpuTime() - m_cpuStart;
+        m_rssReady = residentSetSize();
+        m_readyCounters = m_counters;
+        QTimer::singleShot(m_duration * 1000, this, SLOT(finish()));
+    }
+}
+
+void DiscoveryBenchmark::queryItemsChanged()
+{
+    m_counters.queryItemsChanged++;
+}
+
+void DiscoveryBenchmark::serviceItemsChanged()
+{
+    m_counters.serviceItemsChanged++;
+}
+
+void DiscoveryBenchmark::readyTimeout()
+{
+    if (m_timeToReady == -1)
+    {
+        m_errorString = QString("timeout, %1 of %2 services ready").arg(m_readyServices.size()).arg(m_services.size());
+        finish();
+    }
+}
+
+void DiscoveryBenchmark::finish()
+{
+    if (m_finished)
+    {
+        return;
+    }
+    m_finished = true;
+
+    m_rssEnd = residentSetSize();
+    m_discovery->setRunning(false);
+    m_responder->stop();
+
+    emit finished();
+}
+
+QStringList DiscoveryBenchmark::serviceTypes(int count)
+{
+    QStringList knownTypes;
+    QStringList types;
+
+    knownTypes << "launcher" << "config" << "status" << "command"
+               << "error" << "halrcmd" << "halrcomp" << "file";
+
+    for (int i = 0; i < count; ++i)
+    {
+        types.append((i < knownTypes.size()) ? knownTypes.at(i) : QString("service%1").arg(i));
+    }
+
+    return types;
+}
+
+/** Resident set size in kB, -1 if not available on the platform */
+qint64 DiscoveryBenchmark::residentSetSize()
+{
+    QFile file("/proc/self/status");
+
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text))
+    {
+        return -1;
+    }
+
+    while (!file.atEnd())
+    {
+        QByteArray line = file.readLine();
+        if (line.startsWith("VmRSS:"))
+        {
+            return line.mid(6).trimmed().split(' ').first().toLongLong();
+        }
+    }
+
+    return -1;
+}
+
+QJsonObject DiscoveryBenchmark::results() const
+{
+    QJsonObject results;
+
+    results["instances"] = m_instanceCount;
+    results["services"] = m_serviceCount;
+    results["lookup_interval_ms"] = m_lookupInterval;
+    results["time_to_ready_ms"] = (double)m_timeToReady;
+    results["cpu_time_to_ready_ms"] = (double)m_cpuTimeToReady;
+    results["ready_changed"] = m_readyCounters.readyChanged;
+    results["query_items_changed"] = m_readyCounters.queryItemsChanged;
+    results["service_items_changed"] = m_readyCounters.serviceItemsChanged;
+    results["steady_ready_changed"] = m_counters.readyChanged - m_readyCounters.readyChanged;
+    results["steady_ready_lost"] = m_counters.readyLost - m_readyCounters.readyLost;
+    results["steady_query_items_changed"] = m_counters.queryItemsChanged - m_readyCounters.queryItemsChanged;
+    results["steady_service_items_changed"] = m_counters.serviceItemsChanged - m_readyCounters.serviceItemsChanged;
+    results["dns_queries"] = (double)m_responder->queriesReceived();
+    results["rss_start_kb"] = (double)m_rssStart;
+    results["rss_ready_kb"] = (double)m_rssReady;
+    results["rss_end_kb"] = (double)m_rssEnd;
+
+    return results;
+}
+
+QStringList DiscoveryBenchmark::resultKeys() const
+{
+    QStringList keys;
+
+    keys << "instances" << "services" << "lookup_interval_ms"
+         << "time_to_ready_ms" << "cpu_time_to_ready_ms"
+         << "ready_changed" << "query_items_changed" << "service_items_changed"
+         << "steady_ready_changed" << "steady_ready_lost"
+         << "steady_query_items_changed" << "steady_service_items_changed"
+         << "dns_queries" << "rss_start_kb" << "rss_ready_kb" << "rss_end_kb";
+
+    return keys;
+}
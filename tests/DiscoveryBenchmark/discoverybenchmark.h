@@ -0,0 +1,134 @@
+/****************************************************************************
+**
+** Copyright (C) 2015 Alexander Rössler
+** License: LGPL version 2.1
+**
+** This file is part of QtQuickVcp.
+**
+** All rights reserved. This program and the accompanying materials
+** are made available under the terms of the GNU Lesser General Public License
+** (LGPL) version 2.1 which accompanies this distribution, and is available at
+** http://www.gnu.org/licenses/lgpl-2.1.html
+**
+** This library is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+** Lesser General Public License for more details.
+**
+** Contributors:
+** Alexander Rössler @ The Cool Tool GmbH <mail DOT aroessler AT gmail DOT com>
+**
+****************************************************************************/
+
+#ifndef DISCOVERYBENCHMARK_H
+#define DISCOVERYBENCHMARK_H
+
+#include "abstractbenchmark.h"
+#include <QElapsedTimer>
+#include <QTimer>
+#include <QSet>
+#include <QStringList>
+#include <QJsonObject>
+#include "qservicediscovery.h"
+#include "qservicelist.h"
+#include "qservice.h"
+#include "qnameserver.h"
+#include "fakednsresponder.h"
+
+/** Drives a QServiceDiscovery in unicast mode against a FakeDnsResponder
+ *
+ *  Every synthetic instance gets its own service list with one service per
+ *  service type, filtered by the UUID of the instance, the same way an
+ *  application selects the services of one machine. The benchmark measures
+ *  the time until all services are ready and counts the change
+ *  notifications emitted until then and during the following steady state
+ *  in which the unicast lookups keep refreshing the records.
+ */
+class DiscoveryBenchmark : public AbstractBenchmark
+{
+    Q_OBJECT
+public:
+    explicit DiscoveryBenchmark(QObject *parent = 0);
+
+    void setInstanceCount(int instanceCount)
+    {
+        m_instanceCount = instanceCount;
+    }
+
+    void setServiceCount(int serviceCount)
+    {
+        m_serviceCount = serviceCount;
+    }
+
+    void setLookupInterval(int lookupInterval)
+    {
+        m_lookupInterval = lookupInterval;
+    }
+
+    void setTtl(int ttl)
+    {
+        m_ttl = ttl;
+    }
+
+    void setDuration(int duration)
+    {
+        m_duration = duration;
+    }
+
+    void setTimeout(int timeout)
+    {
+        m_timeout = timeout;
+    }
+
+    void setPort(int port)
+    {
+        m_port = port;
+    }
+
+    bool start();
+
+    QJsonObject results() const;
+    QStringList resultKeys() const;
+
+private:
+    struct Counters {
+        int readyChanged;
+        int readyLost;
+        int queryItemsChanged;
+        int serviceItemsChanged;
+    };
+
+    int         m_instanceCount;
+    int         m_serviceCount;
+    int         m_lookupInterval;
+    int         m_ttl;
+    int         m_duration;
+    int         m_timeout;
+    int         m_port;
+    FakeDnsResponder    *m_responder;
+    QServiceDiscovery   *m_discovery;
+    QList<QService*>    m_services;
+    QSet<QObject*>      m_readyServices;
+    QElapsedTimer       m_elapsedTimer;
+    Counters            m_counters;
+    Counters            m_readyCounters;    // counters when all services became ready
+    qint64              m_timeToReady;
+    qint64              m_cpuStart;
+    qint64              m_cpuTimeToReady;
+    qint64              m_rssStart;
+    qint64              m_rssReady;
+    qint64              m_rssEnd;
+    bool                m_finished;
+
+    static QStringList serviceTypes(int count);
+    static qint64 residentSetSize();
+
+private slots:
+    void serviceReadyChanged(bool ready);
+    void queryItemsChanged();
+    void serviceItemsChanged();
+    void readyTimeout();
+    void finish();
+};
+
+#endif // DISCOVERYBENCHMARK_H
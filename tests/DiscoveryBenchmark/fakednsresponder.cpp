@@ -0,0 +1,274 @@
+/****************************************************************************
+**
+** Copyright (C) 2015 Alexander Rössler
+** License: LGPL version 2.1
+**
+** This file is part of QtQuickVcp.
+**
+** All rights reserved. This program and the accompanying materials
+** are made available under the terms of the GNU Lesser General Public License
+** (LGPL) version 2.1 which accompanies this distribution, and is available at
+** http://www.gnu.org/licenses/lgpl-2.1.html
+**
+** This library is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+** Lesser General Public License for more details.
+**
+** Contributors:
+** Alexander Rössler @ The Cool Tool GmbH <mail DOT aroessler AT gmail DOT com>
+**
+****************************************************************************/
+
+#include "fakednsresponder.h"
+#include <QHostAddress>
+
+static const quint16 DnsTypeA = 1;
+static const quint16 DnsTypePtr = 12;
+static const quint16 DnsTypeTxt = 16;
+static const quint16 DnsTypeSrv = 33;
+
+FakeDnsResponder::FakeDnsResponder(QObject *parent) :
+    QObject(parent),
+    m_socket(new QUdpSocket(this)),
+    m_errorString(""),
+    m_queriesReceived(0),
+    m_answersSent(0)
+{
+    connect(m_socket, SIGNAL(readyRead()),
+            this, SLOT(readyRead()));
+}
+
+bool FakeDnsResponder::start(quint16 port)
+{
+    if (!m_socket->bind(QHostAddress::LocalHost, port))
+    {
+        m_errorString = m_socket->errorString();
+        return false;
+    }
+
+    return true;
+}
+
+void FakeDnsResponder::stop()
+{
+    m_socket->close();
+}
+
+QString FakeDnsResponder::instanceUuid(int instance)
+{
+    return QString("a42c8c6b-4025-4f83-ba28-%1").arg(instance, 12, 10, QChar('0'));
+}
+
+void FakeDnsResponder::setInstances(int instanceCount, const QStringList &serviceTypes, int ttl)
+{
+    m_records.clear();
+
+    for (int i = 0; i < instanceCount; ++i)
+    {
+        QString host = QString("machine%1.local").arg(i);
+        QString uuid = instanceUuid(i);
+        QByteArray address;
+
+        appendUInt32(address, QHostAddress(QHostAddress::LocalHost).toIPv4Address());
+        addRecord(host, DnsTypeA, ttl, address);
+
+        for (int j = 0; j < serviceTypes.size(); ++j)
+        {
+            QString serviceType = serviceTypes.at(j);
+            QString instanceName = QString("%1 service on machine%2._machinekit._tcp.local").arg(serviceType).arg(i);
+            quint16 port = 20000 + (i * serviceTypes.size()) + j;
+            QStringList texts;
+            QByteArray srv;
+            QByteArray txt;
+
+            addRecord("_machinekit._tcp.local", DnsTypePtr, ttl, encodeName(instanceName));
+            addRecord(QString("_%1._sub._machinekit._tcp.local").arg(serviceType), DnsTypePtr, ttl, encodeName(instanceName));
+
+            appendUInt16(srv, 0);   // priority
+            appendUInt16(srv, 0);   // weight
+            appendUInt16(srv, port);
+            srv.append(encodeName(host));
+            addRecord(instanceName, DnsTypeSrv, ttl, srv);
+
+            texts << QString("dsn=tcp://%1:%2").arg(host).arg(port)
+                  << QString("uuid=%1").arg(uuid)
+                  << QString("service=%1").arg(serviceType)
+                  << QString("version=0");
+            foreach (const QString &text, texts)
+            {
+                QByteArray bytes = text.toUtf8();
+                txt.append((char)bytes.size());
+                txt.append(bytes);
+            }
+            addRecord(instanceName, DnsTypeTxt, ttl, txt);
+        }
+    }
+}
+
+void FakeDnsResponder::addRecord(const QString &name, quint16 type, int ttl, const QByteArray &data)
+{
+    Record record;
+    record.type = type;
+    record.ttl = (quint32)ttl;
+    record.data = data;
+    m_records[recordKey(name, type)].append(record);
+}
+
+QString FakeDnsResponder::recordKey(const QString &name, quint16 type)
+{
+    QString key = name.toLower();
+
+    if (key.endsWith('.'))
+    {
+        key.chop(1);
+    }
+
+    return key + "/" + QString::number(type);
+}
+
+void FakeDnsResponder::readyRead()
+{
+    while (m_socket->hasPendingDatagrams())
+    {
+        QByteArray query;
+        QHostAddress sender;
+        quint16 senderPort;
+        QByteArray response;
+
+        query.resize((int)m_socket->pendingDatagramSize());
+        m_socket->readDatagram(query.data(), query.size(), &sender, &senderPort);
+        m_queriesReceived++;
+
+        response = answer(query);
+        if (!response.isEmpty())
+        {
+            m_socket->writeDatagram(response, sender, senderPort);
+            m_answersSent++;
+        }
+    }
+}
+
+/** Creates the response to a query with a single question, returns an empty array for invalid queries */
+QByteArray FakeDnsResponder::answer(const QByteArray &query)
+{
+    QByteArray response;
+    QString name;
+    int offset;
+    quint16 flags;
+    quint16 type;
+
+    if (query.size() < 12)
+    {
+        return QByteArray();
+    }
+
+    offset = 12;
+    if (!decodeName(query, offset, name) || ((offset + 4) > query.size()))
+    {
+        return QByteArray();
+    }
+    type = ((quint8)query.at(offset) << 8) | (quint8)query.at(offset + 1);
+
+    QList<Record> records = m_records.value(recordKey(name, type));
+
+    flags = 0x8400 | (((quint8)query.at(2) << 8) & 0x0100);   // response, authoritative, copy recursion desired
+    if (records.isEmpty())
+    {
+        flags |= 0x0003;    // NXDomain
+    }
+
+    response.append(query.left(2));     // id
+    appendUInt16(response, flags);
+    appendUInt16(response, 1);          // questions
+    appendUInt16(response, records.size());
+    appendUInt16(response, 0);          // authority records
+    appendUInt16(response, 0);          // additional records
+    response.append(query.mid(12, offset + 4 - 12));   // question
+
+    foreach (const Record &record, records)
+    {
+        appendUInt16(response, 0xc00c); // pointer to the question name
+        appendUInt16(response, record.type);
+        appendUInt16(response, 1);      // class IN
+        appendUInt32(response, record.ttl);
+        appendUInt16(response, record.data.size());
+        response.append(record.data);
+    }
+
+    return response;
+}
+
+QByteArray FakeDnsResponder::encodeName(const QString &name)
+{
+    QByteArray data;
+
+    foreach (const QString &label, name.split('.', QString::SkipEmptyParts))
+    {
+        QByteArray bytes = label.toUtf8().left(63);
+        data.append((char)bytes.size());
+        data.append(bytes);
+    }
+    data.append((char)0);
+
+    return data;
+}
+
+bool FakeDnsResponder::decodeName(const QByteArray &packet, int &offset, QString &name)
+{
+    QStringList labels;
+    int position = offset;
+    int jumps = 0;
+    bool jumped = false;
+
+    while (position < packet.size())
+    {
+        quint8 length = (quint8)packet.at(position);
+
+        if (length == 0)
+        {
+            if (!jumped)
+            {
+                offset = position + 1;
+            }
+            name = labels.join(".");
+            return true;
+        }
+        else if ((length & 0xc0) == 0xc0)   // compressed name
+        {
+            if (((position + 1) >= packet.size()) || (++jumps > 16))
+            {
+                return false;
+            }
+            if (!jumped)
+            {
+                offset = position + 2;
+                jumped = true;
+            }
+            position = ((length & 0x3f) << 8) | (quint8)packet.at(position + 1);
+        }
+        else
+        {
+            if ((position + 1 + length) > packet.size())
+            {
+                return false;
+            }
+            labels.append(QString::fromUtf8(packet.mid(position + 1, length)));
+            position += 1 + length;
+        }
+    }
+
+    return false;
+}
+
+void FakeDnsResponder::appendUInt16(QByteArray &data, quint16 value)
+{
+    data.append((char)((value >> 8) & 0xff));
+    data.append((char)(value & 0xff));
+}
+
+void FakeDnsResponder::appendUInt32(QByteArray &data, quint32 value)
+{
+    appendUInt16(data, (quint16)((value >> 16) & 0xffff));
+    appendUInt16(data, (quint16)(value & 0xffff));
+}
@@ -0,0 +1,93 @@
+/****************************************************************************
+**
+** Copyright (C) 2015 Alexander Rössler
+** License: LGPL version 2.1
+**
+** This file is part of QtQuickVcp.
+**
+** All rights reserved. This program and the accompanying materials
+** are made available under the terms of the GNU Lesser General Public License
+** (LGPL) version 2.1 which accompanies this distribution, and is available at
+** http://www.gnu.org/licenses/lgpl-2.1.html
+**
+** This library is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+** Lesser General Public License for more details.
+**
+** Contributors:
+** Alexander Rössler @ The Cool Tool GmbH <mail DOT aroessler AT gmail DOT com>
+**
+****************************************************************************/
+
+#ifndef FAKEDNSRESPONDER_H
+#define FAKEDNSRESPONDER_H
+
+#include <QObject>
+#include <QHash>
+#include <QList>
+#include <QStringList>
+#include <QUdpSocket>
+
+/** Local stand-in for a DNS-SD responder announcing Machinekit instances
+ *
+ *  Answers unicast DNS queries on the loopback interface for a number of
+ *  synthetic instances, each announcing the same set of Machinekit
+ *  services. Every instance gets its own host name, UUID and port range.
+ *  The records follow the layout of the Machinekit announcements:
+ *  PTR records for _machinekit._tcp and the service subtypes, SRV and TXT
+ *  records for every service instance and an A record for every host.
+ */
+class FakeDnsResponder : public QObject
+{
+    Q_OBJECT
+public:
+    explicit FakeDnsResponder(QObject *parent = 0);
+
+    bool start(quint16 port);
+    void stop();
+    void setInstances(int instanceCount, const QStringList &serviceTypes, int ttl);
+
+    static QString instanceUuid(int instance);
+
+    QString errorString() const
+    {
+        return m_errorString;
+    }
+
+    quint64 queriesReceived() const
+    {
+        return m_queriesReceived;
+    }
+
+    quint64 answersSent() const
+    {
+        return m_answersSent;
+    }
+
+private:
+    struct Record {
+        quint16 type;
+        quint32 ttl;
+        QByteArray data;
+    };
+
+    QUdpSocket  *m_socket;
+    QString     m_errorString;
+    quint64     m_queriesReceived;
+    quint64     m_answersSent;
+    QHash<QString, QList<Record> > m_records; // lowercase name + type > records
+
+    void addRecord(const QString &name, quint16 type, int ttl, const QByteArray &data);
+    QByteArray answer(const QByteArray &query);
+    static QString recordKey(const QString &name, quint16 type);
+    static QByteArray encodeName(const QString &name);
+    static bool decodeName(const QByteArray &packet, int &offset, QString &name);
+    static void appendUInt16(QByteArray &data, quint16 value);
+    static void appendUInt32(QByteArray &data, quint32 value);
+
+private slots:
+    void readyRead();
+};
+
+#endif // FAKEDNSRESPONDER_H
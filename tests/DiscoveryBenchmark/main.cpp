@@ -0,0 +1,40 @@
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include "discoverybenchmark.h"
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("discoverybenchmark");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Service discovery scalability benchmark against a local fake DNS-SD responder");
+    parser.addHelpOption();
+    QCommandLineOption instancesOption(QStringList() << "n" << "instances", "Number of Machinekit instances.", "instances", "60");
+    QCommandLineOption servicesOption(QStringList() << "m" << "services", "Number of services per instance.", "services", "4");
+    QCommandLineOption intervalOption(QStringList() << "i" << "interval", "Unicast lookup interval in ms.", "ms", "1000");
+    QCommandLineOption ttlOption(QStringList() << "ttl", "TTL of the announced records in seconds.", "seconds", "120");
+    QCommandLineOption durationOption(QStringList() << "d" << "duration", "Steady state observation after all services are ready in seconds.", "seconds", "10");
+    QCommandLineOption timeoutOption(QStringList() << "timeout", "Time to wait for all services in seconds.", "seconds", "60");
+    QCommandLineOption portOption(QStringList() << "p" << "port", "UDP port of the fake responder.", "port", "53535");
+    parser.addOption(instancesOption);
+    parser.addOption(servicesOption);
+    parser.addOption(intervalOption);
+    parser.addOption(ttlOption);
+    parser.addOption(durationOption);
+    parser.addOption(timeoutOption);
+    parser.addOption(portOption);
+    AbstractBenchmark::addOutputOptions(parser);
+    parser.process(app);
+
+    DiscoveryBenchmark benchmark;
+    benchmark.setInstanceCount(qMax(1, parser.value(instancesOption).toInt()));
+    benchmark.setServiceCount(qMax(1, parser.value(servicesOption).toInt()));
+    benchmark.setLookupInterval(qMax(100, parser.value(intervalOption).toInt()));
+    benchmark.setTtl(qMax(1, parser.value(ttlOption).toInt()));
+    benchmark.setDuration(qMax(0, parser.value(durationOption).toInt()));
+    benchmark.setTimeout(qMax(1, parser.value(timeoutOption).toInt()));
+    benchmark.setPort(parser.value(portOption).toInt());
+
+    return benchmark.exec(app, parser);
+}
@@ -0,0 +1,14 @@
+TEMPLATE = app
+TARGET = halgroupbenchmark
+
+include(../common/benchmark.pri)
+include(../common/halremote.pri)
+
+SOURCES += \
+    main.cpp \
+    fakehalgroupserver.cpp \
+    halgroupbenchmark.cpp
+
+HEADERS += \
+    fakehalgroupserver.h \
+    halgroupbenchmark.h
@@ -0,0 +1,148 @@
+/****************************************************************************
+**
+** Copyright (C) 2015 Alexander Rössler
+** License: LGPL version 2.1
+**
+** This file is part of QtQuickVcp.
+**
+** All rights reserved. This program and the accompanying materials
+** are made available under the terms of the GNU Lesser General Public License
+** (LGPL) version 2.1 which accompanies this distribution, and is available at
+** http://www.gnu.org/licenses/lgpl-2.1.html
+**
+** This library is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+** Lesser General Public License for more details.
+**
+** Contributors:
+** Alexander Rössler @ The Cool Tool GmbH <mail DOT aroessler AT gmail DOT com>
+**
+****************************************************************************/
+
+#include "fakehalgroupserver.h"
+#include <QDateTime>
+
+static const int keepaliveTimer = 2500;
+static const int publishInterval = 10;  // ms, updates are sent in bursts to reach high rates
+
+FakeHalGroupServer::FakeHalGroupServer(QObject *parent) :
+    AbstractFakeServer(parent),
+    m_socket(NULL),
+    m_publishTimer(new QTimer(this)),
+    m_groupName(""),
+    m_updatesSent(0),
+    m_rate(50),
+    m_publishStart(0)
+{
+    m_publishTimer->setTimerType(Qt::PreciseTimer);
+    m_publishTimer->setInterval(publishInterval);
+    connect(m_publishTimer, SIGNAL(timeout()),
+            this, SLOT(publishTimerTick()));
+}
+
+FakeHalGroupServer::~FakeHalGroupServer()
+{
+    stop();
+}
+
+bool FakeHalGroupServer::start(const QString &uri, const QString &groupName, int members)
+{
+    stop();
+
+    m_groupName = groupName.toLocal8Bit();
+    m_values.fill(0.0, members);
+
+    m_socket = bindSocket(ZMQSocket::TYP_XPUB, uri, SLOT(subscriptionReceived(QList<QByteArray>)));
+    if (m_socket == NULL)
+    {
+        stop();
+        return false;
+    }
+
+    return true;
+}
+
+void FakeHalGroupServer::stop()
+{
+    stopPublishing();
+
+    closeSockets();
+    m_socket = NULL;
+}
+
+void FakeHalGroupServer::startPublishing(int rate)
+{
+    m_rate = rate;
+    m_updatesSent = 0;
+    m_publishStart = QDateTime::currentMSecsSinceEpoch();
+    m_publishTimer->start();
+}
+
+void FakeHalGroupServer::stopPublishing()
+{
+    m_publishTimer->stop();
+}
+
+void FakeHalGroupServer::sendFullUpdate()
+{
+    pb::Group *group;
+
+    group = m_tx.add_group();
+    group->set_name(m_groupName.constData());
+    for (int i = 0; i < m_values.size(); ++i)
+    {
+        pb::Member *member = group->add_member();
+        pb::Signal *signal = member->mutable_signal();
+        member->set_mtype(pb::HAL_MEMBER_SIGNAL);
+        signal->set_name(QString("benchmark.sig%1").arg(i).toStdString());
+        signal->set_handle(i + 1);
+        signal->set_type(pb::HAL_FLOAT);
+        signal->set_halfloat(m_values.at(i));
+    }
+    m_tx.mutable_pparams()->set_keepalive_timer(keepaliveTimer);
+
+    sendContainer(m_socket, QList<QByteArray>() << m_groupName, pb::MT_HALGROUP_FULL_UPDATE);
+}
+
+/** Changes the value of every member and publishes all of them */
+void FakeHalGroupServer::sendIncrementalUpdate()
+{
+    m_updatesSent++;
+
+    for (int i = 0; i < m_values.size(); ++i)
+    {
+        pb::Signal *signal = m_tx.add_signal();
+        m_values[i] = (double)m_updatesSent + i / 1000.0;
+        signal->set_handle(i + 1);
+        signal->set_type(pb::HAL_FLOAT);
+        signal->set_halfloat(m_values.at(i));
+    }
+
+    sendContainer(m_socket, QList<QByteArray>() << m_groupName, pb::MT_HALGROUP_INCREMENTAL_UPDATE);
+}
+
+/** Subscriptions start with \x01, unsubscriptions with \x00 */
+void FakeHalGroupServer::subscriptionReceived(const QList<QByteArray> &messageList)
+{
+    QByteArray subscription = messageList.at(0);
+
+    if ((subscription.size() > 1) && (subscription.at(0) == '\x01')
+        && (subscription.mid(1) == m_groupName))
+    {
+        sendFullUpdate();
+        emit subscribed();
+    }
+}
+
+/** Sends as many updates as needed to keep up with the rate */
+void FakeHalGroupServer::publishTimerTick()
+{
+    qint64 elapsed = QDateTime::currentMSecsSinceEpoch() - m_publishStart;
+    quint64 due = (quint64)(elapsed * m_rate / 1000);
+
+    while (m_updatesSent < due)
+    {
+        sendIncrementalUpdate();
+    }
+}
@@ -0,0 +1,85 @@
+/****************************************************************************
+**
+** Copyright (C) 2015 Alexander Rössler
+** License: LGPL version 2.1
+**
+** This file is part of QtQuickVcp.
+**
+** All rights reserved. This program and the accompanying materials
+** are made available under the terms of the GNU Lesser General Public License
+** (LGPL) version 2.1 which accompanies this distribution, and is available at
+** http://www.gnu.org/licenses/lgpl-2.1.html
+**
+** This library is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+** Lesser General Public License for more details.
+**
+** Contributors:
+** Alexander Rössler @ The Cool Tool GmbH <mail DOT aroessler AT gmail DOT com>
+**
+****************************************************************************/
+
+#ifndef FAKEHALGROUPSERVER_H
+#define FAKEHALGROUPSERVER_H
+
+#include <QTimer>
+#include <QVector>
+#include "abstractfakeserver.h"
+
+/** Local stand-in for the halgroup service of Haltalk
+ *
+ *  Answers a subscription to the group name with a full update of all
+ *  members and publishes incremental updates at the given rate. Every
+ *  incremental update changes all members, which is the worst case for
+ *  a client that is interested in a few signals only. The members are
+ *  float signals named "benchmark.sigN" with the handle N + 1.
+ */
+class FakeHalGroupServer : public AbstractFakeServer
+{
+    Q_OBJECT
+public:
+    explicit FakeHalGroupServer(QObject *parent = 0);
+    ~FakeHalGroupServer();
+
+    bool start(const QString &uri, const QString &groupName, int members);
+    void stop();
+    void startPublishing(int rate);
+    void stopPublishing();
+
+    quint64 updatesSent() const
+    {
+        return m_updatesSent;
+    }
+
+    int members() const
+    {
+        return m_values.size();
+    }
+
+    double signalValue(int index) const
+    {
+        return m_values.value(index);
+    }
+
+private:
+    ZMQSocket           *m_socket;
+    QTimer              *m_publishTimer;
+    QByteArray          m_groupName;
+    QVector<double>     m_values;
+    quint64             m_updatesSent;
+    int                 m_rate;
+    qint64              m_publishStart;
+
+    void sendFullUpdate();
+    void sendIncrementalUpdate();
+
+private slots:
+    void subscriptionReceived(const QList<QByteArray> &messageList);
+    void publishTimerTick();
+
+signals:
+    void subscribed();
+};
+
+#endif // FAKEHALGROUPSERVER_H
@@ -0,0 +1,210 @@
+/****************************************************************************
+**
+** Copyright (C) 2015 Alexander Rössler
+** License: LGPL version 2.1
+**
+** This file is part of QtQuickVcp.
+**
+** All rights reserved. This program and the accompanying materials
+** are made available under the terms of the GNU Lesser General Public License
+** (LGPL) version 2.1 which accompanies this distribution, and is available at
+** http://www.gnu.org/licenses/lgpl-2.1.html
+**
+** This library is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+** Lesser General Public License for more details.
+**
+** Contributors:
+** Alexander Rössler @ The Cool Tool GmbH <mail DOT aroessler AT gmail DOT com>
+**
+****************************************************************************/
+
+#include "halgroupbenchmark.h"
+#include <QStringList>
+
+static const int settleTime = 250;  // ms to receive the updates still in flight
+
+HalGroupBenchmark::HalGroupBenchmark(QObject *parent) :
+    AbstractBenchmark(parent),
+    m_members(1000),
+    m_declared(10),
+    m_rate(50),
+    m_duration(5),
+    m_declaredSignalsOnly(true),
+    m_server(new FakeHalGroupServer(this)),
+    m_group(NULL),
+    m_container(NULL),
+    m_wallTime(0),
+    m_cpuTime(0),
+    m_cpuStart(0),
+    m_valuesChanged(0),
+    m_signalObjects(0),
+    m_valueEntries(0),
+    m_staleSignals(0),
+    m_checkPassed(false),
+    m_started(false),
+    m_finished(false)
+{
+}
+
+bool HalGroupBenchmark::start()
+{
+    QString halgroupUri = "tcp://127.0.0.1:5621";
+    int step;
+
+    m_declared = qMin(m_declared, m_members);
+
+    if (!m_server->start(halgroupUri, "benchmark", m_members))
+    {
+        m_errorString = m_server->errorString();
+        return false;
+    }
+
+    // spread the declared signals over the group
+    m_container = new QObject(this);
+    step = m_members / m_declared;
+    for (int i = 0; i < m_declared; ++i)
+    {
+        QHalSignal *signal = new QHalSignal(m_container);
+        signal->setName(QString("sig%1").arg(i * step));
+        m_signals.append(signal);
+        m_signalIndexes.append(i * step);
+    }
+
+    m_group = new QHalGroup(this);
+    m_group->setHalgroupUri(halgroupUri);
+    m_group->setName("benchmark");
+    m_group->setContainerItem(m_container);
+    m_group->setDeclaredSignalsOnly(m_declaredSignalsOnly);
+    connect(m_group, SIGNAL(connectedChanged(bool)),
+            this, SLOT(connectedChanged(bool)));
+    connect(m_group, SIGNAL(valuesChanged(QJsonObject)),
+            this, SLOT(valuesChanged()));
+
+    m_group->componentComplete();
+    m_group->setReady(true);
+    QTimer::singleShot(5000, this, SLOT(connectTimeout()));
+
+    return true;
+}
+
+bool HalGroupBenchmark::passed() const
+{
+    return m_errorString.isEmpty() && m_checkPassed;
+}
+
+void HalGroupBenchmark::connectedChanged(bool connected)
+{
+    if (!connected || m_started)
+    {
+        return;
+    }
+    m_started = true;
+
+    m_cpuStart = cpuTime();
+    m_elapsedTimer.start();
+    startLagProbe(m_duration);
+    m_server->startPublishing(m_rate);
+    QTimer::singleShot(m_duration * 1000, this, SLOT(stopPublishing()));
+}
+
+void HalGroupBenchmark::connectTimeout()
+{
+    if (!m_started)
+    {
+        m_errorString = "timeout while waiting for the full update";
+        finish();
+    }
+}
+
+void HalGroupBenchmark::valuesChanged()
+{
+    m_valuesChanged++;
+}
+
+void HalGroupBenchmark::stopPublishing()
+{
+    m_server->stopPublishing();
+    QTimer::singleShot(settleTime, this, SLOT(finish()));
+}
+
+void HalGroupBenchmark::finish()
+{
+    if (m_finished)
+    {
+        return;
+    }
+    m_finished = true;
+
+    stopLagProbe();
+    m_server->stopPublishing();
+    if (m_elapsedTimer.isValid())
+    {
+        m_wallTime = m_elapsedTimer.elapsed();
+        m_cpuTime = cpuTime() - m_cpuStart;
+    }
+
+    // local signals for undeclared members are created as children of the group
+    m_signalObjects = m_group->findChildren<QHalSignal*>().size();
+    m_valueEntries = m_group->values().size();
+
+    m_staleSignals = 0;
+    for (int i = 0; i < m_signals.size(); ++i)
+    {
+        QHalSignal *signal = m_signals.at(i);
+        if (!signal->synced()
+            || (signal->value().toDouble() != m_server->signalValue(m_signalIndexes.at(i))))
+        {
+            m_staleSignals++;
+        }
+    }
+
+    m_checkPassed = m_started && (m_staleSignals == 0);
+    if (m_declaredSignalsOnly)
+    {
+        m_checkPassed = m_checkPassed && (m_signalObjects == 0) && (m_valueEntries == m_declared);
+    }
+    else
+    {
+        m_checkPassed = m_checkPassed && (m_valueEntries == m_members);
+    }
+
+    m_group->setReady(false);
+    m_server->stop();
+
+    emit finished();
+}
+
+QJsonObject HalGroupBenchmark::results() const
+{
+    QJsonObject results;
+
+    results["members"] = m_members;
+    results["declared"] = m_declared;
+    results["declared_only"] = m_declaredSignalsOnly;
+    results["rate"] = m_rate;
+    results["updates_sent"] = (double)m_server->updatesSent();
+    results["values_changed"] = m_valuesChanged;
+    results["signal_objects"] = m_signalObjects;
+    results["value_entries"] = m_valueEntries;
+    results["stale_signals"] = m_staleSignals;
+    results["check_passed"] = m_checkPassed;
+    addLagResults(results);
+    results["cpu_time_ms"] = (double)m_cpuTime;
+    results["wall_time_ms"] = (double)m_wallTime;
+
+    return results;
+}
+
+QStringList HalGroupBenchmark::resultKeys() const
+{
+    QStringList keys;
+
+    keys << "members" << "declared" << "declared_only" << "rate" << "updates_sent"
+         << "values_changed" << "signal_objects" << "value_entries" << "stale_signals"
+         << "check_passed" << "lag_p50_us" << "lag_p99_us" << "lag_max_us"
+         << "cpu_time_ms" << "wall_time_ms";
+
+    return keys;
+}
@@ -0,0 +1,112 @@
+/****************************************************************************
+**
+** Copyright (C) 2015 Alexander Rössler
+** License: LGPL version 2.1
+**
+** This file is part of QtQuickVcp.
+**
+** All rights reserved. This program and the accompanying materials
+** are made available under the terms of the GNU Lesser General Public License
+** (LGPL) version 2.1 which accompanies this distribution, and is available at
+** http://www.gnu.org/licenses/lgpl-2.1.html
+**
+** This library is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+** Lesser General Public License for more details.
+**
+** Contributors:
+** Alexander Rössler @ The Cool Tool GmbH <mail DOT aroessler AT gmail DOT com>
+**
+****************************************************************************/
+
+#ifndef HALGROUPBENCHMARK_H
+#define HALGROUPBENCHMARK_H
+
+#include "abstractbenchmark.h"
+#include <QElapsedTimer>
+#include <QTimer>
+#include <QList>
+#include <QJsonObject>
+#include "qhalgroup.h"
+#include "qhalsignal.h"
+#include "fakehalgroupserver.h"
+
+/** Feeds a QHalGroup with a few declared signals from a large remote group
+ *
+ *  The FakeHalGroupServer publishes a group with many members while only
+ *  a few HalSignals are declared in the container item. Measures the CPU
+ *  time spent on the updates and how many signal objects and values
+ *  entries the group creates. After the publisher stops, the declared
+ *  signals must hold the last published values and, with
+ *  declaredSignalsOnly, the group must not track any other member.
+ */
+class HalGroupBenchmark : public AbstractBenchmark
+{
+    Q_OBJECT
+public:
+    explicit HalGroupBenchmark(QObject *parent = 0);
+
+    void setMembers(int members)
+    {
+        m_members = members;
+    }
+
+    void setDeclared(int declared)
+    {
+        m_declared = declared;
+    }
+
+    void setRate(int rate)
+    {
+        m_rate = rate;
+    }
+
+    void setDuration(int duration)
+    {
+        m_duration = duration;
+    }
+
+    void setDeclaredSignalsOnly(bool declaredSignalsOnly)
+    {
+        m_declaredSignalsOnly = declaredSignalsOnly;
+    }
+
+    bool start();
+    bool passed() const;
+
+    QJsonObject results() const;
+    QStringList resultKeys() const;
+
+private:
+    int         m_members;
+    int         m_declared;
+    int         m_rate;
+    int         m_duration;
+    bool        m_declaredSignalsOnly;
+    FakeHalGroupServer  *m_server;
+    QHalGroup           *m_group;
+    QObject             *m_container;
+    QList<QHalSignal*>  m_signals;
+    QList<int>          m_signalIndexes;
+    QElapsedTimer       m_elapsedTimer;
+    qint64              m_wallTime;
+    qint64              m_cpuTime;
+    qint64              m_cpuStart;
+    int                 m_valuesChanged;
+    int                 m_signalObjects;
+    int                 m_valueEntries;
+    int                 m_staleSignals;
+    bool                m_checkPassed;
+    bool                m_started;
+    bool                m_finished;
+
+private slots:
+    void connectedChanged(bool connected);
+    void connectTimeout();
+    void valuesChanged();
+    void stopPublishing();
+    void finish();
+};
+
+#endif // HALGROUPBENCHMARK_H
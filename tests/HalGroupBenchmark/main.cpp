@@ -0,0 +1,36 @@
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include "halgroupbenchmark.h"
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("halgroupbenchmark");
+
+    GOOGLE_PROTOBUF_VERIFY_VERSION;
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("HAL group update benchmark against a local fake halgroup server");
+    parser.addHelpOption();
+    QCommandLineOption membersOption(QStringList() << "m" << "members", "Number of signals in the remote group.", "members", "1000");
+    QCommandLineOption declaredOption(QStringList() << "s" << "declared", "Number of declared HalSignals.", "signals", "10");
+    QCommandLineOption rateOption(QStringList() << "r" << "rate", "Incremental updates per second.", "rate", "50");
+    QCommandLineOption durationOption(QStringList() << "d" << "duration", "Duration in seconds.", "seconds", "5");
+    QCommandLineOption allSignalsOption(QStringList() << "a" << "all-signals", "Track all group members instead of the declared signals only.");
+    parser.addOption(membersOption);
+    parser.addOption(declaredOption);
+    parser.addOption(rateOption);
+    parser.addOption(durationOption);
+    parser.addOption(allSignalsOption);
+    AbstractBenchmark::addOutputOptions(parser);
+    parser.process(app);
+
+    HalGroupBenchmark benchmark;
+    benchmark.setMembers(qMax(1, parser.value(membersOption).toInt()));
+    benchmark.setDeclared(qMax(1, parser.value(declaredOption).toInt()));
+    benchmark.setRate(qMax(1, parser.value(rateOption).toInt()));
+    benchmark.setDuration(qMax(1, parser.value(durationOption).toInt()));
+    benchmark.setDeclaredSignalsOnly(!parser.isSet(allSignalsOption));
+
+    return benchmark.exec(app, parser);
+}
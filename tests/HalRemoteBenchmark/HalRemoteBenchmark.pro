@@ -0,0 +1,14 @@
+TEMPLATE = app
+TARGET = halremotebenchmark
+
+include(../common/benchmark.pri)
+include(../common/halremote.pri)
+
+SOURCES += \
+    main.cpp \
+    fakehalserver.cpp \
+    halremotebenchmark.cpp
+
+HEADERS += \
+    fakehalserver.h \
+    halremotebenchmark.h
@@ -0,0 +1,325 @@
+/****************************************************************************
+**
+** Copyright (C) 2015 Alexander Rössler
+** License: LGPL version 2.1
+**
+** This file is part of QtQuickVcp.
+**
+** All rights reserved. This program and the accompanying materials
+** are made available under the terms of the GNU Lesser General Public License
+** (LGPL) version 2.1 which accompanies this distribution, and is available at
+** http://www.gnu.org/licenses/lgpl-2.1.html
+**
+** This library is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+** Lesser General Public License for more details.
+**
+** Contributors:
+** Alexander Rössler @ The Cool Tool GmbH <mail DOT aroessler AT gmail DOT com>
+**
+****************************************************************************/
+
+#include "fakehalserver.h"
+
+static const int keepaliveTimer = 2500;
+
+FakeHalServer::FakeHalServer(QObject *parent) :
+    AbstractFakeServer(parent),
+    m_halrcmdSocket(NULL),
+    m_halrcompSocket(NULL),
+    m_halrcmdShmSocket(NULL),
+    m_halrcompShmSocket(NULL),
+    m_messagesReceived(0),
+    m_messagesSent(0),
+    m_nextHandle(1)
+{
+}
+
+FakeHalServer::~FakeHalServer()
+{
+    stop();
+}
+
+/** Binds the halrcmd and halrcomp endpoints, tcp://, ipc:// and shm:// uris are supported */
+bool FakeHalServer::start(const QString &halrcmdUri, const QString &halrcompUri)
+{
+    stop();
+
+    if (QHalSharedMemorySocket::isSharedMemoryUri(halrcmdUri)
+        && QHalSharedMemorySocket::isSharedMemoryUri(halrcompUri))
+    {
+        m_halrcmdShmSocket = new QHalSharedMemorySocket(this);
+        m_halrcompShmSocket = new QHalSharedMemorySocket(this);
+
+        if (!m_halrcmdShmSocket->bindTo(halrcmdUri))
+        {
+            m_errorString = m_halrcmdShmSocket->errorString();
+            stop();
+            return false;
+        }
+
+        if (!m_halrcompShmSocket->bindTo(halrcompUri))
+        {
+            m_errorString = m_halrcompShmSocket->errorString();
+            stop();
+            return false;
+        }
+
+        connect(m_halrcmdShmSocket, SIGNAL(messageReceived(QList<QByteArray>)),
+                this, SLOT(halrcmdMessageReceived(QList<QByteArray>)));
+        connect(m_halrcompShmSocket, SIGNAL(messageReceived(QList<QByteArray>)),
+                this, SLOT(halrcompMessageReceived(QList<QByteArray>)));
+
+        return true;
+    }
+
+    m_halrcmdSocket = bindSocket(ZMQSocket::TYP_ROUTER, halrcmdUri, SLOT(halrcmdMessageReceived(QList<QByteArray>)));
+    if (m_halrcmdSocket != NULL)
+    {
+        m_halrcompSocket = bindSocket(ZMQSocket::TYP_XPUB, halrcompUri, SLOT(halrcompMessageReceived(QList<QByteArray>)));
+    }
+    if (m_halrcompSocket == NULL)
+    {
+        stop();
+        return false;
+    }
+
+    return true;
+}
+
+void FakeHalServer::stop()
+{
+    if (m_halrcmdShmSocket != NULL)
+    {
+        m_halrcmdShmSocket->close();
+        m_halrcmdShmSocket->deleteLater();
+        m_halrcmdShmSocket = NULL;
+    }
+
+    if (m_halrcompShmSocket != NULL)
+    {
+        m_halrcompShmSocket->close();
+        m_halrcompShmSocket->deleteLater();
+        m_halrcompShmSocket = NULL;
+    }
+
+    closeSockets();
+    m_halrcmdSocket = NULL;
+    m_halrcompSocket = NULL;
+
+    m_components.clear();
+    m_pinsByHandle.clear();
+    m_componentsByHandle.clear();
+}
+
+/** Returns the current value of a bound pin, invalid if there is no such pin */
+QVariant FakeHalServer::pinValue(const QString &name) const
+{
+    foreach (const pb::Pin &pin, m_pinsByHandle)
+    {
+        if (QString::fromStdString(pin.name()) != name)
+        {
+            continue;
+        }
+
+        if (pin.has_halfloat()) {
+            return QVariant(pin.halfloat());
+        }
+        else if (pin.has_halbit()) {
+            return QVariant(pin.halbit());
+        }
+        else if (pin.has_hals32()) {
+            return QVariant(pin.hals32());
+        }
+        else if (pin.has_halu32()) {
+            return QVariant(pin.halu32());
+        }
+    }
+
+    return QVariant();
+}
+
+void FakeHalServer::sendHalrcmdMessage(const QByteArray &identity, pb::ContainerType type)
+{
+    QByteArray data;
+
+    m_tx.set_type(type);
+    data = QByteArray(m_tx.SerializeAsString().c_str(), m_tx.ByteSize());
+    m_tx.Clear();
+
+    if (m_halrcmdShmSocket != NULL)
+    {
+        m_halrcmdShmSocket->sendMessage(data);
+    }
+    else
+    {
+        m_halrcmdSocket->sendMessage(QList<QByteArray>() << identity << data);
+    }
+    m_messagesSent++;
+}
+
+void FakeHalServer::sendHalrcompMessage(const QString &topic, pb::ContainerType type)
+{
+    QList<QByteArray> message;
+
+    m_tx.set_type(type);
+    message << topic.toLocal8Bit() << QByteArray(m_tx.SerializeAsString().c_str(), m_tx.ByteSize());
+    m_tx.Clear();
+
+    if (m_halrcompShmSocket != NULL)
+    {
+        m_halrcompShmSocket->sendMessage(message);
+    }
+    else
+    {
+        m_halrcompSocket->sendMessage(message);
+    }
+    m_messagesSent++;
+}
+
+/** Creates the components of a bind request, pins of existing components are reused */
+void FakeHalServer::bindComponents()
+{
+    for (int i = 0; i < m_rx.comp_size(); ++i)
+    {
+        const pb::Component &remoteComponent = m_rx.comp(i);
+        QString name = QString::fromStdString(remoteComponent.name());
+
+        if (m_components.contains(name))
+        {
+            continue;
+        }
+
+        Component component;
+        component.name = name;
+        for (int j = 0; j < remoteComponent.pin_size(); ++j)
+        {
+            pb::Pin pin = remoteComponent.pin(j);
+            int handle = m_nextHandle++;
+            pin.set_handle(handle);
+            component.handles.append(handle);
+            m_pinsByHandle.insert(handle, pin);
+            m_componentsByHandle.insert(handle, name);
+        }
+        m_components.insert(name, component);
+    }
+}
+
+/** Applies a pin set request and echoes the changes to the subscribers */
+void FakeHalServer::setPins()
+{
+    QMap<QString, QList<int> > changedHandles;
+
+    for (int i = 0; i < m_rx.pin_size(); ++i)
+    {
+        const pb::Pin &remotePin = m_rx.pin(i);
+        int handle = remotePin.handle();
+
+        if (!m_pinsByHandle.contains(handle))
+        {
+            continue;
+        }
+
+        pb::Pin &pin = m_pinsByHandle[handle];
+        if (remotePin.has_halfloat()) {
+            pin.set_halfloat(remotePin.halfloat());
+        }
+        else if (remotePin.has_halbit()) {
+            pin.set_halbit(remotePin.halbit());
+        }
+        else if (remotePin.has_hals32()) {
+            pin.set_hals32(remotePin.hals32());
+        }
+        else if (remotePin.has_halu32()) {
+            pin.set_halu32(remotePin.halu32());
+        }
+        changedHandles[m_componentsByHandle.value(handle)].append(handle);
+    }
+
+    QMapIterator<QString, QList<int> > i(changedHandles);
+    while (i.hasNext())
+    {
+        i.next();
+        foreach (int handle, i.value())
+        {
+            const pb::Pin &pin = m_pinsByHandle[handle];
+            pb::Pin *updatePin = m_tx.add_pin();
+            updatePin->set_handle(handle);
+            updatePin->set_type(pin.type());
+            if (pin.has_halfloat()) {
+                updatePin->set_halfloat(pin.halfloat());
+            }
+            else if (pin.has_halbit()) {
+                updatePin->set_halbit(pin.halbit());
+            }
+            else if (pin.has_hals32()) {
+                updatePin->set_hals32(pin.hals32());
+            }
+            else if (pin.has_halu32()) {
+                updatePin->set_halu32(pin.halu32());
+            }
+        }
+        sendHalrcompMessage(i.key(), pb::MT_HALRCOMP_INCREMENTAL_UPDATE);
+    }
+}
+
+void FakeHalServer::sendFullUpdate(const QString &topic)
+{
+    if (!m_components.contains(topic))
+    {
+        return;
+    }
+
+    const Component &component = m_components[topic];
+    pb::Component *remoteComponent = m_tx.add_comp();
+    remoteComponent->set_name(component.name.toStdString());
+    foreach (int handle, component.handles)
+    {
+        remoteComponent->add_pin()->CopyFrom(m_pinsByHandle.value(handle));
+    }
+    m_tx.mutable_pparams()->set_keepalive_timer(keepaliveTimer);
+
+    sendHalrcompMessage(topic, pb::MT_HALRCOMP_FULL_UPDATE);
+}
+
+void FakeHalServer::halrcmdMessageReceived(const QList<QByteArray> &messageList)
+{
+    QByteArray identity;
+    QByteArray data;
+
+    if (messageList.size() > 1)     // router sockets prepend the peer identity
+    {
+        identity = messageList.at(0);
+    }
+    data = messageList.last();
+    m_rx.ParseFromArray(data.data(), data.size());
+    m_messagesReceived++;
+
+    if (m_rx.type() == pb::MT_PING)
+    {
+        sendHalrcmdMessage(identity, pb::MT_PING_ACKNOWLEDGE);
+    }
+    else if (m_rx.type() == pb::MT_HALRCOMP_BIND)
+    {
+        bindComponents();
+        sendHalrcmdMessage(identity, pb::MT_HALRCOMP_BIND_CONFIRM);
+    }
+    else if (m_rx.type() == pb::MT_HALRCOMP_SET)
+    {
+        setPins();
+    }
+}
+
+/** Subscriptions start with \x01, unsubscriptions with \x00 */
+void FakeHalServer::halrcompMessageReceived(const QList<QByteArray> &messageList)
+{
+    QByteArray subscription = messageList.at(0);
+
+    m_messagesReceived++;
+
+    if ((subscription.size() > 1) && (subscription.at(0) == '\x01'))
+    {
+        sendFullUpdate(QString::fromLocal8Bit(subscription.mid(1)));
+    }
+}
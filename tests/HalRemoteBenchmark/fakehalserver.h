@@ -0,0 +1,89 @@
+/****************************************************************************
+**
+** Copyright (C) 2015 Alexander Rössler
+** License: LGPL version 2.1
+**
+** This file is part of QtQuickVcp.
+**
+** All rights reserved. This program and the accompanying materials
+** are made available under the terms of the GNU Lesser General Public License
+** (LGPL) version 2.1 which accompanies this distribution, and is available at
+** http://www.gnu.org/licenses/lgpl-2.1.html
+**
+** This library is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+** Lesser General Public License for more details.
+**
+** Contributors:
+** Alexander Rössler @ The Cool Tool GmbH <mail DOT aroessler AT gmail DOT com>
+**
+****************************************************************************/
+
+#ifndef FAKEHALSERVER_H
+#define FAKEHALSERVER_H
+
+#include <QHash>
+#include <QMap>
+#include <QVariant>
+#include "abstractfakeserver.h"
+#include "qhalsharedmemorysocket.h"
+
+/** Local stand-in for the halrcmd and halrcomp services of Haltalk
+ *
+ *  Implements the part of the protocol used by QHalRemoteComponent: ping,
+ *  bind, pin set, full update on subscribe and incremental updates. Every
+ *  accepted pin change is echoed as incremental update, the same way
+ *  Haltalk reports the changed HAL pin back to all subscribers.
+ */
+class FakeHalServer : public AbstractFakeServer
+{
+    Q_OBJECT
+public:
+    explicit FakeHalServer(QObject *parent = 0);
+    ~FakeHalServer();
+
+    bool start(const QString &halrcmdUri, const QString &halrcompUri);
+    void stop();
+
+    quint64 messagesReceived() const
+    {
+        return m_messagesReceived;
+    }
+
+    quint64 messagesSent() const
+    {
+        return m_messagesSent;
+    }
+
+    QVariant pinValue(const QString &name) const;
+
+private:
+    struct Component {
+        QString name;
+        QList<int> handles;
+    };
+
+    ZMQSocket               *m_halrcmdSocket;
+    ZMQSocket               *m_halrcompSocket;
+    QHalSharedMemorySocket  *m_halrcmdShmSocket;
+    QHalSharedMemorySocket  *m_halrcompShmSocket;
+    quint64                 m_messagesReceived;
+    quint64                 m_messagesSent;
+    int                     m_nextHandle;
+    QMap<QString, Component> m_components;
+    QHash<int, pb::Pin>     m_pinsByHandle;
+    QHash<int, QString>     m_componentsByHandle;
+
+    void sendHalrcmdMessage(const QByteArray &identity, pb::ContainerType type);
+    void sendHalrcompMessage(const QString &topic, pb::ContainerType type);
+    void bindComponents();
+    void setPins();
+    void sendFullUpdate(const QString &topic);
+
+private slots:
+    void halrcmdMessageReceived(const QList<QByteArray> &messageList);
+    void halrcompMessageReceived(const QList<QByteArray> &messageList);
+};
+
+#endif // FAKEHALSERVER_H
@@ -0,0 +1,312 @@
+/****************************************************************************
+**
+** Copyright (C) 2015 Alexander Rössler
+** License: LGPL version 2.1
+**
+** This file is part of QtQuickVcp.
+**
+** All rights reserved. This program and the accompanying materials
+** are made available under the terms of the GNU Lesser General Public License
+** (LGPL) version 2.1 which accompanies this distribution, and is available at
+** http://www.gnu.org/licenses/lgpl-2.1.html
+**
+** This library is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+** Lesser General Public License for more details.
+**
+** Contributors:
+** Alexander Rössler @ The Cool Tool GmbH <mail DOT aroessler AT gmail DOT com>
+**
+****************************************************************************/
+
+#include "halremotebenchmark.h"
+#include "qhalsharedmemorysocket.h"
+#include <QJsonArray>
+#include <QStringList>
+#include <algorithm>
+
+static const int toggleSettleTime = 250; // ms
+
+HalRemoteBenchmark::HalRemoteBenchmark(QObject *parent) :
+    AbstractBenchmark(parent),
+    m_pinCount(10),
+    m_rate(100),
+    m_duration(10),
+    m_transport("tcp"),
+    m_toggles(50),
+    m_server(new FakeHalServer(this)),
+    m_component(NULL),
+    m_container(new QObject(this)),
+    m_togglePin(NULL),
+    m_toggleTimer(new QTimer(this)),
+    m_togglesSent(0),
+    m_togglePassed(true),
+    m_exclusivePassed(true),
+    m_connected(false),
+    m_changeTimer(new QTimer(this)),
+    m_wallTime(0),
+    m_cpuTime(0),
+    m_cpuStart(0),
+    m_nextPin(0),
+    m_skipped(0),
+    m_value(0.0),
+    m_finished(false)
+{
+    m_changeTimer->setTimerType(Qt::PreciseTimer);
+    connect(m_changeTimer, SIGNAL(timeout()),
+            this, SLOT(changeTimerTick()));
+
+    m_toggleTimer->setInterval(10);
+    connect(m_toggleTimer, SIGNAL(timeout()),
+            this, SLOT(toggleTimerTick()));
+}
+
+bool HalRemoteBenchmark::start()
+{
+    QString halrcmdUri;
+    QString halrcompUri;
+
+    if (m_transport == "shm")
+    {
+        halrcmdUri = "shm://halrcmd-benchmark";
+        halrcompUri = "shm://halrcomp-benchmark";
+    }
+    else if (m_transport == "ipc")
+    {
+        halrcmdUri = "ipc:///tmp/halrcmd-benchmark";
+        halrcompUri = "ipc:///tmp/halrcomp-benchmark";
+    }
+    else
+    {
+        halrcmdUri = "tcp://127.0.0.1:5601";
+        halrcompUri = "tcp://127.0.0.1:5602";
+    }
+
+    if (!m_server->start(halrcmdUri, halrcompUri))
+    {
+        m_errorString = m_server->errorString();
+        return false;
+    }
+
+    for (int i = 0; i < m_pinCount; ++i)
+    {
+        QHalPin *pin = new QHalPin(m_container);
+        pin->setName(QString("pin%1").arg(i));
+        pin->setType(QHalPin::Float);
+        pin->setDirection(QHalPin::Out);
+        connect(pin, SIGNAL(syncedChanged(bool)),
+                this, SLOT(pinSyncedChanged(bool)));
+        m_pins.append(pin);
+    }
+    m_pending.fill(-1, m_pinCount);
+
+    m_togglePin = new QHalPin(m_container);
+    m_togglePin->setName("toggle");
+    m_togglePin->setType(QHalPin::Bit);
+    m_togglePin->setDirection(QHalPin::Out);
+    m_togglePin->setValue(false);
+
+    m_component = new QHalRemoteComponent(this);
+    m_component->setName("benchmark");
+    m_component->setHalrcmdUri(halrcmdUri);
+    m_component->setHalrcompUri(halrcompUri);
+    m_component->setContainerItem(m_container);
+    connect(m_component, SIGNAL(connectedChanged(bool)),
+            this, SLOT(connectedChanged(bool)));
+    m_component->componentComplete();
+    m_component->setReady(true);
+    QTimer::singleShot(5000, this, SLOT(connectTimeout()));
+
+    return true;
+}
+
+void HalRemoteBenchmark::connectedChanged(bool connected)
+{
+    if (!connected)
+    {
+        if (m_changeTimer->isActive() || m_toggleTimer->isActive())
+        {
+            m_errorString = m_component->errorString();
+            finish();
+        }
+        return;
+    }
+
+    if (m_connected)   // reconnect during the run
+    {
+        return;
+    }
+    m_connected = true;
+
+    if (m_transport == "shm")
+    {
+        checkExclusive();
+    }
+
+    if (m_toggles > 0)
+    {
+        m_toggleTimer->start();
+        return;
+    }
+
+    startRoundTrip();
+}
+
+/** The segments are consumed by the component, another client is rejected */
+void HalRemoteBenchmark::checkExclusive()
+{
+    QHalSharedMemorySocket socket;
+
+    m_exclusivePassed = !socket.connectTo(m_component->halrcmdUri())
+                        && !socket.connectTo(m_component->halrcompUri());
+}
+
+/** Press and release within the same event loop pass, before any echo */
+void HalRemoteBenchmark::toggleTimerTick()
+{
+    m_togglePin->setValue(true);
+    m_togglePin->setValue(false);
+    m_togglesSent++;
+
+    if (m_togglesSent >= m_toggles)
+    {
+        m_toggleTimer->stop();
+        QTimer::singleShot(toggleSettleTime, this, SLOT(checkToggles()));
+    }
+}
+
+void HalRemoteBenchmark::checkToggles()
+{
+    QVariant remoteValue = m_server->pinValue("benchmark.toggle");
+
+    m_togglePassed = (remoteValue == QVariant(false))
+                     && (m_togglePin->value() == QVariant(false))
+                     && m_togglePin->synced();
+
+    startRoundTrip();
+}
+
+void HalRemoteBenchmark::startRoundTrip()
+{
+    if (m_finished)
+    {
+        return;
+    }
+
+    m_samples.clear();
+    m_samples.reserve(m_rate * m_duration);
+    m_cpuStart = cpuTime();
+    m_elapsedTimer.start();
+    m_changeTimer->setInterval(qMax(1, 1000 / m_rate));
+    m_changeTimer->start();
+    QTimer::singleShot(m_duration * 1000, this, SLOT(finish()));
+}
+
+void HalRemoteBenchmark::connectTimeout()
+{
+    if (!m_connected)
+    {
+        m_errorString = "timeout while connecting to the server";
+        finish();
+    }
+}
+
+void HalRemoteBenchmark::changeTimerTick()
+{
+    int index = m_nextPin;
+
+    m_nextPin = (m_nextPin + 1) % m_pinCount;
+
+    if (m_pending.at(index) != -1)  // still waiting for the echo
+    {
+        m_skipped++;
+        return;
+    }
+
+    m_value += 1.0;
+    m_pending[index] = m_elapsedTimer.nsecsElapsed();
+    m_pins.at(index)->setValue(m_value);
+}
+
+void HalRemoteBenchmark::pinSyncedChanged(bool synced)
+{
+    int index;
+
+    if (!synced || !m_elapsedTimer.isValid())
+    {
+        return;
+    }
+
+    index = m_pins.indexOf(static_cast<QHalPin*>(QObject::sender()));
+    if ((index == -1) || (m_pending.at(index) == -1))
+    {
+        return;
+    }
+
+    m_samples.append((m_elapsedTimer.nsecsElapsed() - m_pending.at(index)) / 1000);
+    m_pending[index] = -1;
+}
+
+void HalRemoteBenchmark::finish()
+{
+    if (m_finished)
+    {
+        return;
+    }
+    m_finished = true;
+
+    m_changeTimer->stop();
+    m_toggleTimer->stop();
+    if (m_elapsedTimer.isValid())
+    {
+        m_wallTime = m_elapsedTimer.elapsed();
+        m_cpuTime = cpuTime() - m_cpuStart;
+    }
+    std::sort(m_samples.begin(), m_samples.end());
+
+    m_component->setReady(false);
+    m_server->stop();
+
+    emit finished();
+}
+
+/** The toggled bit pin ended up reset on both sides */
+bool HalRemoteBenchmark::passed() const
+{
+    return m_errorString.isEmpty() && m_togglePassed && m_exclusivePassed;
+}
+
+QJsonObject HalRemoteBenchmark::results() const
+{
+    QJsonObject results;
+    double seconds = qMax((qint64)1, m_wallTime) / 1000.0;
+
+    results["transport"] = m_transport;
+    results["pins"] = m_pinCount;
+    results["rate"] = m_rate;
+    results["samples"] = m_samples.size();
+    results["skipped"] = m_skipped;
+    results["p50_us"] = (double)percentile(m_samples, 0.5);
+    results["p99_us"] = (double)percentile(m_samples, 0.99);
+    results["max_us"] = (double)(m_samples.isEmpty() ? 0 : m_samples.last());
+    results["messages_per_second"] = (m_server->messagesReceived() + m_server->messagesSent()) / seconds;
+    results["toggles"] = m_togglesSent;
+    results["toggle_passed"] = m_togglePassed;
+    results["exclusive_passed"] = m_exclusivePassed;
+    results["cpu_time_ms"] = (double)m_cpuTime;
+    results["wall_time_ms"] = (double)m_wallTime;
+
+    return results;
+}
+
+QStringList HalRemoteBenchmark::resultKeys() const
+{
+    QStringList keys;
+
+    keys << "transport" << "pins" << "rate" << "samples" << "skipped"
+         << "p50_us" << "p99_us" << "max_us" << "messages_per_second"
+         << "toggles" << "toggle_passed" << "exclusive_passed" << "cpu_time_ms" << "wall_time_ms";
+
+    return keys;
+}
@@ -0,0 +1,124 @@
+/****************************************************************************
+**
+** Copyright (C) 2015 Alexander Rössler
+** License: LGPL version 2.1
+**
+** This file is part of QtQuickVcp.
+**
+** All rights reserved. This program and the accompanying materials
+** are made available under the terms of the GNU Lesser General Public License
+** (LGPL) version 2.1 which accompanies this distribution, and is available at
+** http://www.gnu.org/licenses/lgpl-2.1.html
+**
+** This library is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+** Lesser General Public License for more details.
+**
+** Contributors:
+** Alexander Rössler @ The Cool Tool GmbH <mail DOT aroessler AT gmail DOT com>
+**
+****************************************************************************/
+
+#ifndef HALREMOTEBENCHMARK_H
+#define HALREMOTEBENCHMARK_H
+
+#include "abstractbenchmark.h"
+#include <QElapsedTimer>
+#include <QTimer>
+#include <QVector>
+#include <QJsonObject>
+#include "qhalremotecomponent.h"
+#include "qhalpin.h"
+#include "fakehalserver.h"
+
+/** Drives a QHalRemoteComponent against a FakeHalServer
+ *
+ *  A pin change is sent every 1/rate seconds, round robin over all pins.
+ *  The round-trip time is measured from the local change until the pin
+ *  becomes synced again through the echoed incremental update. Pins still
+ *  waiting for their echo are skipped.
+ *
+ *  Before the measurement a bit pin is set and reset many times within
+ *  one round trip, like a quickly pressed momentary button. The run only
+ *  passes if the server and the pin end up reset. With the shm transport
+ *  a second client must not be able to attach to the connected segments.
+ */
+class HalRemoteBenchmark : public AbstractBenchmark
+{
+    Q_OBJECT
+public:
+    explicit HalRemoteBenchmark(QObject *parent = 0);
+
+    void setPinCount(int pinCount)
+    {
+        m_pinCount = pinCount;
+    }
+
+    void setRate(int rate)
+    {
+        m_rate = rate;
+    }
+
+    void setDuration(int duration)
+    {
+        m_duration = duration;
+    }
+
+    void setTransport(const QString &transport)
+    {
+        m_transport = transport;
+    }
+
+    void setToggles(int toggles)
+    {
+        m_toggles = toggles;
+    }
+
+    bool start();
+    bool passed() const;
+
+    QJsonObject results() const;
+    QStringList resultKeys() const;
+
+private:
+    int         m_pinCount;
+    int         m_rate;
+    int         m_duration;
+    QString     m_transport;
+    int         m_toggles;
+    FakeHalServer       *m_server;
+    QHalRemoteComponent *m_component;
+    QObject             *m_container;
+    QList<QHalPin*>     m_pins;
+    QHalPin             *m_togglePin;
+    QTimer              *m_toggleTimer;
+    int                 m_togglesSent;
+    bool                m_togglePassed;
+    bool                m_exclusivePassed;
+    bool                m_connected;
+    QVector<qint64>     m_pending;
+    QVector<qint64>     m_samples;
+    QTimer              *m_changeTimer;
+    QElapsedTimer       m_elapsedTimer;
+    qint64              m_wallTime;
+    qint64              m_cpuTime;
+    qint64              m_cpuStart;
+    int                 m_nextPin;
+    int                 m_skipped;
+    double              m_value;
+    bool                m_finished;
+
+private slots:
+    void connectedChanged(bool connected);
+    void connectTimeout();
+    void checkExclusive();
+    void toggleTimerTick();
+    void checkToggles();
+    void startRoundTrip();
+    void changeTimerTick();
+    void pinSyncedChanged(bool synced);
+    void finish();
+};
+
+#endif // HALREMOTEBENCHMARK_H
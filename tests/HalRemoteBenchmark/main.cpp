@@ -0,0 +1,36 @@
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include "halremotebenchmark.h"
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("halremotebenchmark");
+
+    GOOGLE_PROTOBUF_VERIFY_VERSION;
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("HAL remote component round-trip benchmark against a local fake Haltalk server");
+    parser.addHelpOption();
+    QCommandLineOption pinsOption(QStringList() << "n" << "pins", "Number of pins.", "pins", "10");
+    QCommandLineOption rateOption(QStringList() << "r" << "rate", "Pin changes per second.", "rate", "100");
+    QCommandLineOption durationOption(QStringList() << "d" << "duration", "Duration in seconds.", "seconds", "10");
+    QCommandLineOption transportOption(QStringList() << "t" << "transport", "Transport: tcp, ipc or shm.", "transport", "tcp");
+    parser.addOption(pinsOption);
+    parser.addOption(rateOption);
+    parser.addOption(durationOption);
+    QCommandLineOption togglesOption(QStringList() << "toggles", "Set and reset cycles of a bit pin within one round trip, checked before the benchmark. 0 disables the check.", "count", "50");
+    parser.addOption(transportOption);
+    parser.addOption(togglesOption);
+    AbstractBenchmark::addOutputOptions(parser);
+    parser.process(app);
+
+    HalRemoteBenchmark benchmark;
+    benchmark.setPinCount(qMax(1, parser.value(pinsOption).toInt()));
+    benchmark.setRate(qMax(1, parser.value(rateOption).toInt()));
+    benchmark.setDuration(qMax(1, parser.value(durationOption).toInt()));
+    benchmark.setTransport(parser.value(transportOption));
+    benchmark.setToggles(qMax(0, parser.value(togglesOption).toInt()));
+
+    return benchmark.exec(app, parser);
+}
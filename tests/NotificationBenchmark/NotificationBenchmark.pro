@@ -0,0 +1,14 @@
+TEMPLATE = app
+TARGET = notificationbenchmark
+
+include(../common/benchmark.pri)
+include(../common/application.pri)
+
+SOURCES += \
+    main.cpp \
+    fakeerrorpublisher.cpp \
+    notificationbenchmark.cpp
+
+HEADERS += \
+    fakeerrorpublisher.h \
+    notificationbenchmark.h
@@ -0,0 +1,127 @@
+/****************************************************************************
+**
+** Copyright (C) 2015 Alexander Rössler
+** License: LGPL version 2.1
+**
+** This file is part of QtQuickVcp.
+**
+** All rights reserved. This program and the accompanying materials
+** are made available under the terms of the GNU Lesser General Public License
+** (LGPL) version 2.1 which accompanies this distribution, and is available at
+** http://www.gnu.org/licenses/lgpl-2.1.html
+**
+** This library is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+** Lesser General Public License for more details.
+**
+** Contributors:
+** Alexander Rössler @ The Cool Tool GmbH <mail DOT aroessler AT gmail DOT com>
+**
+****************************************************************************/
+
+#include "fakeerrorpublisher.h"
+#include <QDateTime>
+
+static const int keepaliveTimer = 2500;
+static const int publishInterval = 10;  // ms, messages are sent in bursts to reach high rates
+
+FakeErrorPublisher::FakeErrorPublisher(QObject *parent) :
+    AbstractFakeServer(parent),
+    m_socket(NULL),
+    m_publishTimer(new QTimer(this)),
+    m_messagesSent(0),
+    m_rate(1000),
+    m_distinct(1),
+    m_publishStart(0)
+{
+    m_publishTimer->setTimerType(Qt::PreciseTimer);
+    m_publishTimer->setInterval(publishInterval);
+    connect(m_publishTimer, SIGNAL(timeout()),
+            this, SLOT(publishTimerTick()));
+}
+
+FakeErrorPublisher::~FakeErrorPublisher()
+{
+    stop();
+}
+
+bool FakeErrorPublisher::start(const QString &uri)
+{
+    stop();
+
+    m_socket = bindSocket(ZMQSocket::TYP_XPUB, uri, SLOT(subscriptionReceived(QList<QByteArray>)));
+    if (m_socket == NULL)
+    {
+        stop();
+        return false;
+    }
+
+    return true;
+}
+
+void FakeErrorPublisher::stop()
+{
+    stopPublishing();
+
+    closeSockets();
+    m_socket = NULL;
+}
+
+void FakeErrorPublisher::startPublishing(int rate, int distinct)
+{
+    m_rate = rate;
+    m_distinct = qMax(1, distinct);
+    m_messagesSent = 0;
+    m_publishStart = QDateTime::currentMSecsSinceEpoch();
+    m_publishTimer->start();
+}
+
+void FakeErrorPublisher::stopPublishing()
+{
+    m_publishTimer->stop();
+}
+
+void FakeErrorPublisher::sendMessage(const QByteArray &topic, pb::ContainerType type, const QString &note)
+{
+    if (!note.isEmpty())
+    {
+        m_tx.add_note(note.toStdString());
+    }
+    if (type == pb::MT_PING)
+    {
+        m_tx.mutable_pparams()->set_keepalive_timer(keepaliveTimer);
+    }
+
+    sendContainer(m_socket, QList<QByteArray>() << topic, type);
+}
+
+/** Subscriptions start with \x01, unsubscriptions with \x00 */
+void FakeErrorPublisher::subscriptionReceived(const QList<QByteArray> &messageList)
+{
+    QByteArray subscription = messageList.at(0);
+
+    if ((subscription.size() > 1) && (subscription.at(0) == '\x01'))
+    {
+        sendMessage(subscription.mid(1), pb::MT_PING, QString());
+
+        if (subscription.mid(1) == "error")
+        {
+            emit subscribed();
+        }
+    }
+}
+
+/** Sends as many messages as needed to keep up with the rate */
+void FakeErrorPublisher::publishTimerTick()
+{
+    qint64 elapsed = QDateTime::currentMSecsSinceEpoch() - m_publishStart;
+    quint64 due = (quint64)(elapsed * m_rate / 1000);
+
+    while (m_messagesSent < due)
+    {
+        sendMessage("error", pb::MT_EMC_NML_ERROR,
+                    QString("joint %1 following error").arg(m_messagesSent % m_distinct));
+        m_messagesSent++;
+    }
+}
@@ -0,0 +1,71 @@
+/****************************************************************************
+**
+** Copyright (C) 2015 Alexander Rössler
+** License: LGPL version 2.1
+**
+** This file is part of QtQuickVcp.
+**
+** All rights reserved. This program and the accompanying materials
+** are made available under the terms of the GNU Lesser General Public License
+** (LGPL) version 2.1 which accompanies this distribution, and is available at
+** http://www.gnu.org/licenses/lgpl-2.1.html
+**
+** This library is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+** Lesser General Public License for more details.
+**
+** Contributors:
+** Alexander Rössler @ The Cool Tool GmbH <mail DOT aroessler AT gmail DOT com>
+**
+****************************************************************************/
+
+#ifndef FAKEERRORPUBLISHER_H
+#define FAKEERRORPUBLISHER_H
+
+#include <QTimer>
+#include "abstractfakeserver.h"
+
+/** Local stand-in for the error service of machinekit
+ *
+ *  Answers subscriptions with a ping and publishes MT_EMC_NML_ERROR
+ *  messages on the error topic at the given rate. The messages cycle
+ *  through distinct different texts, one distinct text simulates a
+ *  machine spamming the same error.
+ */
+class FakeErrorPublisher : public AbstractFakeServer
+{
+    Q_OBJECT
+public:
+    explicit FakeErrorPublisher(QObject *parent = 0);
+    ~FakeErrorPublisher();
+
+    bool start(const QString &uri);
+    void stop();
+    void startPublishing(int rate, int distinct);
+    void stopPublishing();
+
+    quint64 messagesSent() const
+    {
+        return m_messagesSent;
+    }
+
+private:
+    ZMQSocket           *m_socket;
+    QTimer              *m_publishTimer;
+    quint64             m_messagesSent;
+    int                 m_rate;
+    int                 m_distinct;
+    qint64              m_publishStart;
+
+    void sendMessage(const QByteArray &topic, pb::ContainerType type, const QString &note);
+
+private slots:
+    void subscriptionReceived(const QList<QByteArray> &messageList);
+    void publishTimerTick();
+
+signals:
+    void subscribed();
+};
+
+#endif // FAKEERRORPUBLISHER_H
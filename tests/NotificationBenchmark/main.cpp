@@ -0,0 +1,33 @@
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include "notificationbenchmark.h"
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("notificationbenchmark");
+
+    GOOGLE_PROTOBUF_VERIFY_VERSION;
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Error notification flood benchmark against a local fake error publisher");
+    parser.addHelpOption();
+    QCommandLineOption rateOption(QStringList() << "r" << "rate", "Messages per second.", "rate", "10000");
+    QCommandLineOption distinctOption(QStringList() << "n" << "distinct", "Number of distinct message texts.", "distinct", "1");
+    QCommandLineOption durationOption(QStringList() << "d" << "duration", "Duration in seconds.", "seconds", "10");
+    QCommandLineOption capacityOption(QStringList() << "c" << "capacity", "Notification model capacity.", "rows", "100");
+    parser.addOption(rateOption);
+    parser.addOption(distinctOption);
+    parser.addOption(durationOption);
+    parser.addOption(capacityOption);
+    AbstractBenchmark::addOutputOptions(parser);
+    parser.process(app);
+
+    NotificationBenchmark benchmark;
+    benchmark.setRate(qMax(1, parser.value(rateOption).toInt()));
+    benchmark.setDistinct(qMax(1, parser.value(distinctOption).toInt()));
+    benchmark.setDuration(qMax(1, parser.value(durationOption).toInt()));
+    benchmark.setCapacity(qMax(1, parser.value(capacityOption).toInt()));
+
+    return benchmark.exec(app, parser);
+}
@@ -0,0 +1,184 @@
+/****************************************************************************
+**
+** Copyright (C) 2015 Alexander Rössler
+** License: LGPL version 2.1
+**
+** This file is part of QtQuickVcp.
+**
+** All rights reserved. This program and the accompanying materials
+** are made available under the terms of the GNU Lesser General Public License
+** (LGPL) version 2.1 which accompanies this distribution, and is available at
+** http://www.gnu.org/licenses/lgpl-2.1.html
+**
+** This library is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+** Lesser General Public License for more details.
+**
+** Contributors:
+** Alexander Rössler @ The Cool Tool GmbH <mail DOT aroessler AT gmail DOT com>
+**
+****************************************************************************/
+
+#include "notificationbenchmark.h"
+#include <QStringList>
+
+NotificationBenchmark::NotificationBenchmark(QObject *parent) :
+    AbstractBenchmark(parent),
+    m_rate(10000),
+    m_distinct(1),
+    m_duration(10),
+    m_capacity(100),
+    m_publisher(new FakeErrorPublisher(this)),
+    m_error(NULL),
+    m_wallTime(0),
+    m_cpuTime(0),
+    m_cpuStart(0),
+    m_messagesSent(0),
+    m_rowsInserted(0),
+    m_rowsRemoved(0),
+    m_rowsMoved(0),
+    m_dataChanged(0),
+    m_started(false),
+    m_finished(false)
+{
+}
+
+bool NotificationBenchmark::start()
+{
+    QString errorUri = "tcp://127.0.0.1:5611";
+    QApplicationNotificationModel *model;
+
+    if (!m_publisher->start(errorUri))
+    {
+        m_errorString = m_publisher->errorString();
+        return false;
+    }
+    connect(m_publisher, SIGNAL(subscribed()),
+            this, SLOT(subscribed()));
+
+    m_error = new QApplicationError(this);
+    m_error->setErrorUri(errorUri);
+    m_error->setChannels(QApplicationError::ErrorChannel);
+
+    model = m_error->notifications();
+    model->setCapacity(m_capacity);
+    connect(model, SIGNAL(rowsInserted(QModelIndex,int,int)),
+            this, SLOT(rowsInserted()));
+    connect(model, SIGNAL(rowsRemoved(QModelIndex,int,int)),
+            this, SLOT(rowsRemoved()));
+    connect(model, SIGNAL(rowsMoved(QModelIndex,int,int,QModelIndex,int)),
+            this, SLOT(rowsMoved()));
+    connect(model, SIGNAL(dataChanged(QModelIndex,QModelIndex,QVector<int>)),
+            this, SLOT(dataChanged()));
+
+    m_error->componentComplete();
+    m_error->setReady(true);
+    QTimer::singleShot(5000, this, SLOT(connectTimeout()));
+
+    return true;
+}
+
+void NotificationBenchmark::subscribed()
+{
+    if (m_started)
+    {
+        return;
+    }
+    m_started = true;
+
+    m_cpuStart = cpuTime();
+    m_elapsedTimer.start();
+    startLagProbe(m_duration);
+    m_publisher->startPublishing(m_rate, m_distinct);
+    QTimer::singleShot(m_duration * 1000, this, SLOT(finish()));
+}
+
+void NotificationBenchmark::connectTimeout()
+{
+    if (!m_started)
+    {
+        m_errorString = "timeout while waiting for the subscription";
+        finish();
+    }
+}
+
+void NotificationBenchmark::rowsInserted()
+{
+    m_rowsInserted++;
+}
+
+void NotificationBenchmark::rowsRemoved()
+{
+    m_rowsRemoved++;
+}
+
+void NotificationBenchmark::rowsMoved()
+{
+    m_rowsMoved++;
+}
+
+void NotificationBenchmark::dataChanged()
+{
+    m_dataChanged++;
+}
+
+void NotificationBenchmark::finish()
+{
+    if (m_finished)
+    {
+        return;
+    }
+    m_finished = true;
+
+    stopLagProbe();
+    m_publisher->stopPublishing();
+    m_messagesSent = m_publisher->messagesSent();
+    if (m_elapsedTimer.isValid())
+    {
+        m_error->notifications()->flush();  // count the messages still buffered
+        m_wallTime = m_elapsedTimer.elapsed();
+        m_cpuTime = cpuTime() - m_cpuStart;
+    }
+
+    m_error->setReady(false);
+    m_publisher->stop();
+
+    emit finished();
+}
+
+QJsonObject NotificationBenchmark::results() const
+{
+    QJsonObject results;
+    double seconds = qMax((qint64)1, m_wallTime) / 1000.0;
+    QApplicationNotificationModel *model = m_error->notifications();
+
+    results["rate"] = m_rate;
+    results["distinct"] = m_distinct;
+    results["capacity"] = m_capacity;
+    results["messages_sent"] = (double)m_messagesSent;
+    results["messages_received"] = (double)model->messageCount();
+    results["received_per_second"] = model->messageCount() / seconds;
+    results["rows"] = model->count();
+    results["rows_inserted"] = m_rowsInserted;
+    results["rows_removed"] = m_rowsRemoved;
+    results["rows_moved"] = m_rowsMoved;
+    results["data_changed"] = m_dataChanged;
+    addLagResults(results);
+    results["cpu_time_ms"] = (double)m_cpuTime;
+    results["wall_time_ms"] = (double)m_wallTime;
+
+    return results;
+}
+
+QStringList NotificationBenchmark::resultKeys() const
+{
+    QStringList keys;
+
+    keys << "rate" << "distinct" << "capacity" << "messages_sent" << "messages_received"
+         << "received_per_second" << "rows" << "rows_inserted" << "rows_removed"
+         << "rows_moved" << "data_changed" << "lag_p50_us" << "lag_p99_us"
+         << "lag_max_us" << "cpu_time_ms" << "wall_time_ms";
+
+    return keys;
+}
@@ -0,0 +1,102 @@
+/****************************************************************************
+**
+** Copyright (C) 2015 Alexander Rössler
+** License: LGPL version 2.1
+**
+** This file is part of QtQuickVcp.
+**
+** All rights reserved. This program and the accompanying materials
+** are made available under the terms of the GNU Lesser General Public License
+** (LGPL) version 2.1 which accompanies this distribution, and is available at
+** http://www.gnu.org/licenses/lgpl-2.1.html
+**
+** This library is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+** Lesser General Public License for more details.
+**
+** Contributors:
+** Alexander Rössler @ The Cool Tool GmbH <mail DOT aroessler AT gmail DOT com>
+**
+****************************************************************************/
+
+#ifndef NOTIFICATIONBENCHMARK_H
+#define NOTIFICATIONBENCHMARK_H
+
+#include "abstractbenchmark.h"
+#include <QElapsedTimer>
+#include <QTimer>
+#include <QVector>
+#include <QJsonObject>
+#include "qapplicationerror.h"
+#include "qapplicationnotificationmodel.h"
+#include "fakeerrorpublisher.h"
+
+/** Floods a QApplicationError with messages from a FakeErrorPublisher
+ *
+ *  Measures how many messages arrive, how many model changes a view
+ *  would have to process and how responsive the event loop stays. The
+ *  responsiveness is sampled with a probe timer, its lag is the time it
+ *  fired later than requested.
+ */
+class NotificationBenchmark : public AbstractBenchmark
+{
+    Q_OBJECT
+public:
+    explicit NotificationBenchmark(QObject *parent = 0);
+
+    void setRate(int rate)
+    {
+        m_rate = rate;
+    }
+
+    void setDistinct(int distinct)
+    {
+        m_distinct = distinct;
+    }
+
+    void setDuration(int duration)
+    {
+        m_duration = duration;
+    }
+
+    void setCapacity(int capacity)
+    {
+        m_capacity = capacity;
+    }
+
+    bool start();
+
+    QJsonObject results() const;
+    QStringList resultKeys() const;
+
+private:
+    int         m_rate;
+    int         m_distinct;
+    int         m_duration;
+    int         m_capacity;
+    FakeErrorPublisher      *m_publisher;
+    QApplicationError       *m_error;
+    QElapsedTimer           m_elapsedTimer;
+    qint64                  m_wallTime;
+    qint64                  m_cpuTime;
+    qint64                  m_cpuStart;
+    quint64                 m_messagesSent;
+    int                     m_rowsInserted;
+    int                     m_rowsRemoved;
+    int                     m_rowsMoved;
+    int                     m_dataChanged;
+    bool                    m_started;
+    bool                    m_finished;
+
+private slots:
+    void subscribed();
+    void connectTimeout();
+    void rowsInserted();
+    void rowsRemoved();
+    void rowsMoved();
+    void dataChanged();
+    void finish();
+};
+
+#endif // NOTIFICATIONBENCHMARK_H
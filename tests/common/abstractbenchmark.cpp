@@ -0,0 +1,171 @@
+/****************************************************************************
+**
+** Copyright (C) 2015 Alexander Rössler
+** License: LGPL version 2.1
+**
+** This file is part of QtQuickVcp.
+**
+** All rights reserved. This program and the accompanying materials
+** are made available under the terms of the GNU Lesser General Public License
+** (LGPL) version 2.1 which accompanies this distribution, and is available at
+** http://www.gnu.org/licenses/lgpl-2.1.html
+**
+** This library is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+** Lesser General Public License for more details.
+**
+** Contributors:
+** Alexander Rössler @ The Cool Tool GmbH <mail DOT aroessler AT gmail DOT com>
+**
+****************************************************************************/
+
+#include "abstractbenchmark.h"
+#include <QFile>
+#include <QJsonDocument>
+#include <QTextStream>
+#include <ctime>
+#include <algorithm>
+
+static const int probeInterval = 10; // ms
+
+AbstractBenchmark::AbstractBenchmark(QObject *parent) :
+    QObject(parent),
+    m_errorString(""),
+    m_probeTimer(new QTimer(this))
+{
+    m_probeTimer->setTimerType(Qt::PreciseTimer);
+    m_probeTimer->setInterval(probeInterval);
+    connect(m_probeTimer, SIGNAL(timeout()),
+            this, SLOT(probeTimerTick()));
+}
+
+bool AbstractBenchmark::passed() const
+{
+    return m_errorString.isEmpty();
+}
+
+QString AbstractBenchmark::resultsCsv() const
+{
+    QStringList keys = resultKeys();
+    QStringList values;
+    QJsonObject results = this->results();
+
+    foreach (const QString &key, keys)
+    {
+        QJsonValue value = results.value(key);
+        if (value.isBool())
+        {
+            values.append(value.toBool() ? "1" : "0");
+        }
+        else if (value.isString())
+        {
+            values.append(value.toString());
+        }
+        else
+        {
+            values.append(QString::number(value.toDouble()));
+        }
+    }
+
+    return keys.join(",") + "\n" + values.join(",") + "\n";
+}
+
+void AbstractBenchmark::addOutputOptions(QCommandLineParser &parser)
+{
+    parser.addOption(QCommandLineOption(QStringList() << "f" << "format", "Output format: csv or json.", "format", "csv"));
+    parser.addOption(QCommandLineOption(QStringList() << "o" << "output", "Output file, default is stdout.", "file"));
+}
+
+/** Runs the harness and writes the results, returns the exit code */
+int AbstractBenchmark::exec(QCoreApplication &app, const QCommandLineParser &parser)
+{
+    QString output;
+
+    connect(this, SIGNAL(finished()),
+            &app, SLOT(quit()));
+
+    if (start())
+    {
+        app.exec();
+    }
+
+    if (!m_errorString.isEmpty())
+    {
+        QTextStream(stderr) << "error: " << m_errorString << endl;
+        return 1;
+    }
+
+    if (parser.value("format") == "json")
+    {
+        output = QString::fromUtf8(QJsonDocument(results()).toJson());
+    }
+    else
+    {
+        output = resultsCsv();
+    }
+
+    if (!parser.isSet("output"))
+    {
+        QTextStream(stdout) << output;
+    }
+    else
+    {
+        QFile file(parser.value("output"));
+        if (!file.open(QIODevice::WriteOnly | QIODevice::Text))
+        {
+            QTextStream(stderr) << "error: cannot open " << file.fileName() << endl;
+            return 1;
+        }
+        QTextStream(&file) << output;
+    }
+
+    return passed() ? 0 : 2;
+}
+
+qint64 AbstractBenchmark::percentile(const QVector<qint64> &sortedSamples, double p)
+{
+    if (sortedSamples.isEmpty())
+    {
+        return 0;
+    }
+
+    int index = qMin(sortedSamples.size() - 1, (int)(p * sortedSamples.size()));
+    return sortedSamples.at(index);
+}
+
+/** Process CPU time in ms, includes the in-process stand-in servers */
+qint64 AbstractBenchmark::cpuTime()
+{
+    return (qint64)std::clock() * 1000 / CLOCKS_PER_SEC;
+}
+
+/** Starts sampling the event loop lag, the duration in s is used to reserve samples */
+void AbstractBenchmark::startLagProbe(int expectedDuration)
+{
+    m_lagSamples.clear();
+    m_lagSamples.reserve(expectedDuration * 1000 / probeInterval);
+    m_probeElapsedTimer.start();
+    m_probeTimer->start();
+}
+
+void AbstractBenchmark::stopLagProbe()
+{
+    m_probeTimer->stop();
+    std::sort(m_lagSamples.begin(), m_lagSamples.end());
+}
+
+void AbstractBenchmark::addLagResults(QJsonObject &results) const
+{
+    results["lag_p50_us"] = (double)percentile(m_lagSamples, 0.5);
+    results["lag_p99_us"] = (double)percentile(m_lagSamples, 0.99);
+    results["lag_max_us"] = (double)(m_lagSamples.isEmpty() ? 0 : m_lagSamples.last());
+}
+
+void AbstractBenchmark::probeTimerTick()
+{
+    qint64 elapsed = m_probeElapsedTimer.nsecsElapsed() / 1000;
+
+    m_probeElapsedTimer.restart();
+    m_lagSamples.append(qMax((qint64)0, elapsed - probeInterval * 1000));
+}
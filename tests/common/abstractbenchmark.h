@@ -0,0 +1,86 @@
+/****************************************************************************
+**
+** Copyright (C) 2015 Alexander Rössler
+** License: LGPL version 2.1
+**
+** This file is part of QtQuickVcp.
+**
+** All rights reserved. This program and the accompanying materials
+** are made available under the terms of the GNU Lesser General Public License
+** (LGPL) version 2.1 which accompanies this distribution, and is available at
+** http://www.gnu.org/licenses/lgpl-2.1.html
+**
+** This library is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+** Lesser General Public License for more details.
+**
+** Contributors:
+** Alexander Rössler @ The Cool Tool GmbH <mail DOT aroessler AT gmail DOT com>
+**
+****************************************************************************/
+
+#ifndef ABSTRACTBENCHMARK_H
+#define ABSTRACTBENCHMARK_H
+
+#include <QObject>
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QTimer>
+#include <QVector>
+#include <QStringList>
+#include <QJsonObject>
+
+/** Base of the headless test harnesses
+ *
+ *  A harness implements start, results and resultKeys and emits finished
+ *  when done. exec runs the event loop, writes the results as CSV or JSON
+ *  and returns the exit code: 0 if passed, 1 on error and 2 if the run
+ *  did not pass its checks. The optional lag probe samples how late a
+ *  precise timer fires, which shows how responsive the event loop stays.
+ */
+class AbstractBenchmark : public QObject
+{
+    Q_OBJECT
+public:
+    explicit AbstractBenchmark(QObject *parent = 0);
+
+    virtual bool start() = 0;
+    virtual QJsonObject results() const = 0;
+    virtual QStringList resultKeys() const = 0;
+    virtual bool passed() const;
+
+    QString errorString() const
+    {
+        return m_errorString;
+    }
+
+    QString resultsCsv() const;
+
+    static void addOutputOptions(QCommandLineParser &parser);
+    int exec(QCoreApplication &app, const QCommandLineParser &parser);
+
+    static qint64 percentile(const QVector<qint64> &sortedSamples, double p);
+    static qint64 cpuTime();
+
+protected:
+    QString     m_errorString;
+
+    void startLagProbe(int expectedDuration);
+    void stopLagProbe();
+    void addLagResults(QJsonObject &results) const;
+
+private:
+    QTimer          *m_probeTimer;
+    QElapsedTimer   m_probeElapsedTimer;
+    QVector<qint64> m_lagSamples;
+
+private slots:
+    void probeTimerTick();
+
+signals:
+    void finished();
+};
+
+#endif // ABSTRACTBENCHMARK_H
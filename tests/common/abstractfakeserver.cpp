@@ -0,0 +1,92 @@
+/****************************************************************************
+**
+** Copyright (C) 2015 Alexander Rössler
+** License: LGPL version 2.1
+**
+** This file is part of QtQuickVcp.
+**
+** All rights reserved. This program and the accompanying materials
+** are made available under the terms of the GNU Lesser General Public License
+** (LGPL) version 2.1 which accompanies this distribution, and is available at
+** http://www.gnu.org/licenses/lgpl-2.1.html
+**
+** This library is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+** Lesser General Public License for more details.
+**
+** Contributors:
+** Alexander Rössler @ The Cool Tool GmbH <mail DOT aroessler AT gmail DOT com>
+**
+****************************************************************************/
+
+#include "abstractfakeserver.h"
+
+AbstractFakeServer::AbstractFakeServer(QObject *parent) :
+    QObject(parent),
+    m_errorString(""),
+    m_context(NULL)
+{
+}
+
+AbstractFakeServer::~AbstractFakeServer()
+{
+    closeSockets();
+}
+
+/** Binds a new socket and connects its messageReceived signal to member,
+ *  returns NULL and sets the error string if the uri cannot be bound
+ */
+ZMQSocket *AbstractFakeServer::bindSocket(ZMQSocket::Type type, const QString &uri, const char *member)
+{
+    ZMQSocket *socket;
+
+    if (m_context == NULL)
+    {
+        m_context = new PollingZMQContext(this, 1);
+        m_context->start();
+    }
+
+    socket = m_context->createSocket(type, this);
+    socket->setLinger(0);
+    m_sockets.append(socket);
+
+    try {
+        socket->bindTo(uri);
+    }
+    catch (const zmq::error_t &e) {
+        m_errorString = QString("Error %1: ").arg(e.num()) + QString(e.what());
+        return NULL;
+    }
+
+    connect(socket, SIGNAL(messageReceived(QList<QByteArray>)),
+            this, member);
+
+    return socket;
+}
+
+void AbstractFakeServer::closeSockets()
+{
+    foreach (ZMQSocket *socket, m_sockets)
+    {
+        socket->close();
+        socket->deleteLater();
+    }
+    m_sockets.clear();
+
+    if (m_context != NULL)
+    {
+        m_context->stop();
+        m_context->deleteLater();
+        m_context = NULL;
+    }
+}
+
+/** Sends m_tx with the given type after the envelope frames and clears it */
+void AbstractFakeServer::sendContainer(ZMQSocket *socket, const QList<QByteArray> &envelope, pb::ContainerType type)
+{
+    m_tx.set_type(type);
+    socket->sendMessage(QList<QByteArray>(envelope)
+                        << QByteArray(m_tx.SerializeAsString().c_str(), m_tx.ByteSize()));
+    m_tx.Clear();
+}
@@ -0,0 +1,66 @@
+/****************************************************************************
+**
+** Copyright (C) 2015 Alexander Rössler
+** License: LGPL version 2.1
+**
+** This file is part of QtQuickVcp.
+**
+** All rights reserved. This program and the accompanying materials
+** are made available under the terms of the GNU Lesser General Public License
+** (LGPL) version 2.1 which accompanies this distribution, and is available at
+** http://www.gnu.org/licenses/lgpl-2.1.html
+**
+** This library is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+** Lesser General Public License for more details.
+**
+** Contributors:
+** Alexander Rössler @ The Cool Tool GmbH <mail DOT aroessler AT gmail DOT com>
+**
+****************************************************************************/
+
+#ifndef ABSTRACTFAKESERVER_H
+#define ABSTRACTFAKESERVER_H
+
+#include <QObject>
+#include <QList>
+#include <QByteArray>
+#include <nzmqt/nzmqt.hpp>
+#include "message.pb.h"
+
+using namespace nzmqt;
+
+/** Base of the local stand-ins for the Machinekit services
+ *
+ *  Owns the 0MQ context and the bound sockets. A fake server binds its
+ *  endpoints with bindSocket, parses requests into m_rx and sends m_tx
+ *  with sendContainer. closeSockets unbinds all endpoints again.
+ */
+class AbstractFakeServer : public QObject
+{
+    Q_OBJECT
+public:
+    explicit AbstractFakeServer(QObject *parent = 0);
+    ~AbstractFakeServer();
+
+    QString errorString() const
+    {
+        return m_errorString;
+    }
+
+protected:
+    QString             m_errorString;
+    pb::Container       m_rx;
+    pb::Container       m_tx;
+
+    ZMQSocket *bindSocket(ZMQSocket::Type type, const QString &uri, const char *member);
+    void closeSockets();
+    void sendContainer(ZMQSocket *socket, const QList<QByteArray> &envelope, pb::ContainerType type);
+
+private:
+    PollingZMQContext   *m_context;
+    QList<ZMQSocket*>   m_sockets;
+};
+
+#endif // ABSTRACTFAKESERVER_H
@@ -0,0 +1,40 @@
+# Sources of the application module used by the harnesses
+
+include($$PWD/machinetalk.pri)
+include($$PWD/../../3rdparty/qftp/qftp.pri)
+
+QT += gui quick
+
+APPLICATION_PATH = $$PWD/../../src/application
+
+INCLUDEPATH += $$APPLICATION_PATH
+
+SOURCES += \
+    $$APPLICATION_PATH/qapplicationconfig.cpp \
+    $$APPLICATION_PATH/qapplicationconfigitem.cpp \
+    $$APPLICATION_PATH/qapplicationconfigfilter.cpp \
+    $$APPLICATION_PATH/qapplicationdescription.cpp \
+    $$APPLICATION_PATH/applicationfileextractor.cpp \
+    $$APPLICATION_PATH/qapplicationfile.cpp \
+    $$APPLICATION_PATH/qapplicationfilemodel.cpp \
+    $$APPLICATION_PATH/qapplicationfileitem.cpp \
+    $$APPLICATION_PATH/applicationfileuploadpreparer.cpp \
+    $$APPLICATION_PATH/qapplicationcommand.cpp \
+    $$APPLICATION_PATH/qapplicationstatus.cpp \
+    $$APPLICATION_PATH/qapplicationerror.cpp \
+    $$APPLICATION_PATH/qapplicationnotificationmodel.cpp
+
+HEADERS += \
+    $$APPLICATION_PATH/qapplicationconfig.h \
+    $$APPLICATION_PATH/qapplicationconfigitem.h \
+    $$APPLICATION_PATH/qapplicationconfigfilter.h \
+    $$APPLICATION_PATH/qapplicationdescription.h \
+    $$APPLICATION_PATH/applicationfileextractor.h \
+    $$APPLICATION_PATH/qapplicationfile.h \
+    $$APPLICATION_PATH/qapplicationfilemodel.h \
+    $$APPLICATION_PATH/qapplicationfileitem.h \
+    $$APPLICATION_PATH/applicationfileuploadpreparer.h \
+    $$APPLICATION_PATH/qapplicationcommand.h \
+    $$APPLICATION_PATH/qapplicationstatus.h \
+    $$APPLICATION_PATH/qapplicationerror.h \
+    $$APPLICATION_PATH/qapplicationnotificationmodel.h
@@ -0,0 +1,14 @@
+# Shared setup of the headless test harnesses, include from the harness .pro
+
+QT += core qml network
+QT -= gui
+CONFIG += console testcase no_testcase_installs
+CONFIG -= app_bundle
+
+INCLUDEPATH += $$PWD
+
+SOURCES += \
+    $$PWD/abstractbenchmark.cpp
+
+HEADERS += \
+    $$PWD/abstractbenchmark.h
@@ -0,0 +1,22 @@
+# Sources of the halremote module used by the harnesses
+
+include($$PWD/machinetalk.pri)
+
+HALREMOTE_PATH = $$PWD/../../src/halremote
+
+INCLUDEPATH += $$HALREMOTE_PATH
+
+SOURCES += \
+    $$HALREMOTE_PATH/qhalpin.cpp \
+    $$HALREMOTE_PATH/qhalremotecomponent.cpp \
+    $$HALREMOTE_PATH/qhalsharedmemorysocket.cpp \
+    $$HALREMOTE_PATH/qhalgroup.cpp \
+    $$HALREMOTE_PATH/qhalsignal.cpp
+
+HEADERS += \
+    $$HALREMOTE_PATH/qhalpin.h \
+    $$HALREMOTE_PATH/qhalremotecomponent.h \
+    $$HALREMOTE_PATH/qhalsharedmemorysocket.h \
+    $$HALREMOTE_PATH/qhalgroup.h \
+    $$HALREMOTE_PATH/qhalsignal.h \
+    $$HALREMOTE_PATH/debughelper.h
@@ -0,0 +1,12 @@
+# Shared setup of the harnesses talking to a fake Machinekit service,
+# include after benchmark.pri
+
+include($$PWD/../../src/zeromq.pri)
+include($$PWD/../../3rdparty/machinetalk-protobuf-qt/machinetalk-protobuf-lib.pri)
+include($$PWD/../../src/common/common.pri)
+
+SOURCES += \
+    $$PWD/abstractfakeserver.cpp
+
+HEADERS += \
+    $$PWD/abstractfakeserver.h
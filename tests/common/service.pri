@@ -0,0 +1,26 @@
+# Sources of the service module used by the harnesses
+
+include($$PWD/../../3rdparty/jdns/jdns.pri)
+
+SERVICE_PATH = $$PWD/../../src/service
+
+INCLUDEPATH += $$SERVICE_PATH
+
+SOURCES += \
+    $$SERVICE_PATH/qservice.cpp \
+    $$SERVICE_PATH/qservicelist.cpp \
+    $$SERVICE_PATH/qservicediscoveryfilter.cpp \
+    $$SERVICE_PATH/qservicediscovery.cpp \
+    $$SERVICE_PATH/qservicediscoveryitem.cpp \
+    $$SERVICE_PATH/qnameserver.cpp \
+    $$SERVICE_PATH/qservicediscoveryquery.cpp
+
+HEADERS += \
+    $$SERVICE_PATH/qservice.h \
+    $$SERVICE_PATH/qservicelist.h \
+    $$SERVICE_PATH/qservicediscoveryfilter.h \
+    $$SERVICE_PATH/qservicediscovery.h \
+    $$SERVICE_PATH/qservicediscoveryitem.h \
+    $$SERVICE_PATH/qnameserver.h \
+    $$SERVICE_PATH/debughelper.h \
+    $$SERVICE_PATH/qservicediscoveryquery.h
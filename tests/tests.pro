@@ -0,0 +1,12 @@
+TEMPLATE = subdirs
+
+CONFIG += testcase_targets
+
+SUBDIRS += \
+    HalRemoteBenchmark \
+    DiscoveryBenchmark \
+    NotificationBenchmark \
+    CommandPipelineBenchmark \
+    HalGroupBenchmark \
+    ApplicationConfigBenchmark \
+    ApplicationFileBenchmark